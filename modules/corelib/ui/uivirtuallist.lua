@@ -0,0 +1,49 @@
+function UIVirtualList:onStyleApply(styleName, styleNode)
+  for name,value in pairs(styleNode) do
+    if name == 'vertical-scrollbar' then
+      addEvent(function()
+        local parent = self:getParent()
+        if parent then
+          self:setVerticalScrollBar(parent:getChildById(value))
+        end
+      end)
+    end
+  end
+end
+
+-- bind(row, index) fills a row widget with the data of the item at index
+function UIVirtualList:setDataSource(count, bind)
+  self.onBindRow = function(list, row, index)
+    bind(row, index)
+  end
+  -- setItemCount only refreshes when the count changes
+  if self:getItemCount() == count then
+    self:refresh()
+  else
+    self:setItemCount(count)
+  end
+end
+
+function UIVirtualList:setVerticalScrollBar(scrollbar)
+  self.verticalScrollBar = scrollbar
+  if not scrollbar then
+    return
+  end
+  connect(scrollbar, 'onValueChange', function(scrollbar, value)
+    self:setScrollOffset(value)
+  end)
+  self:updateScrollBar()
+end
+
+function UIVirtualList:updateScrollBar()
+  local scrollbar = self.verticalScrollBar
+  if scrollbar then
+    scrollbar:setMinimum(0)
+    scrollbar:setMaximum(self:getMaxScrollOffset())
+    scrollbar:setValue(self:getScrollOffset())
+  end
+end
+
+function UIVirtualList:onScrollOffsetChange(offset, maxOffset)
+  self:updateScrollBar()
+end
@@ -26,6 +26,7 @@
 #include <framework/core/eventdispatcher.h>
 #include <framework/util/extras.h>
 #include <framework/stdext/fastrand.h>
+#include <framework/stdext/pool.h>
 
 void Effect::draw(const Point& dest, int offsetX, int offsetY, bool animate, LightView* lightView)
 {
@@ -77,9 +78,12 @@ void Effect::onAppear()
         duration *= getAnimationPhases();
     }
 
-    // schedule removal
-    auto self = asEffect();
-    g_dispatcher.scheduleEvent([self]() { g_map.removeThing(self); }, duration);
+    g_map.addExpiringThing(asEffect(), duration);
+}
+
+EffectPtr Effect::create()
+{
+    return stdext::make_pooled<Effect>();
 }
 
 void Effect::setId(uint32 id)
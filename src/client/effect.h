@@ -35,6 +35,9 @@ class Effect : public Thing
     };
 
 public:
+    // pooled, area spells create and drop them in bursts
+    static EffectPtr create();
+
     void draw(const Point& dest, bool animate = true, LightView* lightView = nullptr) override {}
     void draw(const Point& dest, int offsetX = 0, int offsetY = 0, bool animate = true, LightView* lightView = nullptr);
     
@@ -83,18 +83,26 @@ void Item::draw(const Point& dest, bool animate, LightView* lightView)
     if (m_clientId == 0)
         return;
 
-    // determine animation phase
-    int animationPhase = calculateAnimationPhase(animate);
-
     // determine x,y,z patterns
     int xPattern = 0, yPattern = 0, zPattern = 0;
     calculatePatterns(xPattern, yPattern, zPattern);
 
+    drawWithPatterns(dest, xPattern, yPattern, zPattern, animate, lightView);
+}
+
+void Item::drawWithPatterns(const Point& dest, int xPattern, int yPattern, int zPattern, bool animate, LightView* lightView)
+{
+    if (m_clientId == 0)
+        return;
+
+    // determine animation phase
+    int animationPhase = calculateAnimationPhase(animate);
+
     Color color(Color::white);
     if (m_color != Color::alpha)
         color = m_color;
     size_t drawQueueSize = g_drawQueue->size();
-    if (!m_shader.empty()) {
+    if (m_shader) {
         rawGetThingType()->drawWithShader(dest, 0, xPattern, yPattern, zPattern, animationPhase, m_shader, color, lightView);
     }
     else {
@@ -121,7 +129,7 @@ void Item::draw(const Rect& dest, bool animate)
     if (m_color != Color::alpha)
         color = m_color;
 
-    if (!m_shader.empty()) {
+    if (m_shader) {
         rawGetThingType()->drawWithShader(dest, 0, xPattern, yPattern, zPattern, animationPhase, m_shader, color);
     }
     else {
@@ -129,6 +137,16 @@ void Item::draw(const Rect& dest, bool animate)
     }
 }
 
+void Item::setShader(const std::string& str)
+{
+    m_shader = g_shaders.getShaderId(str);
+}
+
+std::string Item::getShader()
+{
+    return g_shaders.getShaderName(m_shader);
+}
+
 void Item::setId(uint32 id)
 {
     if(!g_things.isValidDatId(id, ThingCategoryItem))
@@ -153,6 +171,8 @@ void Item::setId(uint32 id)
             }
         }
     }
+
+    invalidateTileDrawList();
 }
 
 void Item::setOtbId(uint16 id)
@@ -177,6 +197,25 @@ void Item::setOtbId(uint16 id)
                 m_idleAnimator->copy(animator);
         }
     }
+
+    invalidateTileDrawList();
+}
+
+void Item::setCountOrSubType(int value)
+{
+    if (m_countOrSubType == value)
+        return;
+    m_countOrSubType = value;
+    invalidateTileDrawList();
+}
+
+void Item::invalidateTileDrawList()
+{
+    // patterns and stack classification are cached by the tile the item is on
+    if (!m_position.isValid())
+        return;
+    if (const TilePtr& tile = g_map.getTile(m_position))
+        tile->invalidateDrawList();
 }
 
 bool Item::isValid()
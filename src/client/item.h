@@ -84,16 +84,18 @@ public:
 
     void draw(const Point& dest, bool animate = true, LightView* lightView = nullptr);
     void draw(const Rect& dest, bool animate = true);
+    // patterns precomputed by the tile draw list
+    void drawWithPatterns(const Point& dest, int xPattern, int yPattern, int zPattern, bool animate, LightView* lightView);
 
     void setId(uint32 id);
     void setOtbId(uint16 id);
-    void setCountOrSubType(int value) { m_countOrSubType = value; }
-    void setCount(int count) { m_countOrSubType = count; }
-    void setSubType(int subType) { m_countOrSubType = subType; }
+    void setCountOrSubType(int value);
+    void setCount(int count) { setCountOrSubType(count); }
+    void setSubType(int subType) { setCountOrSubType(subType); }
     void setColor(const Color& c) { m_color = c; }
     void setTooltip(const std::string& str) { m_tooltip = str; }
     void setQuickLootFlags(uint32 flags) { m_quickLootFlags = flags; }
-    void setShader(const std::string& str) { m_shader = str; }
+    void setShader(const std::string& str);
     void setDurationTime(uint64 value) { m_durationTime = value; }
     void setDurationIsPaused(bool value) {
         m_durationIsPaused = value;
@@ -112,7 +114,7 @@ public:
     bool isValid();
     std::string getTooltip() { return m_tooltip; }
     uint32 getQuickLootFlags() { return m_quickLootFlags; }
-    std::string getShader() { return m_shader; }
+    std::string getShader();
     uint64 getDurationTime() { return m_durationTime; }
     ticks_t getDurationTimePaused() { return m_durationTimePaused; }
     bool isDurationPaused() const { return m_durationIsPaused; }
@@ -178,6 +180,8 @@ public:
     AnimatorPtr getIdleAnimator() override { return m_idleAnimator; }
 
 private:
+    void invalidateTileDrawList();
+
     uint16 m_clientId;
     uint16 m_serverId;
     uint16 m_countOrSubType;
@@ -186,7 +190,7 @@ private:
     Color m_color;
     bool m_async;
     std::string m_tooltip;
-    std::string m_shader;
+    int m_shader = 0;
 
     AnimatorPtr m_animator;
     AnimatorPtr m_idleAnimator;
@@ -23,6 +23,8 @@
 #include "lightview.h"
 #include "spritemanager.h"
 #include <framework/graphics/painter.h>
+#include <framework/util/extras.h>
+#include <framework/util/stats.h>
 
 void LightView::addLight(const Point& pos, uint8_t color, uint8_t intensity)
 {
@@ -44,13 +46,67 @@ void LightView::setFieldBrightness(const Point& pos, size_t start, uint8_t color
     m_tiles[index].color = color;
 }
 
-void LightView::draw() // render thread
+void LightView::fillBuffer(uint8_t* buffer)
 {
-    // TODO: optimize in the future for big areas
-    static std::vector<uint8_t> buffer;
-    if (buffer.size() < 4u * m_mapSize.area())
-        buffer.resize(m_mapSize.area() * 4);
+    static std::vector<float> rowIntensity;
+    if (rowIntensity.size() < (size_t)m_mapSize.width())
+        rowIntensity.resize(m_mapSize.width());
+
+    const int width = m_mapSize.width();
+    const int height = m_mapSize.height();
+    const float spriteSize = g_sprites.spriteSize();
+    const uint8_t globalLight[4] = { m_globalLight.r(), m_globalLight.g(), m_globalLight.b(), 255 };
+    for (int index = 0; index < width * height; ++index)
+        memcpy(&buffer[index * 4], globalLight, 4);
+
+    // a light doesn't reach further than its intensity (in tiles), so every light is only
+    // evaluated over the rows of tiles inside its radius instead of over the whole map
+    for (size_t i = 0; i < m_lights.size(); ++i) {
+        const Light& light = m_lights[i];
+        if (light.intensity == 0)
+            continue;
+
+        // light position relative to the center of the first tile, in tiles
+        float lightX = (light.pos.x - spriteSize / 2) / spriteSize;
+        float lightY = (light.pos.y - spriteSize / 2) / spriteSize;
+        int minX = std::max<int>(0, std::floor(lightX - light.intensity));
+        int maxX = std::min<int>(width - 1, std::ceil(lightX + light.intensity));
+        int minY = std::max<int>(0, std::floor(lightY - light.intensity));
+        int maxY = std::min<int>(height - 1, std::ceil(lightY + light.intensity));
+        if (minX > maxX || minY > maxY)
+            continue;
+
+        Color color = Color::from8bit(light.color);
+        float lightIntensity = light.intensity;
+        float* intensities = rowIntensity.data();
+        for (int y = minY; y <= maxY; ++y) {
+            float dy = y - lightY;
+            // branchless, vectorized by GCC and clang since lightview.cpp is built without errno setting sqrt
+            for (int x = minX; x <= maxX; ++x) {
+                float dx = x - lightX;
+                float intensity = (lightIntensity - std::sqrt(dx * dx + dy * dy)) * 0.2f;
+                intensities[x] = std::min(intensity, 1.0f);
+            }
+
+            for (int x = minX; x <= maxX; ++x) {
+                float intensity = intensities[x];
+                if (intensity < 0.01f)
+                    continue;
+                int index = y * width + x;
+                if (i < m_tiles[index].start)
+                    continue;
+                Color lightColor = color * intensity;
+                uint8_t* pixel = &buffer[index * 4];
+                pixel[0] = std::max<uint8_t>(pixel[0], lightColor.r());
+                pixel[1] = std::max<uint8_t>(pixel[1], lightColor.g());
+                pixel[2] = std::max<uint8_t>(pixel[2], lightColor.b());
+            }
+        }
+    }
+}
 
+void LightView::fillBufferLegacy(uint8_t* buffer)
+{
     for (int x = 0; x < m_mapSize.width(); ++x) {
         for (int y = 0; y < m_mapSize.height(); ++y) {
             Point pos(x * g_sprites.spriteSize() + g_sprites.spriteSize() / 2, y * g_sprites.spriteSize() + g_sprites.spriteSize() / 2);
@@ -75,10 +131,30 @@ void LightView::draw() // render thread
             }
         }
     }
+}
+
+void LightView::draw() // render thread
+{
+    static std::vector<uint8_t> buffer;
+    if (buffer.size() < 4u * m_mapSize.area())
+        buffer.resize(m_mapSize.area() * 4);
+
+    ticks_t start = stdext::micros();
+    if (g_extras.legacyLightDraw)
+        fillBufferLegacy(buffer.data());
+    else
+        fillBuffer(buffer.data());
+    g_stats.addLightDraw(m_lights.size(), stdext::micros() - start);
+
+    const int width = m_mapSize.width();
+    const int height = m_mapSize.height();
 
     m_lightTexture->update();
     glBindTexture(GL_TEXTURE_2D, m_lightTexture->getId());
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_mapSize.width(), m_mapSize.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+    if (m_lightTexture->getSize() == m_mapSize) // storage is already allocated, only replace the pixels
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
 
     Point offset = m_src.topLeft();
     Size size = m_src.size();
@@ -54,6 +54,9 @@ public:
     void draw() override;
 
 private:
+    void fillBuffer(uint8_t* buffer);
+    void fillBufferLegacy(uint8_t* buffer);
+
     TexturePtr m_lightTexture;
     Size m_mapSize;
     Rect m_dest, m_src;
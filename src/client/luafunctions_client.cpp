@@ -80,6 +80,9 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_things", "findItemTypeByCategory", &ThingTypeManager::findItemTypeByCategory, &g_things);
     g_lua.bindSingletonFunction("g_things", "findThingTypeByAttr", &ThingTypeManager::findThingTypeByAttr, &g_things);
     g_lua.bindSingletonFunction("g_things", "getMarketCategories", &ThingTypeManager::getMarketCategories, &g_things);
+    g_lua.bindSingletonFunction("g_things", "setTextureBudget", &ThingTypeManager::setTextureBudget, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getTextureBudget", &ThingTypeManager::getTextureBudget, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getResidentTextureBytes", &ThingTypeManager::getResidentTextureBytes, &g_things);
     
     g_lua.registerSingletonClass("g_houses");
     g_lua.bindSingletonFunction("g_houses", "clear",          &HouseManager::clear,          &g_houses);
@@ -582,6 +585,8 @@ void Client::registerLuaFunctions()
     g_lua.registerClass<ItemType>();
     g_lua.bindClassMemberFunction<ItemType>("getServerId", &ItemType::getServerId);
     g_lua.bindClassMemberFunction<ItemType>("getClientId", &ItemType::getClientId);
+    g_lua.bindClassMemberFunction<ItemType>("getName", &ItemType::getName);
+    g_lua.bindClassMemberFunction<ItemType>("getCategory", &ItemType::getCategory);
     g_lua.bindClassMemberFunction<ItemType>("isWritable",  &ItemType::isWritable);
 
     g_lua.registerClass<ThingType>();
@@ -696,11 +701,11 @@ void Client::registerLuaFunctions()
     g_lua.bindClassMemberFunction<Item>("getCustomAttribute", &Item::getCustomAttribute);
 
     g_lua.registerClass<Effect, Thing>();
-    g_lua.bindClassStaticFunction<Effect>("create", []{ return std::make_shared<Effect>(); });
+    g_lua.bindClassStaticFunction<Effect>("create", &Effect::create);
     g_lua.bindClassMemberFunction<Effect>("setId", &Effect::setId);
 
     g_lua.registerClass<Missile, Thing>();
-    g_lua.bindClassStaticFunction<Missile>("create", []{ return std::make_shared<Missile>(); });
+    g_lua.bindClassStaticFunction<Missile>("create", &Missile::create);
     g_lua.bindClassMemberFunction<Missile>("setId", &Missile::setId);
     g_lua.bindClassMemberFunction<Missile>("getId", &Missile::getId);
     g_lua.bindClassMemberFunction<Missile>("getSource", &Missile::getSource);
@@ -34,6 +34,7 @@
 #include <framework/core/eventdispatcher.h>
 #include <framework/core/application.h>
 #include <framework/util/extras.h>
+#include <framework/util/stats.h>
 #include <set>
 
 Map g_map;
@@ -43,11 +44,21 @@ void Map::init()
 {
     resetAwareRange();
     m_animationFlags |= Animation_Show;
+    m_expirySlot = g_clock.millis() / EXPIRY_INTERVAL;
+    expireThings();
 }
 
 void Map::terminate()
 {
     clean();
+
+    if (m_expiryEvent) {
+        m_expiryEvent->cancel();
+        m_expiryEvent = nullptr;
+    }
+    for (auto& slot : m_expiryRing)
+        slot.clear();
+    m_expiringThings = 0;
 }
 
 void Map::addMapView(const MapViewPtr& mapView)
@@ -242,6 +253,44 @@ bool Map::removeThing(const ThingPtr& thing)
     return ret;
 }
 
+void Map::addExpiringThing(const ThingPtr& thing, int duration)
+{
+    // never behind the slot being swept, it would only be seen a whole round later
+    ticks_t expiry = g_clock.millis() + std::max<int>(0, duration);
+    ticks_t slot = std::max<ticks_t>(expiry / EXPIRY_INTERVAL, m_expirySlot);
+    m_expiryRing[slot % EXPIRY_SLOTS].push_back(ExpiringThing{ expiry, thing });
+    m_expiringThings += 1;
+}
+
+void Map::expireThings()
+{
+    m_expiryEvent = g_dispatcher.scheduleEvent(std::bind(&Map::expireThings, &g_map), EXPIRY_INTERVAL);
+
+    // every slot passed since the last sweep, the current one again as things can still be added to it
+    ticks_t now = g_clock.millis();
+    ticks_t lastSlot = now / EXPIRY_INTERVAL;
+    ticks_t firstSlot = std::max<ticks_t>(m_expirySlot, lastSlot - EXPIRY_SLOTS + 1);
+    m_expirySlot = lastSlot;
+    for (ticks_t slot = firstSlot; slot <= lastSlot; ++slot) {
+        auto& things = m_expiryRing[slot % EXPIRY_SLOTS];
+        if (things.empty())
+            continue;
+        // removing things may run scripts which add new ones to this slot
+        m_expired.swap(things);
+        for (auto& expiring : m_expired) {
+            if (expiring.expiry > now) {
+                things.push_back(std::move(expiring));
+                continue;
+            }
+            m_expiringThings -= 1;
+            removeThing(expiring.thing);
+        }
+        m_expired.clear();
+    }
+
+    g_stats.setExpiringThings(m_expiringThings);
+}
+
 bool Map::removeThingByPos(const Position& pos, int stackPos)
 {
     if(TilePtr tile = getTile(pos))
@@ -199,6 +199,8 @@ public:
     bool removeThingByPos(const Position& pos, int stackPos);
     void colorizeThing(const ThingPtr& thing, const Color& color);
     void removeThingColor(const ThingPtr& thing);
+    // removed by the expiry sweep once duration passes, effects and missiles don't schedule events of their own
+    void addExpiringThing(const ThingPtr& thing, int duration);
 
     StaticTextPtr getStaticText(const Position& pos);
 
@@ -277,7 +279,18 @@ public:
     bool checkSightLine(const Position& fromPos, const Position& toPos);
 
 private:
+    enum {
+        EXPIRY_INTERVAL = 10,
+        EXPIRY_SLOTS = 512 // ring of 10 ms slots, things expiring later than 5 s wait for a later round
+    };
+
+    struct ExpiringThing {
+        ticks_t expiry;
+        ThingPtr thing;
+    };
+
     void removeUnawareThings();
+    void expireThings();
     uint getBlockIndex(const Position& pos) { return ((pos.y / BLOCK_SIZE) * (65536 / BLOCK_SIZE)) + (pos.x / BLOCK_SIZE); }
 
     std::map<uint, TileBlock> m_tileBlocks[Otc::MAX_Z+1];
@@ -299,6 +312,12 @@ private:
 
     stdext::packed_storage<uint8> m_attribs;
     AwareRange m_awareRange;
+
+    std::array<std::vector<ExpiringThing>, EXPIRY_SLOTS> m_expiryRing;
+    std::vector<ExpiringThing> m_expired;
+    ticks_t m_expirySlot = 0;
+    size_t m_expiringThings = 0;
+    ScheduledEventPtr m_expiryEvent;
     static TilePtr m_nulltile;
 };
 
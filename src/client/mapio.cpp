@@ -31,6 +31,136 @@
 #include <framework/core/binarytree.h>
 #include <framework/xml/tinyxml.h>
 #include <framework/ui/uiwidget.h>
+#include <framework/util/extras.h>
+
+#include <future>
+
+namespace {
+
+// tile area decoded off the main thread, committed to the map in file order
+struct OtbmTileStaging {
+    Position pos;
+    uint32 houseId = 0;
+    bool isHouse = false;
+    uint32 flags = TILESTATE_NONE;
+    // items from tile attributes come first, then the item nodes
+    std::vector<ItemPtr> items;
+    size_t attributeItems = 0;
+};
+
+struct OtbmAreaStaging {
+    BinaryTreePtr node;
+    std::vector<OtbmTileStaging> tiles;
+    std::string error;
+};
+
+void decodeOtbmArea(OtbmAreaStaging& area)
+{
+    try {
+        const BinaryTreePtr& nodeMapData = area.node;
+        Position basePos;
+        basePos.x = nodeMapData->getU16();
+        basePos.y = nodeMapData->getU16();
+        basePos.z = nodeMapData->getU8();
+
+        for(const BinaryTreePtr &nodeTile : nodeMapData->getChildren()) {
+            uint8 type = nodeTile->getU8();
+            if(unlikely(type != OTBM_TILE && type != OTBM_HOUSETILE))
+                stdext::throw_exception(stdext::format("invalid node tile type %d", (int)type));
+
+            area.tiles.emplace_back();
+            OtbmTileStaging& tile = area.tiles.back();
+            tile.pos = basePos + nodeTile->getPoint();
+
+            if(type == OTBM_HOUSETILE) {
+                tile.isHouse = true;
+                tile.houseId = nodeTile->getU32();
+            }
+
+            while(nodeTile->canRead()) {
+                uint8 tileAttr = nodeTile->getU8();
+                switch(tileAttr) {
+                    case OTBM_ATTR_TILE_FLAGS: {
+                        uint32 _flags = nodeTile->getU32();
+                        if((_flags & TILESTATE_PROTECTIONZONE) == TILESTATE_PROTECTIONZONE)
+                            tile.flags |= TILESTATE_PROTECTIONZONE;
+                        else if((_flags & TILESTATE_OPTIONALZONE) == TILESTATE_OPTIONALZONE)
+                            tile.flags |= TILESTATE_OPTIONALZONE;
+                        else if((_flags & TILESTATE_HARDCOREZONE) == TILESTATE_HARDCOREZONE)
+                            tile.flags |= TILESTATE_HARDCOREZONE;
+
+                        if((_flags & TILESTATE_NOLOGOUT) == TILESTATE_NOLOGOUT)
+                            tile.flags |= TILESTATE_NOLOGOUT;
+
+                        if((_flags & TILESTATE_REFRESH) == TILESTATE_REFRESH)
+                            tile.flags |= TILESTATE_REFRESH;
+                        break;
+                    }
+                    case OTBM_ATTR_ITEM: {
+                        tile.items.push_back(Item::createFromOtb(nodeTile->getU16()));
+                        tile.attributeItems++;
+                        break;
+                    }
+                    default: {
+                        stdext::throw_exception(stdext::format("invalid tile attribute %d at pos %s",
+                                                           (int)tileAttr, stdext::to_string(tile.pos)));
+                    }
+                }
+            }
+
+            for(const BinaryTreePtr& nodeItem : nodeTile->getChildren()) {
+                if(unlikely(nodeItem->getU8() != OTBM_ITEM))
+                    stdext::throw_exception("invalid item node");
+
+                ItemPtr item = Item::createFromOtb(nodeItem->getU16());
+                item->unserializeItem(nodeItem);
+
+                if(item->isContainer()) {
+                    for(const BinaryTreePtr& containerItem : nodeItem->getChildren()) {
+                        if(containerItem->getU8() != OTBM_ITEM)
+                            stdext::throw_exception("invalid container item node");
+
+                        ItemPtr cItem = Item::createFromOtb(containerItem->getU16());
+                        cItem->unserializeItem(containerItem);
+                        item->addContainerItem(cItem);
+                    }
+                }
+
+                tile.items.push_back(item);
+            }
+        }
+    } catch(std::exception& e) {
+        area.error = e.what();
+    }
+    // the node isn't needed anymore, drop it while still on the decoding thread
+    area.node = nullptr;
+}
+
+void decodeOtbmAreas(std::vector<OtbmAreaStaging>& areas)
+{
+    const size_t MIN_AREAS_PER_THREAD = 16;
+    size_t threads = std::min<size_t>(std::max<uint>(std::thread::hardware_concurrency(), 1), areas.size() / MIN_AREAS_PER_THREAD);
+    if(threads <= 1) {
+        for(auto& area : areas)
+            decodeOtbmArea(area);
+        return;
+    }
+
+    // areas are interleaved between threads, neighbouring areas are usually alike in size
+    std::vector<std::future<void>> tasks;
+    for(size_t thread = 1; thread < threads; ++thread) {
+        tasks.push_back(std::async(std::launch::async, [&areas, thread, threads] {
+            for(size_t i = thread; i < areas.size(); i += threads)
+                decodeOtbmArea(areas[i]);
+        }));
+    }
+    for(size_t i = 0; i < areas.size(); i += threads)
+        decodeOtbmArea(areas[i]);
+    for(auto& task : tasks)
+        task.wait();
+}
+
+}
 
 void Map::loadOtbm(const std::string& fileName)
 {
@@ -49,7 +179,18 @@ void Map::loadOtbm(const std::string& fileName)
         if(memcmp(identifier, "OTBM", 4) != 0 && memcmp(identifier, "\0\0\0\0", 4) != 0)
             stdext::throw_exception(stdext::format("Invalid file identifier detected: %s", identifier));
 
-        BinaryTreePtr root = fin->getBinaryTree();
+        // the legacy loader streams every node from the file, the default one reads the whole
+        // image at once and indexes its nodes in a single pass
+        BinaryTreePtr root;
+        if(g_extras.legacyOtbmLoader) {
+            root = fin->getBinaryTree();
+        } else {
+            std::vector<uint8> image(fin->size() - fin->tell());
+            if(fin->read(image.data(), 1, image.size()) != (int)image.size())
+                stdext::throw_exception("Could not read map data");
+            root = std::make_shared<BinaryTreeIndex>(image.data(), image.size())->getRoot();
+        }
+
         if(root->getU8())
             stdext::throw_exception("could not read root property!");
 
@@ -95,95 +236,61 @@ void Map::loadOtbm(const std::string& fileName)
             }
         }
 
-        for(const BinaryTreePtr& nodeMapData : node->getChildren()) {
-            uint8 mapDataType = nodeMapData->getU8();
-            if(mapDataType == OTBM_TILE_AREA) {
-                Position basePos;
-                basePos.x = nodeMapData->getU16();
-                basePos.y = nodeMapData->getU16();
-                basePos.z = nodeMapData->getU8();
+        BinaryTreeVec mapData = node->getChildren();
+        std::vector<uint8> mapDataTypes;
+        std::vector<OtbmAreaStaging> areas;
+        for(const BinaryTreePtr& nodeMapData : mapData) {
+            mapDataTypes.push_back(nodeMapData->getU8());
+            if(mapDataTypes.back() == OTBM_TILE_AREA) {
+                areas.emplace_back();
+                areas.back().node = nodeMapData;
+            }
+        }
 
-                for(const BinaryTreePtr &nodeTile : nodeMapData->getChildren()) {
-                    uint8 type = nodeTile->getU8();
-                    if(unlikely(type != OTBM_TILE && type != OTBM_HOUSETILE))
-                        stdext::throw_exception(stdext::format("invalid node tile type %d", (int)type));
+        if(g_extras.legacyOtbmLoader) {
+            for(auto& area : areas)
+                decodeOtbmArea(area);
+        } else {
+            decodeOtbmAreas(areas);
+        }
 
+        size_t nextArea = 0;
+        for(size_t i = 0; i < mapData.size(); ++i) {
+            const BinaryTreePtr& nodeMapData = mapData[i];
+            uint8 mapDataType = mapDataTypes[i];
+            if(mapDataType == OTBM_TILE_AREA) {
+                OtbmAreaStaging& area = areas[nextArea++];
+                for(OtbmTileStaging& staged : area.tiles) {
                     HousePtr house = nullptr;
-                    uint32 flags = TILESTATE_NONE;
-                    Position pos = basePos + nodeTile->getPoint();
-
-                    if(type == OTBM_HOUSETILE) {
-                        uint32 hId = nodeTile->getU32();
-                        TilePtr tile = getOrCreateTile(pos);
-                        if(!(house = g_houses.getHouse(hId))) {
-                            house = std::make_shared<House>(hId);
+                    if(staged.isHouse) {
+                        TilePtr tile = getOrCreateTile(staged.pos);
+                        if(!(house = g_houses.getHouse(staged.houseId))) {
+                            house = std::make_shared<House>(staged.houseId);
                             g_houses.addHouse(house);
                         }
                         house->setTile(tile);
                     }
 
-                    while(nodeTile->canRead()) {
-                        uint8 tileAttr = nodeTile->getU8();
-                        switch(tileAttr) {
-                            case OTBM_ATTR_TILE_FLAGS: {
-                                uint32 _flags = nodeTile->getU32();
-                                if((_flags & TILESTATE_PROTECTIONZONE) == TILESTATE_PROTECTIONZONE)
-                                    flags |= TILESTATE_PROTECTIONZONE;
-                                else if((_flags & TILESTATE_OPTIONALZONE) == TILESTATE_OPTIONALZONE)
-                                    flags |= TILESTATE_OPTIONALZONE;
-                                else if((_flags & TILESTATE_HARDCOREZONE) == TILESTATE_HARDCOREZONE)
-                                    flags |= TILESTATE_HARDCOREZONE;
-
-                                if((_flags & TILESTATE_NOLOGOUT) == TILESTATE_NOLOGOUT)
-                                    flags |= TILESTATE_NOLOGOUT;
-
-                                if((_flags & TILESTATE_REFRESH) == TILESTATE_REFRESH)
-                                    flags |= TILESTATE_REFRESH;
-                                break;
-                            }
-                            case OTBM_ATTR_ITEM: {
-                                addThing(Item::createFromOtb(nodeTile->getU16()), pos);
-                                break;
-                            }
-                            default: {
-                                stdext::throw_exception(stdext::format("invalid tile attribute %d at pos %s",
-                                                                   (int)tileAttr, stdext::to_string(pos)));
-                            }
-                        }
-                    }
-
-                    for(const BinaryTreePtr& nodeItem : nodeTile->getChildren()) {
-                        if(unlikely(nodeItem->getU8() != OTBM_ITEM))
-                            stdext::throw_exception("invalid item node");
-
-                        ItemPtr item = Item::createFromOtb(nodeItem->getU16());
-                        item->unserializeItem(nodeItem);
-
-                        if(item->isContainer()) {
-                            for(const BinaryTreePtr& containerItem : nodeItem->getChildren()) {
-                                if(containerItem->getU8() != OTBM_ITEM)
-                                    stdext::throw_exception("invalid container item node");
-
-                                ItemPtr cItem = Item::createFromOtb(containerItem->getU16());
-                                cItem->unserializeItem(containerItem);
-                                item->addContainerItem(cItem);
-                            }
+                    for(size_t j = 0; j < staged.items.size(); ++j) {
+                        const ItemPtr& item = staged.items[j];
+                        // moveable items are escaped from houses, items from tile attributes are kept
+                        if(house && j >= staged.attributeItems && item->isMoveable()) {
+                            g_logger.warning(stdext::format("Moveable item found in house: %d at pos %s - escaping...", item->getId(), stdext::to_string(staged.pos)));
+                            continue;
                         }
-
-                        if(house && item->isMoveable()) {
-                            g_logger.warning(stdext::format("Moveable item found in house: %d at pos %s - escaping...", item->getId(), stdext::to_string(pos)));
-                            item.reset();
-                        }
-
-                        addThing(item, pos);
+                        addThing(item, staged.pos);
                     }
 
-                    if(const TilePtr& tile = getTile(pos)) {
+                    if(const TilePtr& tile = getTile(staged.pos)) {
                         if(house)
                             tile->setFlag(TILESTATE_HOUSE);
-                        tile->setFlag(flags);
+                        tile->setFlag(staged.flags);
                     }
                 }
+                // decoding stopped at the error, everything decoded before it is on the map like in a streamed load
+                if(!area.error.empty())
+                    stdext::throw_exception(area.error);
+                area.tiles.clear();
             } else if(mapDataType == OTBM_TOWNS) {
                 TownPtr town = nullptr;
                 for(const BinaryTreePtr &nodeTown : nodeMapData->getChildren()) {
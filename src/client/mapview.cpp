@@ -44,6 +44,7 @@
 #include <framework/graphics/shadermanager.h>
 
 #include <framework/util/extras.h>
+#include <framework/util/stats.h>
 #include <framework/core/adaptiverenderer.h>
 
 MapView::MapView()
@@ -131,6 +132,7 @@ void MapView::drawMapBackground(const Rect& rect, const TilePtr& crosshairTile)
                                                   std::max<int>(m_minimumAmbientLight * 255, ambientLight.intensity));
     }
 
+    ticks_t drawStart = stdext::micros();
     for (int z = m_cachedLastVisibleFloor; z >= m_cachedFirstFadingFloor; --z) {
         float fading = 1.0;
         if (m_floorFading > 0) {
@@ -154,8 +156,9 @@ void MapView::drawMapBackground(const Rect& rect, const TilePtr& crosshairTile)
         if (fading < 0.99)
             g_drawQueue->setOpacity(floorStart, fading);
     }
+    g_stats.addMapDraw(stdext::micros() - drawStart);
 
-    if(!m_shader.empty() && isFollowingCreature()) {
+    if(m_shader && isFollowingCreature()) {
         g_drawQueue->setShader(m_shader);
 
         Point walkOffset = transformPositionTo2D(getCameraPosition(), m_shaderPosition);
@@ -172,11 +175,16 @@ void MapView::drawMapBackground(const Rect& rect, const TilePtr& crosshairTile)
 
 void MapView::setShader(const std::string& shader)
 {
-    m_shader = shader;
-    if (!m_shader.empty())
+    m_shader = g_shaders.getShaderId(shader);
+    if (m_shader)
         m_shaderPosition = getCameraPosition();
 }
 
+std::string MapView::getShader()
+{
+    return g_shaders.getShaderName(m_shader);
+}
+
 void MapView::drawFloor(short floor, const Position& cameraPosition, const TilePtr& crosshairTile)
 {
     if (floor < 0 || floor > Otc::MAX_Z)
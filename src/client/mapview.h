@@ -114,10 +114,7 @@ public:
     void setCrosshair(const std::string& file);
 
     void setShader(const std::string& shader);
-    std::string getShader()
-    {
-        return m_shader;
-    }
+    std::string getShader();
 
     Position getPosition(const Point& point, const Size& mapSize);
 
@@ -159,7 +156,7 @@ private:
     bool m_drawPlayerBars = true;
     stdext::boolean<true> m_smooth;
 
-    std::string m_shader;
+    int m_shader = 0;
     Position m_shaderPosition;
 
     stdext::timer m_fadingFloorTimers[Otc::MAX_Z + 1];
@@ -41,9 +41,13 @@ Minimap g_minimap;
 
 void MinimapBlock::clean()
 {
+    std::lock_guard<std::mutex> lock(m_decompressLock);
     m_tiles.fill(MinimapTile());
     m_texture.reset();
+    m_compressedData.reset();
+    m_decompressed = true;
     m_mustUpdate = false;
+    m_revision++;
 }
 
 void MinimapBlock::update()
@@ -76,10 +80,64 @@ void MinimapBlock::update()
 
 void MinimapBlock::updateTile(int x, int y, const MinimapTile& tile)
 {
-    if(m_tiles[getTileIndex(x,y)].color != tile.color)
+    decompress();
+
+    MinimapTile& current = m_tiles[getTileIndex(x,y)];
+    if(current.color != tile.color)
         m_mustUpdate = true;
+    if(current != tile)
+        m_revision++;
+
+    current = tile;
+}
+
+void MinimapBlock::loadCompressedData(const MinimapBlockData_ptr& data)
+{
+    std::lock_guard<std::mutex> lock(m_decompressLock);
+    m_texture.reset();
+    m_compressedData = data;
+    m_compressedRevision = ++m_revision;
+    m_decompressed = false;
+}
+
+void MinimapBlock::setCompressedData(const MinimapBlockData_ptr& data, uint32 revision)
+{
+    std::lock_guard<std::mutex> lock(m_decompressLock);
+    // the tiles were changed after this data was compressed
+    if(revision != m_revision)
+        return;
+    m_compressedData = data;
+    m_compressedRevision = revision;
+}
 
-    m_tiles[getTileIndex(x,y)] = tile;
+MinimapBlockData_ptr MinimapBlock::getCompressedData(uint32 revision)
+{
+    std::lock_guard<std::mutex> lock(m_decompressLock);
+    if(!m_compressedData || m_compressedRevision != revision)
+        return nullptr;
+    return m_compressedData;
+}
+
+bool MinimapBlock::decompress()
+{
+    if(m_decompressed)
+        return true;
+
+    std::lock_guard<std::mutex> lock(m_decompressLock);
+    if(m_decompressed) // decompressed by another thread
+        return true;
+
+    ulong destLen = sizeof(MinimapBlockTiles);
+    int ret = uncompress((uchar*)m_tiles.data(), &destLen, m_compressedData->data(), m_compressedData->size());
+    if(ret != Z_OK || destLen != sizeof(MinimapBlockTiles)) {
+        g_logger.error("failed to decompress minimap block, data is corrupted");
+        m_tiles.fill(MinimapTile());
+        m_compressedData.reset();
+    }
+
+    m_mustUpdate = true;
+    m_decompressed = true;
+    return m_compressedData != nullptr;
 }
 
 void Minimap::init()
@@ -88,6 +146,7 @@ void Minimap::init()
 
 void Minimap::terminate()
 {
+    waitForSave();
     clean();
 }
 
@@ -115,6 +174,21 @@ void Minimap::draw(const Rect& screenRect, const Position& mapCenter, float scal
     Point off = Point((mapRect.size() * scale).toPoint() - screenRect.size().toPoint())/2;
     Point start = screenRect.topLeft() -(mapRect.topLeft() - blockOff)*scale - off;
 
+    // blocks seen for the first time are still compressed, decompress all of them at once
+    std::vector<MinimapBlock_ptr> compressedBlocks;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto& blocks = m_tileBlocks[mapCenter.z];
+        for(int y = std::max(blockOff.y, 0); y < std::min(mapRect.bottom() + 1, 65536); y += MMBLOCK_SIZE) {
+            for(int x = std::max(blockOff.x, 0); x < std::min(mapRect.right() + 1, 65536); x += MMBLOCK_SIZE) {
+                auto it = blocks.find(getBlockIndex(Position(x, y, mapCenter.z)));
+                if(it != blocks.end() && it->second && it->second->isCompressed())
+                    compressedBlocks.push_back(it->second);
+            }
+        }
+    }
+    decompressBlocks(compressedBlocks);
+
     for(int y = blockOff.y, ys = start.y;ys<screenRect.bottom();y += MMBLOCK_SIZE, ys += MMBLOCK_SIZE*scale) {
         if(y < 0 || y >= 65536)
             continue;
@@ -234,6 +308,31 @@ std::pair<MinimapBlock_ptr, MinimapTile> Minimap::threadGetTile(const Position&
     return std::make_pair(nullptr, nulltile);
 }
 
+void Minimap::decompressBlocks(const std::vector<MinimapBlock_ptr>& blocks)
+{
+    const size_t MIN_BLOCKS_PER_THREAD = 8;
+    size_t threads = std::min<size_t>(std::max<uint>(std::thread::hardware_concurrency(), 1), blocks.size() / MIN_BLOCKS_PER_THREAD);
+    if(threads <= 1) {
+        for(auto& block : blocks)
+            block->decompress();
+        return;
+    }
+
+    std::vector<std::future<void>> tasks;
+    size_t blocksPerThread = (blocks.size() + threads - 1) / threads;
+    for(size_t first = blocksPerThread; first < blocks.size(); first += blocksPerThread) {
+        size_t last = std::min(first + blocksPerThread, blocks.size());
+        tasks.push_back(std::async(std::launch::async, [&blocks, first, last] {
+            for(size_t i = first; i < last; ++i)
+                blocks[i]->decompress();
+        }));
+    }
+    for(size_t i = 0; i < blocksPerThread; ++i)
+        blocks[i]->decompress();
+    for(auto& task : tasks)
+        task.wait();
+}
+
 bool Minimap::loadImage(const std::string& fileName, const Position& topLeft, float colorFactor)
 {
     if(colorFactor <= 0.01f)
@@ -300,6 +399,7 @@ bool Minimap::loadImage(const std::string& fileName, const Position& topLeft, fl
                     tile.color = c;
                     tile.flags = flags;
                     block.mustUpdate();
+                    block.changed();
                 }
             }
         }
@@ -317,8 +417,12 @@ void Minimap::saveImage(const std::string& fileName, const Rect& mapRect)
 
 bool Minimap::loadOtmm(const std::string& fileName)
 {
+    // the file may still being written by a previous save
+    waitForSave();
+
     try {
-        FileStreamPtr fin = g_resources.openFile(fileName, g_game.getFeature(Otc::GameDontCacheFiles));
+        // the whole file is buffered, blocks keep only their compressed data until they are accessed
+        FileStreamPtr fin = g_resources.openFile(fileName, false);
         if(!fin)
             stdext::throw_exception("unable to open file");
 
@@ -331,7 +435,8 @@ bool Minimap::loadOtmm(const std::string& fileName)
         fin->getU32(); // flags
 
         switch(version) {
-            case 1: {
+            case 1:
+            case 2: {
                 fin->getString(); // description
                 break;
             }
@@ -340,11 +445,32 @@ bool Minimap::loadOtmm(const std::string& fileName)
         }
 
         fin->seek(start);
+        if(!loadOtmmBlocks(fin, version))
+            stdext::throw_exception("OTMM file is truncated or corrupted");
 
-        uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
-        std::vector<uchar> compressBuffer(compressBound(blockSize));
-        std::vector<uchar> decompressBuffer(blockSize);
+        fin->close();
+        return true;
+    } catch(stdext::exception& e) {
+        g_logger.error(stdext::format("failed to load OTMM minimap: %s", e.what()));
+        return false;
+    }
+}
+
+bool Minimap::loadOtmmBlocks(const FileStreamPtr& fin, uint16 version)
+{
+    auto readBlock = [&](const Position& pos, uint len) {
+        auto data = std::make_shared<MinimapBlockData>(len);
+        if(fin->read(data->data(), len) != 1)
+            return false;
+
+        MinimapBlock& block = getBlock(pos);
+        block.loadCompressedData(data);
+        block.justSaw();
+        return true;
+    };
 
+    if(version == 1) {
+        // version 1 has no block index, the blocks are stored one after another
         while(true) {
             Position pos;
             pos.x = fin->getU16();
@@ -355,102 +481,157 @@ bool Minimap::loadOtmm(const std::string& fileName)
             if(!pos.isValid() || pos.z >= Otc::MAX_Z+1)
                 break;
 
-            MinimapBlock& block = getBlock(pos);
-            ulong len = fin->getU16();
-            ulong destLen = blockSize;
-            fin->read(compressBuffer.data(), len);
-            int ret = uncompress(decompressBuffer.data(), &destLen, compressBuffer.data(), len);
-            if(ret != Z_OK || destLen != blockSize)
-                break;
-
-            memcpy((uchar*)&block.getTiles(), decompressBuffer.data(), blockSize);
-            block.mustUpdate();
-            block.justSaw();
+            uint len = fin->getU16();
+            if(!readBlock(pos, len))
+                return false;
         }
-
-        fin->close();
         return true;
-    } catch(stdext::exception& e) {
-        g_logger.error(stdext::format("failed to load OTMM minimap: %s", e.what()));
+    }
+
+    struct BlockIndex {
+        Position pos;
+        uint32 offset;
+        uint16 len;
+    };
+
+    // a corrupted count must not allocate more than the file holds
+    uint32 count = fin->getU32();
+    if((uint64)count * OTMM_INDEX_ENTRY_SIZE > fin->size() - fin->tell())
         return false;
+    std::vector<BlockIndex> index(count);
+    for(BlockIndex& entry : index) {
+        entry.pos.x = fin->getU16();
+        entry.pos.y = fin->getU16();
+        entry.pos.z = fin->getU8();
+        entry.offset = fin->getU32();
+        entry.len = fin->getU16();
+    }
+
+    for(const BlockIndex& entry : index) {
+        if(!entry.pos.isValid() || entry.pos.z >= Otc::MAX_Z+1)
+            continue;
+        fin->seek(entry.offset);
+        if(!readBlock(entry.pos, entry.len))
+            return false;
     }
+    return true;
 }
 
 void Minimap::saveOtmm(const std::string& fileName)
 {
-    try {
-        stdext::timer saveTimer;
-
-#ifndef ANDROID
-        std::string tmpFileName = fileName;
-        tmpFileName += ".tmp";
-        FileStreamPtr fin = g_resources.createFile(tmpFileName);
-#else
-        FileStreamPtr fin = g_resources.createFile(fileName);
-#endif
-
-        //TODO: compression flag with zlib
-        uint32 flags = 0;
-
-        // header
-        fin->addU32(OTMM_SIGNATURE);
-        fin->addU16(0); // data start, will be overwritten later
-        fin->addU16(OTMM_VERSION);
-        fin->addU32(flags);
-
-        // version 1 header
-        fin->addString("OTMM 1.0"); // description
-
-        // go back and rewrite where the map data starts
-        uint32 start = fin->tell();
-        fin->seek(4);
-        fin->addU16(start);
-        fin->seek(start);
-
-        uint blockSize = MMBLOCK_SIZE * MMBLOCK_SIZE * sizeof(MinimapTile);
-        std::vector<uchar> compressBuffer(compressBound(blockSize));
-        const int COMPRESS_LEVEL = 3;
-
+    // only one save at time, the next one must see the cached compressed data of the previous one
+    waitForSave();
+
+    struct SavedBlock {
+        Position pos;
+        MinimapBlock_ptr block;
+        uint32 revision;
+        MinimapBlockData_ptr data;
+        std::unique_ptr<MinimapBlockTiles> tiles;
+    };
+
+    // snapshot the blocks, the ones not changed since they were loaded or saved are already compressed
+    auto blocks = std::make_shared<std::vector<SavedBlock>>();
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
         for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
             for(auto& it : m_tileBlocks[z]) {
-                int index = it.first;
-                MinimapBlock& block = *it.second;
-                if(!block.wasSeen())
+                const MinimapBlock_ptr& block = it.second;
+                if(!block || !block->wasSeen())
                     continue;
 
-                Position pos = getIndexPosition(index, z);
-                fin->addU16(pos.x);
-                fin->addU16(pos.y);
-                fin->addU8(pos.z);
+                SavedBlock saved;
+                saved.pos = getIndexPosition(it.first, z);
+                saved.block = block;
+                saved.revision = block->getRevision();
+                saved.data = block->getCompressedData(saved.revision);
+                if(!saved.data)
+                    saved.tiles = std::make_unique<MinimapBlockTiles>(block->getTiles());
+                blocks->push_back(std::move(saved));
+            }
+        }
+    }
+
+    m_saveTask = std::async(std::launch::async, [blocks, fileName] {
+        try {
+            uint blockSize = sizeof(MinimapBlockTiles);
+            std::vector<uchar> compressBuffer(compressBound(blockSize));
+            const int COMPRESS_LEVEL = 3;
 
-                ulong len = blockSize;
-                int ret = compress2(compressBuffer.data(), &len, (uchar*)&block.getTiles(), blockSize, COMPRESS_LEVEL);
+            for(SavedBlock& saved : *blocks) {
+                if(saved.data)
+                    continue;
+
+                ulong len = compressBuffer.size();
+                int ret = compress2(compressBuffer.data(), &len, (uchar*)saved.tiles->data(), blockSize, COMPRESS_LEVEL);
                 VALIDATE(ret == Z_OK);
-                fin->addU16(len);
-                fin->write(compressBuffer.data(), len);
+                auto data = std::make_shared<MinimapBlockData>(compressBuffer.begin(), compressBuffer.begin() + len);
+                saved.block->setCompressedData(data, saved.revision);
+                saved.data = data;
+                saved.tiles.reset();
             }
-        }
 
-        // end of file
-        Position invalidPos;
-        fin->addU16(invalidPos.x);
-        fin->addU16(invalidPos.y);
-        fin->addU8(invalidPos.z);
+            // createFile is safe to call from this thread, it only uses PhysFS and the locked path cache
+#ifndef ANDROID
+            std::string tmpFileName = fileName;
+            tmpFileName += ".tmp";
+            FileStreamPtr fin = g_resources.createFile(tmpFileName);
+#else
+            FileStreamPtr fin = g_resources.createFile(fileName);
+#endif
+
+            //TODO: compression flag with zlib
+            uint32 flags = 0;
+
+            // header
+            fin->addU32(OTMM_SIGNATURE);
+            fin->addU16(0); // data start, will be overwritten later
+            fin->addU16(OTMM_VERSION);
+            fin->addU32(flags);
+
+            // version 2 header
+            fin->addString("OTMM 2.0"); // description
+
+            // go back and rewrite where the map data starts
+            uint32 start = fin->tell();
+            fin->seek(4);
+            fin->addU16(start);
+            fin->seek(start);
+
+            // version 2 block index
+            uint32 offset = start + 4 + blocks->size() * OTMM_INDEX_ENTRY_SIZE;
+            fin->addU32(blocks->size());
+            for(SavedBlock& saved : *blocks) {
+                fin->addPos(saved.pos.x, saved.pos.y, saved.pos.z);
+                fin->addU32(offset);
+                fin->addU16(saved.data->size());
+                offset += saved.data->size();
+            }
 
-        fin->flush();
+            for(SavedBlock& saved : *blocks)
+                fin->write(saved.data->data(), saved.data->size());
 
-        fin->close();
+            fin->flush();
+
+            fin->close();
 #ifndef ANDROID
-        std::filesystem::path filePath(g_resources.getWriteDir()), tmpFilePath(g_resources.getWriteDir());
-        filePath += fileName;
-        tmpFilePath += tmpFileName;
-        if(std::filesystem::file_size(tmpFilePath) > 1024) {
-            std::filesystem::rename(tmpFilePath, filePath);
-        }
+            std::filesystem::path filePath(g_resources.getWriteDir()), tmpFilePath(g_resources.getWriteDir());
+            filePath += fileName;
+            tmpFilePath += tmpFileName;
+            if(std::filesystem::file_size(tmpFilePath) > 1024) {
+                std::filesystem::rename(tmpFilePath, filePath);
+            }
 #endif
-    } catch (stdext::exception& e) {
-        g_logger.error(stdext::format("failed to save OTMM minimap: %s", e.what()));
-    } catch (std::exception& e) {
-        g_logger.error(stdext::format("failed to save OTMM minimap: %s", e.what()));
-    }
+        } catch (stdext::exception& e) {
+            g_logger.error(stdext::format("failed to save OTMM minimap: %s", e.what()));
+        } catch (std::exception& e) {
+            g_logger.error(stdext::format("failed to save OTMM minimap: %s", e.what()));
+        }
+    });
+}
+
+void Minimap::waitForSave()
+{
+    if(m_saveTask.valid())
+        m_saveTask.wait();
 }
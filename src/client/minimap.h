@@ -25,12 +25,14 @@
 #define MINIMAP_H
 
 #include "declarations.h"
+#include <framework/core/declarations.h>
 #include <framework/graphics/declarations.h>
 
 enum {
     MMBLOCK_SIZE = 64,
     OTMM_SIGNATURE = 0x4D4d544F,
-    OTMM_VERSION = 1
+    OTMM_VERSION = 2,
+    OTMM_INDEX_ENTRY_SIZE = 11 // position (5), data offset (4) and data length (2) of a block
 };
 
 enum MinimapTileFlags {
@@ -53,29 +55,48 @@ struct MinimapTile
     bool operator!=(const MinimapTile& other) const { return !(*this == other); }
 };
 
+#pragma pack(pop)
+
+using MinimapBlockData = std::vector<uint8>;
+using MinimapBlockData_ptr = std::shared_ptr<const MinimapBlockData>;
+using MinimapBlockTiles = std::array<MinimapTile, MMBLOCK_SIZE * MMBLOCK_SIZE>;
+
 class MinimapBlock
 {
 public:
     void clean();
     void update();
     void updateTile(int x, int y, const MinimapTile& tile);
-    MinimapTile& getTile(int x, int y) { return m_tiles[getTileIndex(x,y)]; }
-    void resetTile(int x, int y) { m_tiles[getTileIndex(x,y)] = MinimapTile(); }
+    MinimapTile& getTile(int x, int y) { decompress(); return m_tiles[getTileIndex(x,y)]; }
+    void resetTile(int x, int y) { decompress(); m_tiles[getTileIndex(x,y)] = MinimapTile(); m_revision++; }
     uint getTileIndex(int x, int y) { return ((y % MMBLOCK_SIZE) * MMBLOCK_SIZE) + (x % MMBLOCK_SIZE); }
     const TexturePtr& getTexture() { return m_texture; }
-    std::array<MinimapTile, MMBLOCK_SIZE * MMBLOCK_SIZE>& getTiles() { return m_tiles; }
+    MinimapBlockTiles& getTiles() { decompress(); return m_tiles; }
     void mustUpdate() { m_mustUpdate = true; }
     void justSaw() { m_wasSeen = true; }
     bool wasSeen() { return m_wasSeen; }
+    void changed() { m_revision++; }
+
+    // compressed block data, tiles are only decompressed when the block is first accessed
+    void loadCompressedData(const MinimapBlockData_ptr& data);
+    void setCompressedData(const MinimapBlockData_ptr& data, uint32 revision);
+    MinimapBlockData_ptr getCompressedData(uint32 revision);
+    bool isCompressed() { return !m_decompressed; }
+    bool decompress();
+    uint32 getRevision() { return m_revision; }
+
 private:
     TexturePtr m_texture;
-    std::array<MinimapTile, MMBLOCK_SIZE * MMBLOCK_SIZE> m_tiles;
+    MinimapBlockTiles m_tiles;
+    MinimapBlockData_ptr m_compressedData;
+    uint32 m_compressedRevision = 0;
+    std::atomic<uint32> m_revision{0};
+    std::atomic<bool> m_decompressed{true};
+    std::mutex m_decompressLock;
     stdext::boolean<true> m_mustUpdate;
     stdext::boolean<false> m_wasSeen;
 };
 
-#pragma pack(pop)
-
 using MinimapBlock_ptr = std::shared_ptr<MinimapBlock>;
 
 class Minimap
@@ -100,8 +121,11 @@ public:
     void saveImage(const std::string& fileName, const Rect& mapRect);
     bool loadOtmm(const std::string& fileName);
     void saveOtmm(const std::string& fileName);
+    void waitForSave();
 
 private:
+    void decompressBlocks(const std::vector<MinimapBlock_ptr>& blocks);
+    bool loadOtmmBlocks(const FileStreamPtr& fin, uint16 version);
     Rect calcMapRect(const Rect& screenRect, const Position& mapCenter, float scale);
     bool hasBlock(const Position& pos) { return m_tileBlocks[pos.z].find(getBlockIndex(pos)) != m_tileBlocks[pos.z].end(); }
     MinimapBlock& getBlock(const Position& pos) { 
@@ -118,6 +142,7 @@ private:
     uint getBlockIndex(const Position& pos) { return ((pos.y / MMBLOCK_SIZE) * (65536 / MMBLOCK_SIZE)) + (pos.x / MMBLOCK_SIZE); }
     std::unordered_map<uint, MinimapBlock_ptr> m_tileBlocks[Otc::MAX_Z+1];
     std::mutex m_lock;
+    std::future<void> m_saveTask;
 };
 
 extern Minimap g_minimap;
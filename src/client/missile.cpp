@@ -27,6 +27,7 @@
 #include "spritemanager.h"
 #include <framework/core/clock.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/stdext/pool.h>
 
 void Missile::draw(const Point& dest, bool animate, LightView* lightView)
 {
@@ -80,9 +81,12 @@ void Missile::setPath(const Position& fromPosition, const Position& toPosition)
     m_delta *= g_sprites.spriteSize();
     m_animationTimer.restart();
 
-    // schedule removal
-    auto self = asMissile();
-    g_dispatcher.scheduleEvent([self]() { g_map.removeThing(self); }, m_duration);
+    g_map.addExpiringThing(asMissile(), m_duration);
+}
+
+MissilePtr Missile::create()
+{
+    return stdext::make_pooled<Missile>();
 }
 
 void Missile::setId(uint32 id)
@@ -35,6 +35,9 @@ class Missile : public Thing
     };
 
 public:
+    // pooled like effects
+    static MissilePtr create();
+
     void draw(const Point& dest, bool animate = true, LightView* lightView = nullptr);
 
     void setId(uint32 id);
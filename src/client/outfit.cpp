@@ -32,6 +32,9 @@
 #include <framework/graphics/image.h>
 #include <framework/graphics/framebuffermanager.h>
 #include <framework/graphics/shadermanager.h>
+#include <framework/util/extras.h>
+#include <framework/util/stats.h>
+#include <typeinfo>
 
 Outfit::Outfit()
 {
@@ -42,6 +45,15 @@ Outfit::Outfit()
 }
 
 void Outfit::draw(Point dest, Otc::Direction direction, uint walkAnimationPhase, bool animate, LightView* lightView, bool ui)
+{
+    size_t start = g_drawQueue->size();
+    size_t conditions = g_drawQueue->conditionsSize();
+    drawLayers(dest, direction, walkAnimationPhase, animate, lightView, ui);
+    if (g_drawQueue->conditionsSize() == conditions)
+        composeLayers(start);
+}
+
+void Outfit::drawLayers(Point dest, Otc::Direction direction, uint walkAnimationPhase, bool animate, LightView* lightView, bool ui)
 {
     // direction correction
     if (m_category != ThingCategoryCreature)
@@ -297,7 +309,7 @@ void Outfit::draw(Point dest, Otc::Direction direction, uint walkAnimationPhase,
         }
 
         if (type->getLayers() <= 1) {
-            if (!m_shader.empty()) {
+            if (m_shader) {
                 std::shared_ptr<DrawOutfitParams> outfitParams = type->drawOutfit(dest, 0, direction, yPattern, zPattern, animationPhase, Color::white, lightView);
                 if (!outfitParams)
                     continue;
@@ -317,7 +329,7 @@ void Outfit::draw(Point dest, Otc::Direction direction, uint walkAnimationPhase,
             continue;
 
         DrawQueueItemTexturedRect* outfit = nullptr;
-        if (m_shader.empty())
+        if (!m_shader)
             outfit = new DrawQueueItemOutfit(outfitParams->dest, outfitParams->texture, outfitParams->src, outfitParams->offset, colors, outfitParams->color);
         else {
             if (yPattern == 0)
@@ -382,8 +394,76 @@ void Outfit::draw(Point dest, Otc::Direction direction, uint walkAnimationPhase,
 void Outfit::draw(const Rect& dest, Otc::Direction direction, uint animationPhase, bool animate, bool ui, bool oldScaling)
 {
     int size = g_drawQueue->size();
-    draw(Point(0, 0), direction, animationPhase, animate, nullptr, ui);
+    size_t conditions = g_drawQueue->conditionsSize();
+    drawLayers(Point(0, 0), direction, animationPhase, animate, nullptr, ui);
     g_drawQueue->correctOutfit(dest, size, oldScaling, m_center);
+    // composed like on the map when the widget draws the outfit unscaled
+    if (g_drawQueue->conditionsSize() == conditions)
+        composeLayers(size);
+}
+
+void Outfit::composeLayers(size_t start)
+{
+    size_t end = g_drawQueue->size();
+    int layers = end - start;
+    if (layers < 2 || g_extras.legacyOutfitDraw) {
+        g_stats.addOutfitDraw(layers, layers);
+        return;
+    }
+
+    // only unscaled sprites and colored templates with the same color can be composed, shaders are drawn as they are
+    Rect bounds;
+    Color color;
+    for (size_t i = start; i < end; ++i) {
+        DrawQueueItem* item = g_drawQueue->at(i);
+        if (typeid(*item) != typeid(DrawQueueItemTexturedRect) && typeid(*item) != typeid(DrawQueueItemOutfit)) {
+            g_stats.addOutfitDraw(layers, layers);
+            return;
+        }
+        DrawQueueItemTexturedRect* layer = static_cast<DrawQueueItemTexturedRect*>(item);
+        // the atlas region keeps color multiplied by alpha where layers are blended, which is only exact
+        // for fully transparent or opaque pixels, translucent auras, wings and alpha channel sprites stay layered
+        if (!layer->m_texture || layer->m_texture->hasPartialAlpha() ||
+            layer->m_dest.size() != layer->m_src.size() || (i > start && layer->m_color != color)) {
+            g_stats.addOutfitDraw(layers, layers);
+            return;
+        }
+        bounds = i == start ? layer->m_dest : bounds.united(layer->m_dest);
+        color = layer->m_color;
+    }
+
+    // the sprites, their placement and the template colors are what looktype, addons, colors, mount, wings, aura,
+    // direction and animation phases end up as, so they're hashed instead of the outfit itself
+    uint64_t hash = 0x6f75746669740000ULL + layers;
+    for (size_t i = start; i < end; ++i) {
+        DrawQueueItemTexturedRect* layer = static_cast<DrawQueueItemTexturedRect*>(g_drawQueue->at(i));
+        Point position = layer->m_dest.topLeft() - bounds.topLeft();
+        hash = hash * 1125899906842597ULL + layer->m_texture->getUniqueId();
+        hash = hash * 1125899906842597ULL + (((uint64_t)(uint16_t)position.x) << 48) + (((uint64_t)(uint16_t)position.y) << 32) +
+            (((uint64_t)(uint16_t)layer->m_src.x()) << 16) + (uint16_t)layer->m_src.y();
+        hash = hash * 1125899906842597ULL + (((uint64_t)(uint16_t)layer->m_src.width()) << 16) + (uint16_t)layer->m_src.height();
+        if (DrawQueueItemOutfit* outfit = dynamic_cast<DrawQueueItemOutfit*>(layer)) {
+            hash = hash * 1125899906842597ULL + (uint32_t)outfit->m_colors;
+            hash = hash * 1125899906842597ULL + (((uint64_t)(uint32_t)outfit->m_offset.x) << 32) + (uint32_t)outfit->m_offset.y;
+        }
+    }
+
+    std::vector<DrawQueueItemTexturedRect*> items;
+    items.reserve(layers);
+    for (DrawQueueItem* item : g_drawQueue->detach(start))
+        items.push_back(static_cast<DrawQueueItemTexturedRect*>(item));
+    g_drawQueue->add(new DrawQueueItemComposedOutfit(bounds, hash, items, color));
+    g_stats.addOutfitDraw(layers, 1);
+}
+
+void Outfit::setShader(const std::string& shader)
+{
+    m_shader = g_shaders.getShaderId(shader);
+}
+
+std::string Outfit::getShader() const
+{
+    return g_shaders.getShaderName(m_shader);
 }
 
 void Outfit::resetClothes()
@@ -457,6 +537,83 @@ void DrawQueueItemOutfit::draw(const Point& pos)
     g_painter->resetShaderProgram();
 }
 
+DrawQueueItemComposedOutfit::~DrawQueueItemComposedOutfit()
+{
+    for (auto& layer : m_layers)
+        delete layer;
+}
+
+bool DrawQueueItemComposedOutfit::cache()
+{
+    m_texture = nullptr;
+    for (auto& layer : m_layers) {
+        if (!layer->m_texture->canCache())
+            return false;
+    }
+
+    // a region evicted from the atlas is just composed again the next time it's needed
+    bool drawNow = false;
+    Point atlasPos = g_atlas.cache(m_hash, m_dest.size(), drawNow);
+    if (atlasPos.x < 0) { return false; } // can't be cached
+    if (drawNow) { g_drawCache.bind(); draw(atlasPos); }
+
+    if (!g_drawCache.hasSpace(6))
+        return false;
+
+    // kept for marks, which draw the item's texture again with their own color
+    m_texture = g_atlas.get(0);
+    m_src = Rect(atlasPos, m_dest.size());
+    g_drawCache.addTexturedRect(m_dest, m_src, m_color);
+    return true;
+}
+
+void DrawQueueItemComposedOutfit::draw()
+{
+    for (auto& layer : m_layers) {
+        layer->m_color = m_color;
+        if (!layer->cache()) {
+            g_drawCache.draw();
+            if (!layer->cache())
+                layer->draw();
+        }
+    }
+}
+
+void DrawQueueItemComposedOutfit::draw(const Point& pos)
+{
+    g_stats.addOutfitComposition();
+    // the region may still hold an evicted entry, layers are blended on top of each other
+    g_painter->setColor(Color::alpha);
+    g_painter->drawFilledRect(Rect(pos, m_dest.size()));
+    g_painter->setCompositionMode(Painter::CompositionMode_Normal);
+    for (auto& layer : m_layers) {
+        layer->m_texture->update();
+        Point layerPos = pos + (layer->m_dest.topLeft() - m_dest.topLeft());
+        g_painter->resetColor();
+        if (typeid(*layer) == typeid(DrawQueueItemOutfit))
+            layer->draw(layerPos);
+        else
+            g_painter->drawTexturedRect(Rect(layerPos, layer->m_src.size()), layer->m_texture, layer->m_src);
+    }
+    g_painter->setCompositionMode(Painter::CompositionMode_Replace);
+}
+
+DrawQueueItem* DrawQueueItemComposedOutfit::clone(const Point& offset)
+{
+    std::vector<DrawQueueItemTexturedRect*> layers;
+    layers.reserve(m_layers.size());
+    for (auto& layer : m_layers) {
+        DrawQueueItem* copy = layer->clone(offset);
+        if (!copy) {
+            for (auto& copied : layers)
+                delete copied;
+            return nullptr;
+        }
+        layers.push_back(static_cast<DrawQueueItemTexturedRect*>(copy));
+    }
+    return new DrawQueueItemComposedOutfit(m_dest.translated(offset), m_hash, layers, m_color);
+}
+
 void DrawQueueItemOutfitWithShader::draw()
 {
     if (!m_texture) return;
@@ -478,11 +635,10 @@ void DrawQueueItemOutfitWithShader::draw()
         mat4(x + 1, 3) = color.bF();
         mat4(x + 1, 4) = color.aF();
     }
-    g_painter->setShaderProgram(shader);
+    g_shaders.bindShader(m_shader);
     g_painter->setOffset(m_offset);
     shader->setMatrixColor(mat4);
     shader->setCenter(m_center);
-    shader->bindMultiTextures();
     if (useFramebuffer) {
         g_painter->drawTexturedRect(Rect(0, 0, m_src.size()), m_texture, m_src);
     } else {
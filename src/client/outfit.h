@@ -51,13 +51,13 @@ public:
     void setWings(int wings) { m_wings = wings; }
     void setAura(int aura) { m_aura = aura; }
     void setCategory(ThingCategory category) { m_category = category; }
-    void setShader(const std::string& shader) { m_shader = shader; }
+    void setShader(const std::string& shader);
     void setHealthBar(uint8 id) { m_healthBar = id; }
     void setManaBar(uint8 id) { m_manaBar = id; }
     void setCenter(bool value) { m_center = value; }
 
     void resetClothes();
-    void resetShader() { m_shader = ""; }
+    void resetShader() { m_shader = 0; }
 
     int getId() const { return m_id; }
     int getAuxId() const { return m_auxId; }
@@ -70,15 +70,18 @@ public:
     int getWings() const { return m_wings; }
     int getAura() const { return m_aura; }
     ThingCategory getCategory() const { return m_category; }
-    std::string getShader() const { return m_shader; }
+    std::string getShader() const;
     int getHealthBar() const { return m_healthBar; }
     int getManaBar() const { return m_manaBar; }
 
 private:
+    void drawLayers(Point dest, Otc::Direction direction, uint walkAnimationPhase, bool animate, LightView* lightView, bool ui);
+    void composeLayers(size_t start);
+
     ThingCategory m_category;
     int m_id, m_auxId, m_head, m_body, m_legs, m_feet, m_addons, m_mount = 0, m_wings = 0, m_aura = 0;
     int m_healthBar = 0, m_manaBar = 0;
-    std::string m_shader;
+    int m_shader = 0;
     bool m_center = false;
 };
 
@@ -90,13 +93,14 @@ struct DrawQueueItemOutfit : public DrawQueueItemTexturedRect {
     void draw() override;
     void draw(const Point& pos) override;
     bool cache() override;
+    DrawQueueItem* clone(const Point& offset) override { return new DrawQueueItemOutfit(m_dest.translated(offset), m_texture, m_src, m_offset, m_colors, m_color); }
 
     Point m_offset;
     int32_t m_colors;
 };
 
 struct DrawQueueItemOutfitWithShader : public DrawQueueItemTexturedRect {
-    DrawQueueItemOutfitWithShader(const Rect& rect, const TexturePtr& texture, const Rect& src, const Point& offset, const Point& center, int32_t colors, const std::string& shader) :
+    DrawQueueItemOutfitWithShader(const Rect& rect, const TexturePtr& texture, const Rect& src, const Point& offset, const Point& center, int32_t colors, int shader) :
         DrawQueueItemTexturedRect(rect, texture, src, Color::white), m_offset(offset), m_center(center), m_colors(colors), m_shader(shader)
     {};
 
@@ -111,7 +115,23 @@ struct DrawQueueItemOutfitWithShader : public DrawQueueItemTexturedRect {
     Point m_offset;
     Point m_center;
     int32_t m_colors;
-    std::string m_shader;
+    int m_shader;
+};
+
+// outfit layers drawn into one atlas region, keyed by everything which affects the final frame
+struct DrawQueueItemComposedOutfit : public DrawQueueItemTexturedRect {
+    DrawQueueItemComposedOutfit(const Rect& dest, uint64_t hash, const std::vector<DrawQueueItemTexturedRect*>& layers, const Color& color) :
+        DrawQueueItemTexturedRect(dest, nullptr, Rect(), color), m_hash(hash), m_layers(layers)
+    {};
+    ~DrawQueueItemComposedOutfit();
+
+    void draw() override;
+    void draw(const Point& pos) override;
+    bool cache() override;
+    DrawQueueItem* clone(const Point& offset) override;
+
+    uint64_t m_hash;
+    std::vector<DrawQueueItemTexturedRect*> m_layers;
 };
 
 #endif
@@ -1472,7 +1472,7 @@ void ProtocolGame::parseMagicEffect(const InputMessagePtr& msg)
                     return;
                 }
 
-                auto missile = std::make_shared<Missile>();
+                auto missile = Missile::create();
                 missile->setId(shotId);
                 missile->setPath(pos, Position(pos.x + offsetX, pos.y + offsetY, pos.z));
                 g_map.addThing(missile, pos);
@@ -1485,7 +1485,7 @@ void ProtocolGame::parseMagicEffect(const InputMessagePtr& msg)
                     return;
                 }
 
-                auto missile = std::make_shared<Missile>();
+                auto missile = Missile::create();
                 missile->setId(shotId);
                 missile->setPath(Position(pos.x + offsetX, pos.y + offsetY, pos.z), pos);
                 g_map.addThing(missile, pos);
@@ -1495,7 +1495,7 @@ void ProtocolGame::parseMagicEffect(const InputMessagePtr& msg)
                     g_logger.traceError(stdext::format("invalid effect id %d", effectId));
                     continue;
                 }
-                auto effect = std::make_shared<Effect>();
+                auto effect = Effect::create();
                 effect->setId(effectId);
                 g_map.addThing(effect, pos);
             }
@@ -1515,7 +1515,7 @@ void ProtocolGame::parseMagicEffect(const InputMessagePtr& msg)
         return;
     }
 
-    auto effect = std::make_shared<Effect>();
+    auto effect = Effect::create();
     effect->setId(effectId);
     g_map.addThing(effect, pos);
 }
@@ -1553,7 +1553,7 @@ void ProtocolGame::parseDistanceMissile(const InputMessagePtr& msg)
         return;
     }
 
-    MissilePtr missile = std::make_shared<Missile>();
+    MissilePtr missile = Missile::create();
     missile->setId(shotId);
     missile->setPath(fromPos, toPos);
     g_map.addThing(missile, fromPos);
@@ -21,6 +21,7 @@
  */
 
 #include "thingtype.h"
+#include "thingtypemanager.h"
 #include "spritemanager.h"
 #include "game.h"
 #include "lightview.h"
@@ -49,6 +50,12 @@ ThingType::ThingType()
     m_opacity = 1.0f;
 }
 
+ThingType::~ThingType()
+{
+    if(m_residentBytes > 0)
+        g_things.removeResidentTextures(this);
+}
+
 void ThingType::serialize(const FileStreamPtr& fin)
 {
     for(int i = 0; i < ThingLastAttr; ++i) {
@@ -133,6 +140,164 @@ void ThingType::serialize(const FileStreamPtr& fin)
     }
 }
 
+int ThingType::translateAttr(int attr)
+{
+    if(g_game.getClientVersion() >= 1000) {
+        /* In 10.10+ all attributes from 16 and up were
+         * incremented by 1 to make space for 16 as
+         * "No Movement Animation" flag.
+         */
+        if(attr == 16)
+            attr = ThingAttrNoMoveAnimation;
+        else if(attr > 16)
+            attr -= 1;
+    } else if(g_game.getClientVersion() >= 860) {
+        /* Default attribute values follow
+         * the format of 8.6-9.86.
+         * Therefore no changes here.
+         */
+    } else if(g_game.getClientVersion() >= 780) {
+        /* In 7.80-8.54 all attributes from 8 and higher were
+         * incremented by 1 to make space for 8 as
+         * "Item Charges" flag.
+         */
+        if(attr == 8)
+            attr = ThingAttrChargeable;
+        else if(attr > 8)
+            attr -= 1;
+    } else if(g_game.getClientVersion() >= 755) {
+        /* In 7.55-7.72 attributes 23 is "Floor Change". */
+        if(attr == 23)
+            attr = ThingAttrFloorChange;
+    } else if(g_game.getClientVersion() >= 740) {
+        /* In 7.4-7.5 attribute "Ground Border" did not exist
+         * attributes 1-15 have to be adjusted.
+         * Several other changes in the format.
+         */
+        if(attr > 0 && attr <= 15)
+            attr += 1;
+        else if(attr == 16)
+            attr = ThingAttrLight;
+        else if(attr == 17)
+            attr = ThingAttrFloorChange;
+        else if(attr == 18)
+            attr = ThingAttrFullGround;
+        else if(attr == 19)
+            attr = ThingAttrElevation;
+        else if(attr == 20)
+            attr = ThingAttrDisplacement;
+        else if(attr == 22)
+            attr = ThingAttrMinimapColor;
+        else if(attr == 23)
+            attr = ThingAttrRotateable;
+        else if(attr == 24)
+            attr = ThingAttrLyingCorpse;
+        else if(attr == 25)
+            attr = ThingAttrHangable;
+        else if(attr == 26)
+            attr = ThingAttrHookSouth;
+        else if(attr == 27)
+            attr = ThingAttrHookEast;
+        else if(attr == 28)
+            attr = ThingAttrAnimateAlways;
+
+        /* "Multi Use" and "Force Use" are swapped */
+        if(attr == ThingAttrMultiUse)
+            attr = ThingAttrForceUse;
+        else if(attr == ThingAttrForceUse)
+            attr = ThingAttrMultiUse;
+    }
+    return attr;
+}
+
+uint ThingType::getSerializedSize(ThingCategory category, const uint8* data, uint size)
+{
+    // mirrors unserialize, only reading what's needed to skip over the type
+    uint pos = 0;
+    auto need = [&](uint len) {
+        if(pos + len > size)
+            stdext::throw_exception(stdext::format("corrupt data (category: %d, offset: %d)", category, pos));
+    };
+    auto readU8 = [&]() -> uint8 { need(1); return data[pos++]; };
+    auto readU16 = [&]() -> uint16 { need(2); uint16 v = stdext::readULE16(data + pos); pos += 2; return v; };
+
+    bool done = false;
+    for(int i = 0; i < ThingLastAttr; ++i) {
+        int attr = readU8();
+        if(attr == ThingLastAttr) {
+            done = true;
+            break;
+        }
+
+        switch(translateAttr(attr)) {
+            case ThingAttrDisplacement:
+                if(g_game.getClientVersion() >= 755)
+                    pos += 4;
+                break;
+            case ThingAttrLight:
+                pos += 4;
+                break;
+            case ThingAttrMarket: {
+                pos += 6;
+                uint16 nameLength = readU16();
+                pos += nameLength + 4;
+                break;
+            }
+            case ThingAttrElevation:
+            case ThingAttrUsable:
+            case ThingAttrGround:
+            case ThingAttrWritable:
+            case ThingAttrWritableOnce:
+            case ThingAttrMinimapColor:
+            case ThingAttrCloth:
+            case ThingAttrLensHelp:
+                pos += 2;
+                break;
+            case ThingAttrBones:
+                pos += 16;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if(!done)
+        stdext::throw_exception(stdext::format("corrupt data (category: %d, offset: %d)", category, pos));
+
+    bool hasFrameGroups = (category == ThingCategoryCreature && g_game.getFeature(Otc::GameIdleAnimations));
+    uint8 groupCount = hasFrameGroups ? readU8() : 1;
+    uint spriteIdSize = g_game.getFeature(Otc::GameSpritesU32) ? 4 : 2;
+    uint totalSpritesCount = 0;
+
+    for(int i = 0; i < groupCount; ++i) {
+        if(hasFrameGroups)
+            readU8();
+
+        uint8 width = readU8();
+        uint8 height = readU8();
+        if(width > 1 || height > 1)
+            readU8();
+
+        uint layers = readU8();
+        uint patternX = readU8();
+        uint patternY = readU8();
+        uint patternZ = g_game.getClientVersion() >= 755 ? readU8() : 1;
+        uint phases = readU8();
+
+        if(phases > 1 && g_game.getFeature(Otc::GameEnhancedAnimations))
+            pos += 6 + phases * 8;
+
+        uint64 totalSprites = (uint64)width * height * layers * patternX * patternY * patternZ * phases;
+        if(totalSpritesCount + totalSprites > 4096)
+            stdext::throw_exception("a thing type has more than 4096 sprites");
+        totalSpritesCount += totalSprites;
+        pos += totalSprites * spriteIdSize;
+    }
+
+    need(0);
+    return pos;
+}
+
 void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileStreamPtr& fin)
 {
     m_null = false;
@@ -149,72 +314,7 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
             break;
         }
 
-        if(g_game.getClientVersion() >= 1000) {
-            /* In 10.10+ all attributes from 16 and up were
-             * incremented by 1 to make space for 16 as
-             * "No Movement Animation" flag.
-             */
-            if(attr == 16)
-                attr = ThingAttrNoMoveAnimation;
-            else if(attr > 16)
-                attr -= 1;
-        } else if(g_game.getClientVersion() >= 860) {
-            /* Default attribute values follow
-             * the format of 8.6-9.86.
-             * Therefore no changes here.
-             */
-        } else if(g_game.getClientVersion() >= 780) {
-            /* In 7.80-8.54 all attributes from 8 and higher were
-             * incremented by 1 to make space for 8 as
-             * "Item Charges" flag.
-             */
-            if(attr == 8) {
-                m_attribs.set(ThingAttrChargeable, true);
-                continue;
-            } else if(attr > 8)
-                attr -= 1;
-        } else if(g_game.getClientVersion() >= 755) {
-            /* In 7.55-7.72 attributes 23 is "Floor Change". */
-            if(attr == 23)
-                attr = ThingAttrFloorChange;
-        } else if(g_game.getClientVersion() >= 740) {
-            /* In 7.4-7.5 attribute "Ground Border" did not exist
-             * attributes 1-15 have to be adjusted.
-             * Several other changes in the format.
-             */
-            if(attr > 0 && attr <= 15)
-                attr += 1;
-            else if(attr == 16)
-                attr = ThingAttrLight;
-            else if(attr == 17)
-                attr = ThingAttrFloorChange;
-            else if(attr == 18)
-                attr = ThingAttrFullGround;
-            else if(attr == 19)
-                attr = ThingAttrElevation;
-            else if(attr == 20)
-                attr = ThingAttrDisplacement;
-            else if(attr == 22)
-                attr = ThingAttrMinimapColor;
-            else if(attr == 23)
-                attr = ThingAttrRotateable;
-            else if(attr == 24)
-                attr = ThingAttrLyingCorpse;
-            else if(attr == 25)
-                attr = ThingAttrHangable;
-            else if(attr == 26)
-                attr = ThingAttrHookSouth;
-            else if(attr == 27)
-                attr = ThingAttrHookEast;
-            else if(attr == 28)
-                attr = ThingAttrAnimateAlways;
-
-            /* "Multi Use" and "Force Use" are swapped */
-            if(attr == ThingAttrMultiUse)
-                attr = ThingAttrForceUse;
-            else if(attr == ThingAttrForceUse)
-                attr = ThingAttrMultiUse;
-        }
+        attr = translateAttr(attr);
 
         switch(attr) {
             case ThingAttrDisplacement: {
@@ -492,6 +592,9 @@ void ThingType::unserializeOtml(const OTMLNodePtr& node)
 
 void ThingType::unload()
 {
+    if(m_residentBytes > 0)
+        g_things.removeResidentTextures(this);
+
     m_textures.clear();
     m_texturesFramesRects.clear();
     m_texturesFramesOriginRects.clear();
@@ -635,7 +738,7 @@ Rect ThingType::getDrawSize(const Point& dest, int layer, int xPattern, int yPat
     return Rect(dest + textureOffset - m_displacement - (m_size.toPoint() - Point(1, 1)) * g_sprites.spriteSize(), textureRect.size());
 }
 
-void ThingType::drawWithShader(const Point& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, const std::string& shader, Color color, LightView* lightView)
+void ThingType::drawWithShader(const Point& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, int shader, Color color, LightView* lightView)
 {
     if (m_null)
         return;
@@ -669,7 +772,7 @@ void ThingType::drawWithShader(const Point& dest, int layer, int xPattern, int y
     //return g_drawQueue->addTexturedRect(screenRect, texture, textureRect, color);
 }
 
-void ThingType::drawWithShader(const Rect& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, const std::string& shader, Color color)
+void ThingType::drawWithShader(const Rect& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, int shader, Color color)
 {
     if (m_null)
         return;
@@ -716,6 +819,7 @@ void ThingType::drawWithShader(const Rect& dest, int layer, int xPattern, int yP
 const TexturePtr& ThingType::getTexture(int animationPhase)
 {
     m_lastUsage = g_clock.seconds();
+    m_lastUseFrame = g_things.getResidencyFrame();
 
     int spriteSize = g_sprites.spriteSize();
     TexturePtr& animationPhaseTexture = m_textures[animationPhase];
@@ -742,6 +846,7 @@ const TexturePtr& ThingType::getTexture(int animationPhase)
         else
             fullImage = std::make_shared<Image>(textureSize * spriteSize);
 
+        bool partialAlpha = false;
         m_texturesFramesRects[animationPhase].resize(indexSize);
         m_texturesFramesOriginRects[animationPhase].resize(indexSize);
         m_texturesFramesOffsets[animationPhase].resize(indexSize);
@@ -774,6 +879,8 @@ const TexturePtr& ThingType::getTexture(int animationPhase)
                         for(int x = framePos.x; x < framePos.x + m_size.width() * spriteSize; ++x) {
                             for(int y = framePos.y; y < framePos.y + m_size.height() * spriteSize; ++y) {
                                 uint8 *p = fullImage->getPixel(x,y);
+                                if(p[3] != 0x00 && p[3] != 0xFF)
+                                    partialAlpha = true;
                                 if(p[3] != 0x00) {
                                     drawRect.setTop   (std::min<int>(y, (int)drawRect.top()));
                                     drawRect.setLeft  (std::min<int>(x, (int)drawRect.left()));
@@ -791,7 +898,15 @@ const TexturePtr& ThingType::getTexture(int animationPhase)
             }
         }
         animationPhaseTexture = std::make_shared<Texture>(fullImage, true, false, false);
+        animationPhaseTexture->setPartialAlpha(partialAlpha);
         m_loaded = true;
+
+        if(m_evicted) {
+            g_stats.addTextureReload();
+            m_evicted = false;
+        }
+        // rgba with a full mipmap chain
+        g_things.addResidentTexture(this, (size_t)fullImage->getSize().area() * 4 * 4 / 3);
     }
     return animationPhaseTexture;
 }
@@ -866,6 +981,7 @@ void ThingType::setPathable(bool var)
         m_attribs.remove(ThingAttrNotPathable);
     else
         m_attribs.set(ThingAttrNotPathable, true);
+    g_things.invalidateSearchIndex();
 }
 
 void DrawQueueItemThingWithShader::draw()
@@ -881,10 +997,9 @@ void DrawQueueItemThingWithShader::draw()
         g_painter->clear(Color::alpha);
     }
 
-    g_painter->setShaderProgram(shader);
+    g_shaders.bindShader(m_shader);
     g_painter->setOffset(m_offset);
     shader->setCenter(m_center);
-    shader->bindMultiTextures();
     if (useFramebuffer) {
         g_painter->drawTexturedRect(Rect(0, 0, m_src.size()), m_texture, m_src);
     }
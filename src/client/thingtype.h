@@ -170,8 +170,12 @@ class ThingType : public LuaObject
 {
 public:
     ThingType();
+    ~ThingType();
 
     void unserialize(uint16 clientId, ThingCategory category, const FileStreamPtr& fin);
+    // size of a serialized type starting at data, without decoding it
+    static uint getSerializedSize(ThingCategory category, const uint8* data, uint size);
+    static int translateAttr(int attr);
     void unserializeOtml(const OTMLNodePtr& node);
     void unload();
 
@@ -183,8 +187,8 @@ public:
     DrawQueueItem* draw(const Rect& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, Color color = Color::white);
     std::shared_ptr<DrawOutfitParams> drawOutfit(const Point& dest, int maskLayer, int xPattern, int yPattern, int zPattern, int animationPhase, Color color = Color::white, LightView* lightView = nullptr);
     Rect getDrawSize(const Point& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase);
-    void drawWithShader(const Point& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, const std::string& shader, Color color = Color::white, LightView* lightView = nullptr);
-    void drawWithShader(const Rect& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, const std::string& shader, Color color = Color::white);
+    void drawWithShader(const Point& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, int shader, Color color = Color::white, LightView* lightView = nullptr);
+    void drawWithShader(const Rect& dest, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, int shader, Color color = Color::white);
 
     uint16 getId() { return m_id; }
     ThingCategory getCategory() { return m_category; }
@@ -299,10 +303,19 @@ private:
 
     bool m_loaded = false;
     time_t m_lastUsage;
+
+    // texture residency, an intrusive LRU list owned by g_things
+    friend class ThingTypeManager;
+    ThingType* m_residentPrev = nullptr;
+    ThingType* m_residentNext = nullptr;
+    size_t m_residentBytes = 0;
+    uint32 m_residentFrame = 0;
+    uint32 m_lastUseFrame = 0;
+    bool m_evicted = false;
 };
 
 struct DrawQueueItemThingWithShader : public DrawQueueItemTexturedRect {
-    DrawQueueItemThingWithShader(const Rect& rect, const TexturePtr& texture, const Rect& src, const Point& offset, const Point& center, int32_t colors, const std::string& shader) :
+    DrawQueueItemThingWithShader(const Rect& rect, const TexturePtr& texture, const Rect& src, const Point& offset, const Point& center, int32_t colors, int shader) :
         DrawQueueItemTexturedRect(rect, texture, src, Color::white), m_offset(offset), m_center(center), m_colors(colors), m_shader(shader)
     {};
 
@@ -317,7 +330,7 @@ struct DrawQueueItemThingWithShader : public DrawQueueItemTexturedRect {
     Point m_offset;
     Point m_center;
     int32_t m_colors;
-    std::string m_shader;
+    int m_shader;
 };
 
 #endif
@@ -28,6 +28,7 @@
 #include "creature.h"
 #include "creatures.h"
 #include "game.h"
+#include "tile.h"
 
 #include <framework/core/resourcemanager.h>
 #include <framework/core/filestream.h>
@@ -35,6 +36,9 @@
 #include <framework/xml/tinyxml.h>
 #include <framework/otml/otml.h>
 #include <framework/util/stats.h>
+#include <framework/util/extras.h>
+
+#include <future>
 
 ThingTypeManager g_things;
 
@@ -51,7 +55,6 @@ void ThingTypeManager::init()
     m_otbLoaded = false;
     for (int i = 0; i < ThingLastCategory; ++i) {
         m_thingTypes[i].resize(1, m_nullThingType);
-        m_checkIndex[i] = 0;
     }
     m_itemTypes.resize(1, m_nullItemType);
 
@@ -65,6 +68,12 @@ void ThingTypeManager::terminate()
     m_itemTypes.clear();
     m_reverseItemTypes.clear();
     m_marketCategories.clear();
+    m_nameIndex.clear();
+    m_nameTrigramIndex.clear();
+    for(auto& category : m_itemCategoryIndex)
+        category.clear();
+    m_attrIndex.clear();
+    invalidateSearchIndex();
     m_nullThingType = nullptr;
     m_nullItemType = nullptr;
 
@@ -75,22 +84,76 @@ void ThingTypeManager::terminate()
 }
 
 void ThingTypeManager::check()
-{    
-    // removes unused textures from memory after 60s, 500 checks / s
-    m_checkEvent = g_dispatcher.scheduleEvent(std::bind(&ThingTypeManager::check, &g_things), 1000);
-
-    for (size_t i = 0; i < ThingLastCategory; ++i) {
-        size_t limit = std::min<size_t>(m_checkIndex[i] + 100, m_thingTypes[i].size());
-        for (size_t j = m_checkIndex[i]; j < limit; ++j) {
-            if (m_thingTypes[i][j]->isLoaded() && m_thingTypes[i][j]->getLastUsage() + 60 < g_clock.seconds()) {
-                m_thingTypes[i][j]->unload();
-            }
-        }
-        m_checkIndex[i] = limit;
-        if (m_checkIndex[i] >= m_thingTypes[i].size()) {
-            m_checkIndex[i] = 0;
+{
+    // evicts least recently used textures until the resident ones fit in the budget, a slice of time every frame
+    m_checkEvent = g_dispatcher.scheduleEvent(std::bind(&ThingTypeManager::check, &g_things), RESIDENCY_FRAME_INTERVAL);
+    // textures are stamped with the frame they're used in, the ones stamped with this frame were used since the last sweep
+    uint32 sweepFrame = m_residencyFrame;
+    m_residencyFrame += 1;
+
+    ticks_t start = stdext::micros();
+    int steps = 0;
+    while(m_residentBytes > m_textureBudget && m_residentTail) {
+        ThingType* type = m_residentTail;
+        // everything left was used since this pass began moving textures to the front
+        if(type->m_residentFrame == m_residencyFrame)
+            break;
+
+        if(type->m_lastUseFrame >= sweepFrame || type->m_lastUseFrame > type->m_residentFrame) {
+            // used since the last sweep or since it was last placed at the front, give it another round
+            unlinkResident(type);
+            linkResident(type);
+        } else {
+            type->unload();
+            type->m_evicted = true;
+            g_stats.addTextureEviction();
         }
+
+        if(++steps % 16 == 0 && stdext::micros() - start > RESIDENCY_TIME_SLICE)
+            break;
     }
+
+    g_stats.setTextureResidency(m_residentBytes, m_textureBudget);
+}
+
+void ThingTypeManager::addResidentTexture(ThingType* type, size_t bytes)
+{
+    if(type->m_residentBytes == 0)
+        linkResident(type);
+    type->m_residentBytes += bytes;
+    m_residentBytes += bytes;
+}
+
+void ThingTypeManager::removeResidentTextures(ThingType* type)
+{
+    m_residentBytes -= type->m_residentBytes;
+    type->m_residentBytes = 0;
+    unlinkResident(type);
+}
+
+void ThingTypeManager::linkResident(ThingType* type)
+{
+    type->m_residentFrame = m_residencyFrame;
+    type->m_residentPrev = nullptr;
+    type->m_residentNext = m_residentHead;
+    if(m_residentHead)
+        m_residentHead->m_residentPrev = type;
+    else
+        m_residentTail = type;
+    m_residentHead = type;
+}
+
+void ThingTypeManager::unlinkResident(ThingType* type)
+{
+    if(type->m_residentPrev)
+        type->m_residentPrev->m_residentNext = type->m_residentNext;
+    else
+        m_residentHead = type->m_residentNext;
+    if(type->m_residentNext)
+        type->m_residentNext->m_residentPrev = type->m_residentPrev;
+    else
+        m_residentTail = type->m_residentPrev;
+    type->m_residentPrev = type->m_residentNext = nullptr;
 }
 
 #ifdef WITH_ENCRYPTION
@@ -172,6 +235,7 @@ bool ThingTypeManager::loadDat(std::string file)
     m_datLoaded = false;
     m_datSignature = 0;
     m_contentRevision = 0;
+    invalidateSearchIndex();
     try {
         file = g_resources.guessFilePath(file, "dat");
 
@@ -186,15 +250,23 @@ bool ThingTypeManager::loadDat(std::string file)
             m_thingTypes[category].resize(count, m_nullThingType);
         }
 
+        if(g_extras.legacyDatLoader) {
+            for(int category = 0; category < ThingLastCategory; ++category) {
+                uint16 firstId = 1;
+                if(category == ThingCategoryItem)
+                    firstId = 100;
+                for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id) {
+                    auto type = std::make_shared<ThingType>();
+                    type->unserialize(id, (ThingCategory)category, fin);
+                    m_thingTypes[category][id] = type;
+                }
+            }
+        } else
+            unserializeDat(fin);
+
         m_marketCategories.clear();
         for(int category = 0; category < ThingLastCategory; ++category) {
-            uint16 firstId = 1;
-            if(category == ThingCategoryItem)
-                firstId = 100;
-            for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id) {
-                auto type = std::make_shared<ThingType>();
-                type->unserialize(id, (ThingCategory)category, fin);
-                m_thingTypes[category][id] = type;
+            for(const ThingTypePtr& type : m_thingTypes[category]) {
                 if (type->isMarketable()) {
                     auto marketData = type->getMarketData();
                     m_marketCategories.insert(marketData.category);
@@ -203,6 +275,8 @@ bool ThingTypeManager::loadDat(std::string file)
         }
 
         m_datLoaded = true;
+        // elevations and patterns in the tile draw lists come from the old types
+        Tile::invalidateDrawLists();
         g_lua.callGlobalField("g_things", "onLoadDat", file);
         return true;
     } catch(stdext::exception& e) {
@@ -211,8 +285,81 @@ bool ThingTypeManager::loadDat(std::string file)
     }
 }
 
+void ThingTypeManager::unserializeDat(const FileStreamPtr& fin)
+{
+    struct DatEntry {
+        uint16 id;
+        uint8 category;
+        uint begin;
+        uint end;
+    };
+
+    // first pass, read the whole image and find where every type starts and ends
+    std::string image(fin->size() - fin->tell(), '\0');
+    if(fin->read(&image[0], 1, image.size()) != (int)image.size())
+        stdext::throw_exception("unable to read dat");
+
+    std::vector<DatEntry> entries;
+    uint pos = 0;
+    for(int category = 0; category < ThingLastCategory; ++category) {
+        uint16 firstId = 1;
+        if(category == ThingCategoryItem)
+            firstId = 100;
+        for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id) {
+            uint size = ThingType::getSerializedSize((ThingCategory)category, (const uint8*)image.data() + pos, image.size() - pos);
+            entries.push_back({id, (uint8)category, pos, pos + size});
+            pos += size;
+        }
+    }
+
+    // second pass, decode contiguous chunks of types in parallel
+    auto decode = [&](size_t first, size_t last) -> std::string {
+        if(first >= last)
+            return "";
+        try {
+            // leading byte keeps a chunk that happens to start like a gzip header from being inflated
+            uint chunkBegin = entries[first].begin;
+            std::string chunk(1, '\0');
+            chunk.append(image, chunkBegin, entries[last - 1].end - chunkBegin);
+            auto chunkStream = std::make_shared<FileStream>(fin->name(), std::move(chunk));
+            for(size_t i = first; i < last; ++i) {
+                const DatEntry& entry = entries[i];
+                chunkStream->seek(entry.begin - chunkBegin + 1);
+                auto type = std::make_shared<ThingType>();
+                type->unserialize(entry.id, (ThingCategory)entry.category, chunkStream);
+                if(chunkStream->tell() != entry.end - chunkBegin + 1)
+                    stdext::throw_exception(stdext::format("corrupt data (id: %d, category: %d)", entry.id, (int)entry.category));
+                m_thingTypes[entry.category][entry.id] = type;
+            }
+        } catch(std::exception& e) {
+            return e.what();
+        }
+        return "";
+    };
+
+    const size_t MIN_TYPES_PER_THREAD = 1024;
+    size_t threads = std::min<size_t>(std::max<uint>(std::thread::hardware_concurrency(), 1), entries.size() / MIN_TYPES_PER_THREAD);
+    threads = std::max<size_t>(threads, 1);
+    size_t typesPerThread = (entries.size() + threads - 1) / threads;
+
+    std::vector<std::future<std::string>> tasks;
+    for(size_t first = typesPerThread; first < entries.size(); first += typesPerThread) {
+        size_t last = std::min(first + typesPerThread, entries.size());
+        tasks.push_back(std::async(std::launch::async, decode, first, last));
+    }
+    std::string error = decode(0, std::min(typesPerThread, entries.size()));
+    for(auto& task : tasks) {
+        std::string taskError = task.get();
+        if(error.empty())
+            error = taskError;
+    }
+    if(!error.empty())
+        stdext::throw_exception(error);
+}
+
 bool ThingTypeManager::loadOtml(std::string file)
 {
+    invalidateSearchIndex();
     try {
         file = g_resources.guessFilePath(file, "otml");
 
@@ -291,6 +438,7 @@ void ThingTypeManager::loadOtb(const std::string& file)
         }
 
         m_otbLoaded = true;
+        invalidateSearchIndex();
         g_lua.callGlobalField("g_things", "onLoadOtb", file);
     } catch (std::exception& e) {
         g_logger.error(stdext::format("Failed to load '%s' (OTB file): %s", file, e.what()));
@@ -343,6 +491,7 @@ void ThingTypeManager::loadXml(const std::string& file)
 
         doc.Clear();
         m_xmlLoaded = true;
+        invalidateSearchIndex();
         g_logger.debug("items.xml read successfully.");
     } catch(std::exception& e) {
         g_logger.error(stdext::format("Failed to load '%s' (XML file): %s", file, e.what()));
@@ -411,6 +560,7 @@ void ThingTypeManager::addItemType(const ItemTypePtr& itemType)
     if(unlikely(id >= m_itemTypes.size()))
         m_itemTypes.resize(id + 1, m_nullItemType);
     m_itemTypes[id] = itemType;
+    invalidateSearchIndex();
 }
 
 const ItemTypePtr& ThingTypeManager::findItemTypeByClientId(uint16 id)
@@ -424,29 +574,98 @@ const ItemTypePtr& ThingTypeManager::findItemTypeByClientId(uint16 id)
         return m_nullItemType;
 }
 
+namespace {
+
+std::string foldName(std::string name)
+{
+    stdext::tolower(name);
+    return name;
+}
+
+uint32 nameTrigram(const std::string& name, size_t pos)
+{
+    return (uint8)name[pos] | ((uint8)name[pos + 1] << 8) | ((uint8)name[pos + 2] << 16);
+}
+
+}
+
+void ThingTypeManager::updateSearchIndex()
+{
+    if(!m_searchIndexDirty)
+        return;
+    m_searchIndexDirty = false;
+
+    m_nameIndex.clear();
+    m_nameTrigramIndex.clear();
+    for(auto& category : m_itemCategoryIndex)
+        category.clear();
+    m_attrIndex.clear();
+
+    for(size_t i = 0; i < m_itemTypes.size(); ++i) {
+        const ItemTypePtr& type = m_itemTypes[i];
+        if(type->getCategory() < ItemCategoryLast)
+            m_itemCategoryIndex[type->getCategory()].push_back(i);
+
+        std::string name = foldName(type->getName());
+        m_nameIndex[name].push_back(i);
+        for(size_t pos = 0; pos + 3 <= name.size(); ++pos) {
+            std::vector<uint16>& list = m_nameTrigramIndex[nameTrigram(name, pos)];
+            if(list.empty() || list.back() != i)
+                list.push_back(i);
+        }
+    }
+}
+
 const ItemTypePtr& ThingTypeManager::findItemTypeByName(std::string name)
 {
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName() == name)
-            return it;
+    updateSearchIndex();
+    auto it = m_nameIndex.find(foldName(name));
+    if(it != m_nameIndex.end()) {
+        for(uint16 i : it->second)
+            if(m_itemTypes[i]->getName() == name)
+                return m_itemTypes[i];
+    }
     return m_nullItemType;
 }
 
 ItemTypeList ThingTypeManager::findItemTypesByName(std::string name)
 {
     ItemTypeList ret;
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName() == name)
-            ret.push_back(it);
+    updateSearchIndex();
+    auto it = m_nameIndex.find(foldName(name));
+    if(it != m_nameIndex.end()) {
+        for(uint16 i : it->second)
+            if(m_itemTypes[i]->getName() == name)
+                ret.push_back(m_itemTypes[i]);
+    }
     return ret;
 }
 
 ItemTypeList ThingTypeManager::findItemTypesByString(std::string name)
 {
     ItemTypeList ret;
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName().find(name) != std::string::npos)
-            ret.push_back(it);
+    std::string folded = foldName(name);
+    if(folded.size() < 3) {
+        for(const ItemTypePtr& it : m_itemTypes)
+            if(it->getName().find(name) != std::string::npos)
+                ret.push_back(it);
+        return ret;
+    }
+
+    // every match contains all trigrams of the query, the rarest one gives the fewest candidates
+    updateSearchIndex();
+    const std::vector<uint16>* candidates = nullptr;
+    for(size_t pos = 0; pos + 3 <= folded.size(); ++pos) {
+        auto it = m_nameTrigramIndex.find(nameTrigram(folded, pos));
+        if(it == m_nameTrigramIndex.end())
+            return ret;
+        if(!candidates || it->second.size() < candidates->size())
+            candidates = &it->second;
+    }
+
+    for(uint16 i : *candidates)
+        if(m_itemTypes[i]->getName().find(name) != std::string::npos)
+            ret.push_back(m_itemTypes[i]);
     return ret;
 }
 
@@ -470,19 +689,35 @@ const ItemTypePtr& ThingTypeManager::getItemType(uint16 id)
 
 ThingTypeList ThingTypeManager::findThingTypeByAttr(ThingAttr attr, ThingCategory category)
 {
-    ThingTypeList ret;
-    for(const ThingTypePtr& type : m_thingTypes[category])
-        if(type->hasAttr(attr))
-            ret.push_back(type);
-    return ret;
+    if(category >= ThingLastCategory)
+        return ThingTypeList();
+
+    updateSearchIndex();
+    auto it = m_attrIndex.find(category << 8 | attr);
+    if(it == m_attrIndex.end()) {
+        ThingTypeList types;
+        for(const ThingTypePtr& type : m_thingTypes[category])
+            if(type->hasAttr(attr))
+                types.push_back(type);
+        it = m_attrIndex.emplace(category << 8 | attr, std::move(types)).first;
+    }
+    return it->second;
 }
 
 ItemTypeList ThingTypeManager::findItemTypeByCategory(ItemCategory category)
 {
     ItemTypeList ret;
-    for(const ItemTypePtr& type : m_itemTypes)
-        if(type->getCategory() == category)
-            ret.push_back(type);
+    if(category >= ItemCategoryLast) {
+        for(const ItemTypePtr& type : m_itemTypes)
+            if(type->getCategory() == category)
+                ret.push_back(type);
+        return ret;
+    }
+
+    updateSearchIndex();
+    ret.reserve(m_itemCategoryIndex[category].size());
+    for(uint16 i : m_itemCategoryIndex[category])
+        ret.push_back(m_itemTypes[i]);
     return ret;
 }
 
@@ -33,10 +33,23 @@
 class ThingTypeManager
 {
 public:
+    enum {
+        RESIDENCY_FRAME_INTERVAL = 16, // ms
+        RESIDENCY_TIME_SLICE = 500 // us
+    };
+
     void init();
     void terminate();
     void check();
 
+    // thing textures are evicted, least recently used first, while their memory is over the budget
+    void setTextureBudget(uint64 bytes) { m_textureBudget = bytes; }
+    uint64 getTextureBudget() { return m_textureBudget; }
+    uint64 getResidentTextureBytes() { return m_residentBytes; }
+    uint32 getResidencyFrame() { return m_residencyFrame; }
+    void addResidentTexture(ThingType* type, size_t bytes);
+    void removeResidentTextures(ThingType* type);
+
     bool loadDat(std::string file);
     bool loadOtml(std::string file);
     void loadOtb(const std::string& file);
@@ -92,7 +105,15 @@ public:
     bool isValidDatId(uint16 id, ThingCategory category) { return id >= 1 && id < m_thingTypes[category].size(); }
     bool isValidOtbId(uint16 id) { return id >= 1 && id < m_itemTypes.size(); }
 
+    // must be called when names, categories or attributes of loaded types change
+    void invalidateSearchIndex() { m_searchIndexDirty = true; }
+
 private:
+    void unserializeDat(const FileStreamPtr& fin);
+    void updateSearchIndex();
+    void linkResident(ThingType* type);
+    void unlinkResident(ThingType* type);
+
     ThingTypeList m_thingTypes[ThingLastCategory];
     ItemTypeList m_reverseItemTypes;
     ItemTypeList m_itemTypes;
@@ -111,7 +132,23 @@ private:
     uint16 m_contentRevision;
 
     ScheduledEventPtr m_checkEvent;
-    size_t m_checkIndex[ThingLastCategory];
+    ThingType* m_residentHead = nullptr;
+    ThingType* m_residentTail = nullptr;
+    uint64 m_residentBytes = 0;
+#ifdef ANDROID
+    uint64 m_textureBudget = 64 * 1024 * 1024;
+#else
+    uint64 m_textureBudget = 256 * 1024 * 1024;
+#endif
+    uint32 m_residencyFrame = 0;
+
+    // item types by case-folded name, name trigram and category, as sorted indexes into m_itemTypes
+    std::unordered_map<std::string, std::vector<uint16>> m_nameIndex;
+    std::unordered_map<uint32, std::vector<uint16>> m_nameTrigramIndex;
+    std::vector<uint16> m_itemCategoryIndex[ItemCategoryLast];
+    // thing types by attribute, filled on first query
+    std::unordered_map<uint32, ThingTypeList> m_attrIndex;
+    bool m_searchIndexDirty = true;
 };
 
 extern ThingTypeManager g_things;
@@ -32,8 +32,11 @@
 #include "spritemanager.h"
 #include <framework/graphics/fontmanager.h>
 #include <framework/util/extras.h>
+#include <framework/util/stats.h>
 #include <framework/core/adaptiverenderer.h>
 
+uint32 Tile::s_drawListEpoch = 1;
+
 Tile::Tile(const Position& position) :
     m_position(position),
     m_drawElevation(0),
@@ -51,6 +54,13 @@ void Tile::drawGround(const Point& dest, LightView* lightView)
         return;
     }
 
+    if (!g_extras.legacyTileDraw) {
+        updateDrawList();
+        for (int i = 0; i < m_groundEnd; ++i)
+            drawEntry(m_drawList[i], dest, lightView);
+        return;
+    }
+
     // ground
     for (const ThingPtr& thing : m_things) {
         if (!thing->isGround() && !thing->isGroundBorder() && (g_game.getFeature(Otc::GameMapDrawGroundFirst) || !thing->isOnBottom()))
@@ -68,6 +78,37 @@ void Tile::drawBottom(const Point& dest, LightView* lightView)
     if (m_fill != Color::alpha)
         return;
 
+    int redrawPreviousTopW = 0, redrawPreviousTopH = 0;
+    if (!g_extras.legacyTileDraw) {
+        updateDrawList();
+        for (int i = m_groundEnd; i < m_commonEnd; ++i)
+            drawEntry(m_drawList[i], dest, lightView);
+        redrawPreviousTopW = m_corpseRedrawW;
+        redrawPreviousTopH = m_corpseRedrawH;
+    } else {
+        drawBottomLegacy(dest, lightView, redrawPreviousTopW, redrawPreviousTopH);
+    }
+
+    if (!g_game.getFeature(Otc::GameMapIgnoreCorpseCorrection)) {
+        for (int x = -redrawPreviousTopW; x <= 0; ++x) {
+            for (int y = -redrawPreviousTopH; y <= 0; ++y) {
+                if (x == 0 && y == 0)
+                    continue;
+                if (const TilePtr& tile = g_map.getTile(m_position.translated(x, y))) {
+                    tile->drawCreatures(dest + Point(x * g_sprites.spriteSize(), y * g_sprites.spriteSize()), lightView);
+                    tile->drawTop(dest + Point(x * g_sprites.spriteSize(), y * g_sprites.spriteSize()), lightView);
+                }
+            }
+        }
+    }
+
+    if (lightView && hasTranslucentLight()) {
+        lightView->addLight(dest + Point(16, 16), 215, 1);
+    }
+}
+
+void Tile::drawBottomLegacy(const Point& dest, LightView* lightView, int& redrawPreviousTopW, int& redrawPreviousTopH)
+{
     // bottom things, only when GameMapDrawGroundFirst is active
     if (g_game.getFeature(Otc::GameMapDrawGroundFirst)) {
         bool afterBottom = false;
@@ -85,7 +126,6 @@ void Tile::drawBottom(const Point& dest, LightView* lightView)
     }
 
     // common items, reverse order
-    int redrawPreviousTopW = 0, redrawPreviousTopH = 0;
     bool stopDrawing = false;
     for (auto it = m_things.rbegin(); it != m_things.rend(); ++it) {
         const ThingPtr& thing = *it;
@@ -104,23 +144,6 @@ void Tile::drawBottom(const Point& dest, LightView* lightView)
         thing->draw(dest - m_drawElevation * g_sprites.getOffsetFactor() , true, lightView);
         m_drawElevation = std::min<uint8_t>(m_drawElevation + thing->getElevation(), Otc::MAX_ELEVATION);
     }
-
-    if (!g_game.getFeature(Otc::GameMapIgnoreCorpseCorrection)) {
-        for (int x = -redrawPreviousTopW; x <= 0; ++x) {
-            for (int y = -redrawPreviousTopH; y <= 0; ++y) {
-                if (x == 0 && y == 0)
-                    continue;
-                if (const TilePtr& tile = g_map.getTile(m_position.translated(x, y))) {
-                    tile->drawCreatures(dest + Point(x * g_sprites.spriteSize(), y * g_sprites.spriteSize()), lightView);
-                    tile->drawTop(dest + Point(x * g_sprites.spriteSize(), y * g_sprites.spriteSize()), lightView);
-                }
-            }
-        }
-    }
-
-    if (lightView && hasTranslucentLight()) {
-        lightView->addLight(dest + Point(16, 16), 215, 1);
-    }
 }
 
 void Tile::drawCreatures(const Point& dest, LightView* lightView)
@@ -193,6 +216,20 @@ void Tile::drawTop(const Point& dest, LightView* lightView)
     }
 
     // top
+    if (!g_extras.legacyTileDraw) {
+        updateDrawList();
+        for (size_t i = m_commonEnd; i < m_drawList.size(); ++i) {
+            const DrawListEntry& entry = m_drawList[i];
+            if (entry.thing->isHidden())
+                continue;
+            if (entry.item)
+                entry.item->drawWithPatterns(dest, entry.xPattern, entry.yPattern, entry.zPattern, true, lightView);
+            else
+                entry.thing->draw(dest, true, lightView);
+        }
+        return;
+    }
+
     for (const ThingPtr& thing : m_things) {
         if (!thing->isOnTop() || thing->isHidden())
             continue;
@@ -200,6 +237,87 @@ void Tile::drawTop(const Point& dest, LightView* lightView)
     }
 }
 
+void Tile::updateDrawList()
+{
+    bool groundFirst = g_game.getFeature(Otc::GameMapDrawGroundFirst);
+    if (m_drawListValid && m_drawListEpoch == s_drawListEpoch && m_drawListGroundFirst == groundFirst)
+        return;
+
+    auto add = [&](const ThingPtr& thing) {
+        DrawListEntry entry = { thing.get(), nullptr, 0, 0, 0, (uint8)std::min<int>(thing->getElevation(), Otc::MAX_ELEVATION) };
+        if (thing->isItem()) {
+            int xPattern = 0, yPattern = 0, zPattern = 0;
+            entry.item = static_cast<Item*>(thing.get());
+            entry.item->calculatePatterns(xPattern, yPattern, zPattern);
+            entry.xPattern = xPattern;
+            entry.yPattern = yPattern;
+            entry.zPattern = zPattern;
+        }
+        m_drawList.push_back(entry);
+    };
+
+    // same walks as the legacy drawGround, drawBottom and drawTop, without the hidden checks
+    m_drawList.clear();
+    for (const ThingPtr& thing : m_things) {
+        if (!thing->isGround() && !thing->isGroundBorder() && (groundFirst || !thing->isOnBottom()))
+            break;
+        add(thing);
+    }
+    m_groundEnd = m_drawList.size();
+
+    if (groundFirst) {
+        bool afterBottom = false;
+        for (const ThingPtr& thing : m_things) {
+            if (thing->isOnBottom())
+                afterBottom = true;
+            if (!thing->isGround() && !thing->isGroundBorder() && !thing->isOnBottom())
+                break;
+            if (afterBottom)
+                add(thing);
+        }
+    }
+    m_bottomEnd = m_drawList.size();
+
+    int redrawPreviousTopW = 0, redrawPreviousTopH = 0;
+    bool stopDrawing = false;
+    for (auto it = m_things.rbegin(); it != m_things.rend(); ++it) {
+        const ThingPtr& thing = *it;
+        if (thing->isLyingCorpse()) {
+            redrawPreviousTopW = std::max<int>(thing->getWidth() - 1, redrawPreviousTopW);
+            redrawPreviousTopH = std::max<int>(thing->getHeight() - 1, redrawPreviousTopH);
+        }
+        if (thing->isOnTop() || thing->isOnBottom() || thing->isGroundBorder() || thing->isGround() || thing->isCreature())
+            stopDrawing = true;
+        if (!stopDrawing)
+            add(thing);
+    }
+    m_commonEnd = m_drawList.size();
+    m_corpseRedrawW = redrawPreviousTopW;
+    m_corpseRedrawH = redrawPreviousTopH;
+
+    for (const ThingPtr& thing : m_things) {
+        if (thing->isOnTop())
+            add(thing);
+    }
+
+    m_drawListValid = true;
+    m_drawListEpoch = s_drawListEpoch;
+    m_drawListGroundFirst = groundFirst;
+    g_stats.addTileDrawListBuild();
+}
+
+void Tile::drawEntry(const DrawListEntry& entry, const Point& dest, LightView* lightView)
+{
+    if (entry.thing->isHidden())
+        return;
+    Point elevatedDest = dest - m_drawElevation * g_sprites.getOffsetFactor();
+    if (entry.item)
+        entry.item->drawWithPatterns(elevatedDest, entry.xPattern, entry.yPattern, entry.zPattern, true, lightView);
+    else
+        entry.thing->draw(elevatedDest, true, lightView);
+    m_drawElevation = std::min<uint8_t>(m_drawElevation + entry.elevation, Otc::MAX_ELEVATION);
+}
+
 
 void Tile::calculateCorpseCorrection() {
     m_topCorrection = 0;
@@ -326,6 +444,7 @@ void Tile::addThing(const ThingPtr& thing, int stackPos)
             stackPos = m_things.size();
 
         m_things.insert(m_things.begin() + stackPos, thing);
+        m_drawListValid = false;
 
         if(!g_game.getFeature(Otc::GameNewCreatureStacking) && m_things.size() > MAX_THINGS)
             removeThing(m_things[MAX_THINGS]);
@@ -370,6 +489,7 @@ bool Tile::removeThing(ThingPtr thing)
         auto it = std::find(m_things.begin(), m_things.end(), thing);
         if(it != m_things.end()) {
             m_things.erase(it);
+            m_drawListValid = false;
             removed = true;
         }
     }
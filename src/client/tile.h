@@ -72,6 +72,10 @@ public:
     void drawTexts(Point dest);
     void drawWidget(Point dest);
 
+    // draw lists are rebuilt on the next draw, for all tiles when thing types are reloaded
+    void invalidateDrawList() { m_drawListValid = false; }
+    static void invalidateDrawLists() { ++s_drawListEpoch; }
+
 public:
     void clean();
 
@@ -168,7 +172,20 @@ public:
     }
 
 private:
+    // an item in draw order, with what doesn't change between frames worked out once
+    struct DrawListEntry {
+        Thing* thing; // owned by m_things
+        Item* item; // nullptr when the thing isn't an item
+        uint8 xPattern, yPattern, zPattern;
+        uint8 elevation;
+    };
+
     void checkTranslucentLight();
+    void drawBottomLegacy(const Point& dest, LightView* lightView, int& redrawPreviousTopW, int& redrawPreviousTopH);
+    void updateDrawList();
+    void drawEntry(const DrawListEntry& entry, const Point& dest, LightView* lightView);
+
+    static uint32 s_drawListEpoch;
 
     std::vector<CreaturePtr> m_walkingCreatures;
     std::vector<EffectPtr> m_effects; // leave this outside m_things because it has no stackpos.
@@ -183,6 +200,14 @@ private:
     uint32_t m_lastCreature = 0;
     int m_topCorrection = 0;
     int m_topDraws = 0;
+
+    // ground, bottom (ground first only), common items in reverse stack order, then top items
+    std::vector<DrawListEntry> m_drawList;
+    uint16 m_groundEnd = 0, m_bottomEnd = 0, m_commonEnd = 0;
+    uint8 m_corpseRedrawW = 0, m_corpseRedrawH = 0;
+    bool m_drawListValid = false;
+    bool m_drawListGroundFirst = false;
+    uint32 m_drawListEpoch = 0;
     
     stdext::boolean<false> m_selected;
 
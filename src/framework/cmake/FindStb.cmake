@@ -0,0 +1,8 @@
+# Try to find the stb single-file headers
+#  STB_FOUND - system has stb
+#  STB_INCLUDE_DIR - the directory with stb_truetype.h
+
+FIND_PATH(STB_INCLUDE_DIR stb_truetype.h PATH_SUFFIXES stb)
+INCLUDE(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(Stb DEFAULT_MSG STB_INCLUDE_DIR)
+MARK_AS_ADVANCED(STB_INCLUDE_DIR)
\ No newline at end of file
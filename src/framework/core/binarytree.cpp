@@ -24,10 +24,17 @@
 #include "filestream.h"
 
 BinaryTree::BinaryTree(const FileStreamPtr& fin)
-    : m_fin(fin), m_pos(0xFFFFFFFF) {
+    : m_fin(fin), m_data(nullptr), m_size(0), m_pos(0xFFFFFFFF) {
   m_startPos = fin->tell();
 }
 
+BinaryTree::BinaryTree(const BinaryTreeIndexPtr& index, uint32 node)
+    : m_index(index), m_buffer(0), m_pos(0), m_startPos(node) {
+  const BinaryTreeIndex::Node& n = index->node(node);
+  m_data = index->data() + n.begin;
+  m_size = n.end - n.begin;
+}
+
 BinaryTree::~BinaryTree() {}
 
 void BinaryTree::skipNodes() {
@@ -62,6 +69,8 @@ void BinaryTree::unserialize() {
         break;
       }
       case BINARYTREE_NODE_END:
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
         return;
       case BINARYTREE_ESCAPE_CHAR:
         m_buffer.add(m_fin->getU8());
@@ -75,6 +84,14 @@ void BinaryTree::unserialize() {
 
 BinaryTreeVec BinaryTree::getChildren() {
   BinaryTreeVec children;
+  if (m_index) {
+    for (uint32 child = m_index->node(m_startPos).firstChild;
+         child != BinaryTreeIndex::INVALID_NODE;
+         child = m_index->node(child).nextSibling)
+      children.emplace_back(m_index->getNode(child));
+    return children;
+  }
+
   m_fin->seek(m_startPos);
   while (true) {
     uint8 byte = m_fin->getU8();
@@ -98,7 +115,7 @@ BinaryTreeVec BinaryTree::getChildren() {
 
 void BinaryTree::seek(uint pos) {
   unserialize();
-  if (pos > m_buffer.size()) stdext::throw_exception("BinaryTree: seek failed");
+  if (pos > m_size) stdext::throw_exception("BinaryTree: seek failed");
   m_pos = pos;
 }
 
@@ -109,36 +126,36 @@ void BinaryTree::skip(uint len) {
 
 uint8 BinaryTree::getU8() {
   unserialize();
-  if (m_pos + 1 > m_buffer.size())
+  if (m_pos + 1 > m_size)
     stdext::throw_exception("BinaryTree: getU8 failed");
-  uint8 v = m_buffer[m_pos];
+  uint8 v = m_data[m_pos];
   m_pos += 1;
   return v;
 }
 
 uint16 BinaryTree::getU16() {
   unserialize();
-  if (m_pos + 2 > m_buffer.size())
+  if (m_pos + 2 > m_size)
     stdext::throw_exception("BinaryTree: getU16 failed");
-  uint16 v = stdext::readULE16(&m_buffer[m_pos]);
+  uint16 v = stdext::readULE16(&m_data[m_pos]);
   m_pos += 2;
   return v;
 }
 
 uint32 BinaryTree::getU32() {
   unserialize();
-  if (m_pos + 4 > m_buffer.size())
+  if (m_pos + 4 > m_size)
     stdext::throw_exception("BinaryTree: getU32 failed");
-  uint32 v = stdext::readULE32(&m_buffer[m_pos]);
+  uint32 v = stdext::readULE32(&m_data[m_pos]);
   m_pos += 4;
   return v;
 }
 
 uint64 BinaryTree::getU64() {
   unserialize();
-  if (m_pos + 8 > m_buffer.size())
+  if (m_pos + 8 > m_size)
     stdext::throw_exception("BinaryTree: getU64 failed");
-  uint64 v = stdext::readULE64(&m_buffer[m_pos]);
+  uint64 v = stdext::readULE64(&m_data[m_pos]);
   m_pos += 8;
   return v;
 }
@@ -147,11 +164,11 @@ std::string BinaryTree::getString(uint16 len) {
   unserialize();
   if (len == 0) len = getU16();
 
-  if (m_pos + len > m_buffer.size())
+  if (m_pos + len > m_size)
     stdext::throw_exception(
         "BinaryTree: getString failed: string length exceeded buffer size.");
 
-  std::string ret((char*)&m_buffer[m_pos], len);
+  std::string ret((char*)&m_data[m_pos], len);
   m_pos += len;
   return ret;
 }
@@ -163,6 +180,67 @@ Point BinaryTree::getPoint() {
   return ret;
 }
 
+BinaryTreeIndex::BinaryTreeIndex(const uint8* data, size_t size) {
+  struct OpenNode {
+    uint32 id;
+    uint32 lastChild;
+  };
+  std::vector<OpenNode> open;
+  // properties of the open nodes, a node's bytes may continue after its children
+  std::vector<std::vector<uint8>> pending;
+
+  if (size == 0 || data[0] != BINARYTREE_NODE_START)
+    stdext::throw_exception("BinaryTreeIndex: failed to read root node start");
+
+  m_data.reserve(size);
+  size_t pos = 0;
+  while (pos < size) {
+    uint8 byte = data[pos++];
+    switch (byte) {
+      case BINARYTREE_NODE_START: {
+        uint32 id = m_nodes.size();
+        m_nodes.push_back({0, 0, INVALID_NODE, INVALID_NODE});
+        if (!open.empty()) {
+          OpenNode& parent = open.back();
+          if (parent.lastChild == INVALID_NODE)
+            m_nodes[parent.id].firstChild = id;
+          else
+            m_nodes[parent.lastChild].nextSibling = id;
+          parent.lastChild = id;
+        }
+        open.push_back({id, INVALID_NODE});
+        if (pending.size() < open.size()) pending.emplace_back();
+        break;
+      }
+      case BINARYTREE_NODE_END: {
+        if (open.empty())
+          stdext::throw_exception("BinaryTreeIndex: unexpected node end");
+        std::vector<uint8>& bytes = pending[open.size() - 1];
+        Node& node = m_nodes[open.back().id];
+        node.begin = m_data.size();
+        m_data.insert(m_data.end(), bytes.begin(), bytes.end());
+        node.end = m_data.size();
+        bytes.clear();
+        open.pop_back();
+        if (open.empty()) {
+          m_data.shrink_to_fit();
+          return;
+        }
+        break;
+      }
+      case BINARYTREE_ESCAPE_CHAR:
+        if (pos >= size)
+          stdext::throw_exception("BinaryTreeIndex: unexpected end of data");
+        pending[open.size() - 1].push_back(data[pos++]);
+        break;
+      default:
+        pending[open.size() - 1].push_back(byte);
+        break;
+    }
+  }
+  stdext::throw_exception("BinaryTreeIndex: unexpected end of data");
+}
+
 OutputBinaryTree::OutputBinaryTree(const FileStreamPtr& fin) : m_fin(fin) {
   startNode(0);
 }
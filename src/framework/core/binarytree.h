@@ -36,12 +36,13 @@ class BinaryTree : public std::enable_shared_from_this<BinaryTree>
 {
 public:
     BinaryTree(const FileStreamPtr& fin);
+    BinaryTree(const BinaryTreeIndexPtr& index, uint32 node);
     ~BinaryTree();
 
     void seek(uint pos);
     void skip(uint len);
     uint tell() { return m_pos; }
-    uint size() { unserialize(); return m_buffer.size(); }
+    uint size() { unserialize(); return m_size; }
 
     uint8 getU8();
     uint16 getU16();
@@ -51,18 +52,51 @@ public:
     Point getPoint();
 
     BinaryTreeVec getChildren();
-    bool canRead() { unserialize(); return m_pos < m_buffer.size(); }
+    bool canRead() { unserialize(); return m_pos < m_size; }
 
 private:
     void unserialize();
     void skipNodes();
 
     FileStreamPtr m_fin;
+    BinaryTreeIndexPtr m_index;
     DataBuffer<uint8> m_buffer;
+    const uint8* m_data;
+    uint m_size;
     uint m_pos;
     uint m_startPos;
 };
 
+// Flat index of every node of a fully buffered tree, built by scanning the escaped stream once.
+// Nodes are numbered in file order and share a single unescaped data buffer, so trees built
+// on it don't touch the file again and can be read from several threads at once.
+class BinaryTreeIndex : public std::enable_shared_from_this<BinaryTreeIndex>
+{
+public:
+    struct Node {
+        uint32 begin;
+        uint32 end;
+        uint32 firstChild;
+        uint32 nextSibling;
+    };
+
+    static const uint32 INVALID_NODE = 0xFFFFFFFF;
+
+    // data must start with the root node start byte
+    BinaryTreeIndex(const uint8* data, size_t size);
+
+    BinaryTreePtr getRoot() { return getNode(0); }
+    BinaryTreePtr getNode(uint32 node) { return std::make_shared<BinaryTree>(shared_from_this(), node); }
+
+    const Node& node(uint32 node) const { return m_nodes[node]; }
+    const uint8* data() const { return m_data.data(); }
+    size_t nodeCount() const { return m_nodes.size(); }
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<uint8> m_data;
+};
+
 class OutputBinaryTree : public std::enable_shared_from_this<OutputBinaryTree>
 {
 public:
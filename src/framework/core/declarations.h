@@ -34,6 +34,7 @@ class Event;
 class ScheduledEvent;
 class FileStream;
 class BinaryTree;
+class BinaryTreeIndex;
 class OutputBinaryTree;
 
 using ModulePtr = std::shared_ptr<Module>;
@@ -42,6 +43,7 @@ using EventPtr = std::shared_ptr<Event>;
 using ScheduledEventPtr = std::shared_ptr<ScheduledEvent>;
 using FileStreamPtr = std::shared_ptr<FileStream>;
 using BinaryTreePtr = std::shared_ptr<BinaryTree>;
+using BinaryTreeIndexPtr = std::shared_ptr<BinaryTreeIndex>;
 using OutputBinaryTreePtr = std::shared_ptr<OutputBinaryTree>;
 
 using BinaryTreeVec = std::vector<BinaryTreePtr>;
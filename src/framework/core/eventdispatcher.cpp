@@ -127,6 +127,12 @@ ScheduledEventPtr EventDispatcher::scheduleEventEx(const std::string& function,
     return scheduledEvent;
 }
 
+size_t EventDispatcher::scheduledEventsCount()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return m_scheduledEventList.size();
+}
+
 ScheduledEventPtr EventDispatcher::cycleEventEx(const std::string& function, const std::function<void()>& callback, int delay)
 {
     if(m_disabled)
@@ -40,6 +40,7 @@ public:
     ScheduledEventPtr cycleEventEx(const std::string& function, const std::function<void()>& callback, int delay);
 
     bool isBotSafe() { return m_botSafe; }
+    size_t scheduledEventsCount();
 
 private:
     std::list<EventPtr> m_eventList;
@@ -35,6 +35,7 @@
 #include <framework/graphics/framebuffermanager.h>
 #include <framework/graphics/fontmanager.h>
 #include <framework/graphics/atlas.h>
+#include <framework/graphics/drawcache.h>
 #include <framework/graphics/image.h>
 #include <framework/graphics/textrender.h>
 #include <framework/graphics/shadermanager.h>
@@ -244,11 +245,13 @@ void GraphicalApplication::run()
         mutex.unlock();
 
         g_adaptiveRenderer.newFrame();
+        g_atlas.newFrame();
         m_graphicsFrames.addFrame();
         m_mustRepaint = false;
         lastRender = stdext::micros() > lastRender + frameDelay * 2 ? stdext::micros() : lastRender + frameDelay;
 
         g_painter->resetDraws();
+        g_drawCache.resetFlushes();
         if (m_scaling > 1.0f) {
             AutoStat s(STATS_RENDER, "SetupScaling");
             g_painter->setResolution(g_graphics.getViewportSize() / m_scaling);
@@ -281,8 +284,8 @@ void GraphicalApplication::run()
             if(isOnline) {
                 AutoStat s(STATS_RENDER, "DrawMapBackground");
                 PainterShaderProgramPtr shader = nullptr;
-                if (!toDrawMapQueue->getShader().empty()) {
-                    shader = g_shaders.getShader(toDrawMapQueue->getShader());
+                if (toDrawMapQueue->getShader()) {
+                    shader = g_shaders.bindShader(toDrawMapQueue->getShader());
                     
                     if(shader) {
                         auto walkOffset = toDrawMapQueue->getWalkOffset();
@@ -290,8 +293,6 @@ void GraphicalApplication::run()
                     }
                 }
                 if (shader) {
-                    g_painter->setShaderProgram(shader);
-                    shader->bindMultiTextures();
                     shader->setCenter(toDrawMapQueue->getFrameBufferDest().center());
                     shader->setOffset(toDrawMapQueue->getFrameBufferSrc().topLeft());
                 }
@@ -335,6 +336,7 @@ void GraphicalApplication::run()
 
         g_graphs[GRAPH_GPU_CALLS].addValue(g_painter->calls());
         g_graphs[GRAPH_GPU_DRAWS].addValue(g_painter->draws());
+        g_graphs[GRAPH_DRAW_CACHE_FLUSHES].addValue(g_drawCache.flushes());
 
         AutoStat s(STATS_RENDER, "SwapBuffers");
         g_window.swapBuffers();
@@ -393,11 +395,97 @@ void GraphicalApplication::resize(const Size& size)
 void GraphicalApplication::inputEvent(InputEvent event)
 {
     VALIDATE(std::this_thread::get_id() == g_dispatcherThreadId);
+    g_stats.addInputEvent();
+
+    if(event.type == Fw::MouseMoveInputEvent) {
+        // a move after wheel steps must not be delivered before them, touch pointers aren't merged
+        bool otherPointer = m_mouseMovePending && m_pendingMouseMove.mouseButton != event.mouseButton;
+        if(m_pendingWheelSteps != 0 || otherPointer) {
+            m_onInputEvent = true;
+            flushInputEvents();
+            m_onInputEvent = false;
+        }
+        if(m_mouseMovePending) {
+            m_pendingMouseMove.mouseMoved += event.mouseMoved;
+            m_pendingMouseMove.mousePos = event.mousePos;
+            m_pendingMouseMove.keyboardModifiers = event.keyboardModifiers;
+        } else {
+            m_pendingMouseMove = event;
+            m_mouseMovePending = true;
+        }
+        scheduleInputFlush();
+        return;
+    }
+
+    if(event.type == Fw::MouseWheelInputEvent && event.wheelDirection != Fw::MouseNoWheel) {
+        m_pendingWheelSteps += event.wheelDirection == Fw::MouseWheelUp ? 1 : -1;
+        m_pendingMouseWheel = event;
+        scheduleInputFlush();
+        return;
+    }
+
     m_onInputEvent = true;
-    g_ui.inputEvent(event);
+    flushInputEvents();
+    dispatchInputEvent(event);
     m_onInputEvent = false;
 }
 
+void GraphicalApplication::scheduleInputFlush()
+{
+    if(m_inputFlushScheduled)
+        return;
+    m_inputFlushScheduled = true;
+    g_dispatcher.addEvent([&] {
+        m_inputFlushScheduled = false;
+        m_onInputEvent = true;
+        flushInputEvents();
+        m_onInputEvent = false;
+    });
+}
+
+void GraphicalApplication::flushInputEvents()
+{
+    if(m_mouseMovePending) {
+        m_mouseMovePending = false;
+        dispatchInputEvent(m_pendingMouseMove);
+    }
+
+    if(m_pendingWheelSteps != 0) {
+        InputEvent event = m_pendingMouseWheel;
+        event.wheelDirection = m_pendingWheelSteps > 0 ? Fw::MouseWheelUp : Fw::MouseWheelDown;
+        int steps = std::abs(m_pendingWheelSteps);
+        m_pendingWheelSteps = 0;
+        for(int i = 0; i < steps; ++i)
+            dispatchInputEvent(event);
+    }
+}
+
+void GraphicalApplication::dispatchInputEvent(const InputEvent& event)
+{
+    ticks_t start = stdext::micros();
+    g_ui.inputEvent(event);
+    g_stats.addInputDispatch(stdext::micros() - start);
+}
+
+void GraphicalApplication::injectMouseMove(const Point& mousePos)
+{
+    InputEvent event;
+    event.reset(Fw::MouseMoveInputEvent);
+    event.mousePos = mousePos;
+    event.mouseMoved = mousePos - (m_mouseMovePending ? m_pendingMouseMove.mousePos : g_window.getMousePosition());
+    inputEvent(event);
+}
+
+void GraphicalApplication::injectMouseWheel(const Point& mousePos, Fw::MouseWheelDirection direction)
+{
+    InputEvent event;
+    event.reset(Fw::MouseWheelInputEvent);
+    event.mouseButton = Fw::MouseMidButton;
+    event.mousePos = mousePos;
+    event.wheelDirection = direction;
+    inputEvent(event);
+}
+
 void GraphicalApplication::doScreenshot(std::string file)
 {
     if (g_mainThreadId != std::this_thread::get_id()) {
@@ -65,9 +65,16 @@ public:
 
     void doMapScreenshot(std::string fileName);
 
+    // synthetic input, goes through the same coalescing as the platform window events
+    void injectMouseMove(const Point& mousePos);
+    void injectMouseWheel(const Point& mousePos, Fw::MouseWheelDirection direction);
+
 protected:
     void resize(const Size& size);
     void inputEvent(InputEvent event);
+    void scheduleInputFlush();
+    void flushInputEvents();
+    void dispatchInputEvent(const InputEvent& event);
 
 private:
     int m_iteration = 0;
@@ -75,6 +82,12 @@ private:
     std::atomic<float> m_lastScaling = 1.0;
     std::atomic_int m_maxFps = 100;
     stdext::boolean<false> m_onInputEvent;
+    // mouse moves and wheel steps are coalesced until the next dispatcher event
+    InputEvent m_pendingMouseMove;
+    InputEvent m_pendingMouseWheel;
+    int m_pendingWheelSteps = 0;
+    stdext::boolean<false> m_mouseMovePending;
+    stdext::boolean<false> m_inputFlushScheduled;
     stdext::boolean<false> m_mustRepaint;
     FrameBufferPtr m_framebuffer, m_mapFramebuffer;
     FrameCounter m_graphicsFrames;
@@ -29,6 +29,7 @@
 #include <framework/platform/platform.h>
 #include <framework/util/crypt.h>
 #include <framework/http/http.h>
+#include <framework/util/stats.h>
 #include <queue>
 #include <regex>
 
@@ -48,6 +49,12 @@
 ResourceManager g_resources;
 static const std::string INIT_FILENAME = "init.lua";
 
+// mounts change what paths resolve to
+struct PathCacheInvalidator {
+    PathCacheInvalidator() { g_resources.invalidatePathCache(); }
+    ~PathCacheInvalidator() { g_resources.invalidatePathCache(); }
+};
+
 void ResourceManager::init(const char *argv0)
 {
 #if defined(WIN32)
@@ -142,6 +149,7 @@ bool ResourceManager::launchCorrect(const std::string& product, const std::strin
 }
 
 bool ResourceManager::setupWriteDir(const std::string& product, const std::string& app) {
+    PathCacheInvalidator invalidator;
 #ifdef ANDROID
     const char* localDir = g_androidState->activity->internalDataPath;
 #else
@@ -171,6 +179,7 @@ bool ResourceManager::setupWriteDir(const std::string& product, const std::strin
 
 bool ResourceManager::setup()
 {
+    PathCacheInvalidator invalidator;
 #ifdef ANDROID
     PHYSFS_File* file = PHYSFS_openRead("data.zip");
     if (file) {
@@ -300,6 +309,7 @@ std::string ResourceManager::getCompactName() {
 }
 
 bool ResourceManager::loadDataFromSelf(bool unmountIfMounted) {
+    PathCacheInvalidator invalidator;
     std::shared_ptr<std::vector<uint8_t>> data = nullptr;
 #ifdef ANDROID
     AAsset* file = AAssetManager_open(g_androidState->activity->assetManager, "data.zip", AASSET_MODE_BUFFER);
@@ -352,14 +362,16 @@ bool ResourceManager::fileExists(const std::string& fileName)
 {
     if (fileName.find("/downloads") != std::string::npos)
         return g_http.getFile(fileName.substr(10)) != nullptr;
-    return (PHYSFS_exists(resolvePath(fileName).c_str()) && !PHYSFS_isDirectory(resolvePath(fileName).c_str()));
+    ResolvedPath resolved = resolveCachedPath(absolutePath(fileName), true);
+    return resolved.exists && resolved.directory == 0;
 }
 
 bool ResourceManager::directoryExists(const std::string& directoryName)
 {
     if (directoryName == "/downloads")
         return true;
-    return (PHYSFS_isDirectory(resolvePath(directoryName).c_str()));
+    ResolvedPath resolved = resolveCachedPath(absolutePath(directoryName), true);
+    return resolved.exists && resolved.directory == 1;
 }
 
 void ResourceManager::readFileStream(const std::string& fileName, std::iostream& out)
@@ -463,6 +475,7 @@ bool ResourceManager::writeFileBuffer(const std::string& fileName, const uchar*
         g_logger.error(stdext::format("unable to open file for writing '%s': %s", fileName, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
         return false;
     }
+    invalidatePathCache();
 
     PHYSFS_writeBytes(file, (void*)data, size);
     PHYSFS_close(file);
@@ -504,6 +517,7 @@ FileStreamPtr ResourceManager::appendFile(const std::string& fileName)
     PHYSFS_File* file = PHYSFS_openAppend(fileName.c_str());
     if(!file)
         stdext::throw_exception(stdext::format("failed to append file '%s': %s", fileName, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
+    invalidatePathCache();
     return std::make_shared<FileStream>(fileName, file, true);
 }
 
@@ -512,17 +526,22 @@ FileStreamPtr ResourceManager::createFile(const std::string& fileName)
     PHYSFS_File* file = PHYSFS_openWrite(fileName.c_str());
     if(!file)
         stdext::throw_exception(stdext::format("failed to create file '%s': %s", fileName, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
+    invalidatePathCache();
     return std::make_shared<FileStream>(fileName, file, true);
 }
 
 bool ResourceManager::deleteFile(const std::string& fileName)
 {
-    return PHYSFS_delete(resolvePath(fileName).c_str()) != 0;
+    bool ret = PHYSFS_delete(resolvePath(fileName).c_str()) != 0;
+    invalidatePathCache();
+    return ret;
 }
 
 bool ResourceManager::makeDir(const std::string directory)
 {
-    return PHYSFS_mkdir(directory.c_str());
+    bool ret = PHYSFS_mkdir(directory.c_str());
+    invalidatePathCache();
+    return ret;
 }
 
 std::list<std::string> ResourceManager::listDirectoryFiles(const std::string& directoryPath, bool fullPath /* = false */, bool raw /*= false*/)
@@ -547,6 +566,11 @@ std::list<std::string> ResourceManager::listDirectoryFiles(const std::string& di
 }
 
 std::string ResourceManager::resolvePath(std::string path)
+{
+    return resolveCachedPath(absolutePath(path)).path;
+}
+
+std::string ResourceManager::absolutePath(std::string path)
 {
     if(!stdext::starts_with(path, "/")) {
         std::string scriptPath = "/" + g_lua.getCurrentSourcePath();
@@ -556,21 +580,64 @@ std::string ResourceManager::resolvePath(std::string path)
             g_logger.traceWarning(stdext::format("the following file path is not fully resolved: %s", path));
     }
     stdext::replace_all(path, "//", "/");
-    if(!PHYSFS_exists(path.c_str())) {
-        static const std::string layouts_prefix = "/layouts/";
-        if (!m_layout.empty()) {
-            if (PHYSFS_exists((layouts_prefix + m_layout + path).c_str())) {
-                return layouts_prefix + m_layout + path;
-            }
+    return path;
+}
+
+ResourceManager::ResolvedPath ResourceManager::resolveCachedPath(const std::string& path, bool needsDirectory)
+{
+    uint32 generation;
+    {
+        std::lock_guard<std::mutex> lock(m_resolvedPathsMutex);
+        generation = m_resolvedPathsGeneration;
+        auto it = m_resolvedPaths.find(path);
+        if(it != m_resolvedPaths.end() && (!needsDirectory || !it->second.exists || it->second.directory >= 0)) {
+            g_stats.addPathResolve(0, it->second.probes + (needsDirectory ? 1 : 0));
+            return it->second;
         }
+    }
+
+    ResolvedPath resolved;
+    resolved.path = path;
+    resolved.probes = 1;
+    resolved.exists = PHYSFS_exists(path.c_str());
+    if(!resolved.exists) {
+        static const std::string layouts_prefix = "/layouts/";
+        std::vector<std::string> candidates;
+        if (!m_layout.empty())
+            candidates.push_back(layouts_prefix + m_layout + path);
         static const std::string extra_check[] = { "/mods", "/data", "/modules" };
-        for (auto extra : extra_check) {
-            if (PHYSFS_exists((extra + path).c_str())) {
-                return extra + path;
+        for (auto& extra : extra_check)
+            candidates.push_back(extra + path);
+
+        for (const std::string& candidate : candidates) {
+            resolved.probes += 1;
+            if (PHYSFS_exists(candidate.c_str())) {
+                resolved.path = candidate;
+                resolved.exists = true;
+                break;
             }
         }
     }
-    return path;
+
+    int probes = resolved.probes;
+    if(needsDirectory && resolved.exists) {
+        resolved.directory = PHYSFS_isDirectory(resolved.path.c_str()) ? 1 : 0;
+        probes += 1;
+    }
+    g_stats.addPathResolve(probes, 0);
+
+    // the cache may have been invalidated while resolving, by another thread, then the answer may be stale
+    std::lock_guard<std::mutex> lock(m_resolvedPathsMutex);
+    if(generation == m_resolvedPathsGeneration)
+        m_resolvedPaths[path] = resolved;
+    return resolved;
+}
+
+void ResourceManager::invalidatePathCache()
+{
+    std::lock_guard<std::mutex> lock(m_resolvedPathsMutex);
+    m_resolvedPaths.clear();
+    m_resolvedPathsGeneration += 1;
 }
 
 std::string ResourceManager::guessFilePath(const std::string& filename, const std::string& type)
@@ -678,6 +745,7 @@ std::string ResourceManager::selfChecksum() {
 }
 
 void ResourceManager::updateData(const std::set<std::string>& files, bool reMount) {
+    PathCacheInvalidator invalidator;
 #if !defined(__EMSCRIPTEN__)
     if (!m_loadedFromArchive)
         g_logger.fatal("Client can be updated only when running from zip archive");
@@ -1109,6 +1177,8 @@ void ResourceManager::setLayout(std::string layout)
         g_logger.error(stdext::format("Layour %s doesn't exist, using default", layout));
         return;
     }
+    if (m_layout != layout)
+        invalidatePathCache();
     m_layout = layout;
 }
 
@@ -1117,6 +1187,8 @@ bool ResourceManager::mountMemoryData(const std::shared_ptr<std::vector<uint8_t>
     if (!data || data->size() < 1024)
         return false;
 
+    PathCacheInvalidator invalidator;
+
     if (PHYSFS_mountMemory(data->data(), data->size(), nullptr,
                            "memory_data.zip", "/", 0)) {
         if (PHYSFS_exists(INIT_FILENAME.c_str())) {
@@ -1134,6 +1206,8 @@ void ResourceManager::unmountMemoryData()
     if (!m_memoryData)
         return;
 
+    PathCacheInvalidator invalidator;
+
     if (!PHYSFS_unmount("memory_data.zip")) {
         g_logger.fatal(stdext::format("Unable to unmount memory data", PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode())));
     }
@@ -57,6 +57,7 @@ public:
 
     FileStreamPtr openFile(const std::string& fileName, bool dontCache = false);
     FileStreamPtr appendFile(const std::string& fileName);
+    // thread safe, it only uses PhysFS and the locked path cache, the minimap is saved from a worker thread
     FileStreamPtr createFile(const std::string& fileName);
     bool deleteFile(const std::string& fileName);
 
@@ -64,6 +65,8 @@ public:
     std::list<std::string> listDirectoryFiles(const std::string & directoryPath = "", bool fullPath = false, bool raw = false);
 
     std::string resolvePath(std::string path);
+    // @dontbind
+    void invalidatePathCache();
     std::string getWorkDir() { return "/"; }
 #ifdef ANDROID
     std::string getWriteDir() { return "/"; }
@@ -109,8 +112,17 @@ public:
     }
 
 private:
+    struct ResolvedPath {
+        std::string path;
+        int probes = 0; // PHYSFS_exists calls needed to resolve it
+        bool exists = false;
+        int8 directory = -1; // unknown until asked
+    };
+
     bool mountMemoryData(const std::shared_ptr<std::vector<uint8_t>>& data);
     void unmountMemoryData();
+    std::string absolutePath(std::string path);
+    ResolvedPath resolveCachedPath(const std::string& path, bool needsDirectory = false);
 
 #ifndef ANDROID
     std::filesystem::path m_binaryPath, m_writeDir;
@@ -120,6 +132,10 @@ private:
     std::shared_ptr<std::vector<uint8_t>> m_memoryData;
     uint32_t m_customEncryption = 0;
     std::string m_layout;
+    // absolute path -> resolved path, negative lookups included, cleared on mounts, writes and layout changes
+    std::unordered_map<std::string, ResolvedPath> m_resolvedPaths;
+    uint32 m_resolvedPathsGeneration = 0; // bumped by every invalidation
+    std::mutex m_resolvedPathsMutex;
 };
 
 extern ResourceManager g_resources;
@@ -39,6 +39,8 @@ void Atlas::reset()
     m_doReset = false;
     resetAtlas(0);
     m_cache.clear();
+    for (auto& lru : m_lru)
+        lru.clear();
 }
 
 void Atlas::reload()
@@ -73,14 +75,26 @@ void Atlas::terminate() {
         it = nullptr;
 }
 
-Point Atlas::cache(uint64_t hash, const Size& size, bool& draw)
+void Atlas::newFrame()
 {
+    // the atlas is only reset between frames, so nothing queued in the draw cache points to a cleared region
     if (m_doReset) {
+        m_resets += 1;
         reset();
     }
+    m_frame += 1;
+}
+
+Point Atlas::cache(uint64_t hash, const Size& size, bool& draw)
+{
     auto it = m_cache.find(hash);
     if (it != m_cache.end()) {
-        return it->second;
+        CacheEntry& entry = it->second;
+        if (entry.lastUse != m_frame) {
+            entry.lastUse = m_frame;
+            m_lru[entry.index].splice(m_lru[entry.index].end(), m_lru[entry.index], entry.lru);
+        }
+        return entry.location;
     }
 
     int index = calculateIndex(size);
@@ -89,19 +103,45 @@ Point Atlas::cache(uint64_t hash, const Size& size, bool& draw)
         return Point(-1, -1);
     }
 
-    if (m_locations[0][index].empty() && !findSpace(0, index)) {
+    if (m_locations[0][index].empty() && !findSpace(0, index) && !evict(index)) {
         draw = false;
-        m_doReset = true;
         return Point(-1, -1);
     }
 
     Point location = m_locations[0][index].front();
     m_locations[0][index].pop_front();
-    m_cache.emplace(hash, location);
+    m_lru[index].push_back(hash);
+    m_cache.emplace(hash, CacheEntry{ location, index, m_frame, std::prev(m_lru[index].end()) });
     draw = true;
     return location;
 }
 
+bool Atlas::evict(int index)
+{
+    // reclaim the least recently used region of the same size, or split a bigger one
+    bool hasEntries = false;
+    for (int i = index; i <= 4; ++i) {
+        if (m_lru[i].empty())
+            continue;
+        hasEntries = true;
+
+        auto it = m_cache.find(m_lru[i].front());
+        if (it->second.lastUse == m_frame) // still used in this frame, everything after it too
+            continue;
+
+        m_locations[0][i].push_back(it->second.location);
+        m_lru[i].pop_front();
+        m_cache.erase(it);
+        m_evictions += 1;
+        return m_locations[0][index].size() > 0 || findSpace(0, index);
+    }
+
+    // the whole atlas is taken by smaller regions, they can't be merged so it must be cleared
+    if (!hasEntries)
+        m_doReset = true;
+    return false;
+}
+
 void Atlas::bind()
 {
     m_atlas[0]->bind();
@@ -169,6 +209,12 @@ std::string Atlas::getStats() {
         }
         ss << "| ";
     }
-    ss << "(" << m_size << "|" << g_graphics.getMaxTextureSize() << ")";
+    ss << "(" << m_size << "|" << g_graphics.getMaxTextureSize() << ") ";
+
+    static const uint64_t sizes[5] = { 32, 64, 128, 256, 512 };
+    uint64_t used = 0;
+    for (int i = 0; i < 5; ++i)
+        used += m_lru[i].size() * sizes[i] * sizes[i];
+    ss << "evictions: " << m_evictions << " fill: " << (used * 100 / ((uint64_t)m_size * m_size)) << "% resets: " << m_resets;
     return ss.str();
 }
@@ -12,6 +12,7 @@ public:
     void terminate();
     void reload();
 
+    void newFrame();
     Point cache(uint64_t hash, const Size& size, bool& draw);
     Point cacheFont(const TexturePtr& fontTexture);
 
@@ -22,16 +23,28 @@ public:
     std::string getStats(); // not thread safe!
 
 private:
+    struct CacheEntry {
+        Point location;
+        int index;
+        uint32_t lastUse;
+        std::list<uint64_t>::iterator lru;
+    };
+
     void reset();
     void resetAtlas(int location);
     bool findSpace(int location, int index);
+    bool evict(int index);
     inline int calculateIndex(const Size& size);
 
     FrameBufferPtr m_atlas[2];
-    std::map<uint64_t, Point> m_cache;
+    std::map<uint64_t, CacheEntry> m_cache;
     std::list<Point> m_locations[2][7];
+    std::list<uint64_t> m_lru[7]; // cached hashes of each size, least recently used first
     size_t m_size;
     bool m_doReset = false;
+    uint32_t m_frame = 1;
+    uint32_t m_evictions = 0;
+    uint32_t m_resets = 0;
 };
 
 extern Atlas g_atlas;
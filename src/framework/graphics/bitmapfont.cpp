@@ -40,6 +40,7 @@ void BitmapFont::load(const OTMLNodePtr& fontNode)
     m_firstGlyph = fontNode->valueAt("first-glyph", 32);
     m_glyphSpacing = fontNode->valueAt("spacing", Size(0,0));
     m_underlineOffset = fontNode->valueAt("underline-offset", 0);
+    m_sdf = fontNode->valueAt("sdf", false);
     int spaceWidth = fontNode->valueAt("space-width", glyphSize.width());
 
     if(OTMLNodePtr node = fontNode->get("fixed-glyph-width")) {
@@ -76,9 +77,15 @@ void BitmapFont::load(const OTMLNodePtr& fontNode)
 #ifdef DONT_CACHE_FONTS
     Point offset(0, 0);
 #else
-    Point offset = g_atlas.cacheFont(m_texture);
-    m_texture = g_atlas.get(1);
+    Point offset(0, 0);
+    if (!m_sdf) {
+        offset = g_atlas.cacheFont(m_texture);
+        m_texture = g_atlas.get(1);
+    }
 #endif
+    // distance fields are interpolated, one texture then stays sharp at every scale
+    if (m_sdf)
+        m_texture->setSmooth(true);
     for (int glyph = m_firstGlyph; glyph < 256; ++glyph) {
         m_glyphsTextureCoords[glyph].setRect(((glyph - m_firstGlyph) % numHorizontalGlyphs) * glyphSize.width() + offset.x,
                                                 ((glyph - m_firstGlyph) / numHorizontalGlyphs) * glyphSize.height() + offset.y,
@@ -361,6 +368,8 @@ void BitmapFont::calculateGlyphsWidthsAutomatically(const ImagePtr& image, const
 
     int numHorizontalGlyphs = image->getSize().width() / glyphSize.width();
     auto texturePixels = image->getPixels();
+    // distance fields fade out around the glyph, only pixels inside its edge count
+    int minAlpha = m_sdf ? 128 : 1;
 
     // small AI to auto calculate pixels widths
     for (int glyph = m_firstGlyph; glyph < 256; ++glyph) {
@@ -373,7 +382,7 @@ void BitmapFont::calculateGlyphsWidthsAutomatically(const ImagePtr& image, const
             int filledPixels = 0;
             // check if all vertical pixels are alpha
             for (int y = glyphCoords.top(); y <= glyphCoords.bottom(); ++y) {
-                if (texturePixels[(y * image->getSize().width() * 4) + (x * 4) + 3] != 0)
+                if (texturePixels[(y * image->getSize().width() * 4) + (x * 4) + 3] >= minAlpha)
                     filledPixels++;
             }
             if (filledPixels > 0)
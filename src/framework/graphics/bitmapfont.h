@@ -68,6 +68,7 @@ public:
     int getYOffset() { return m_yOffset; }
     Size getGlyphSpacing() { return m_glyphSpacing; }
     int getUnderlineOffset() { return m_underlineOffset; }
+    bool isSdf() { return m_sdf; }
 
 private:
     /// Calculates each font character by inspecting font bitmap
@@ -80,6 +81,7 @@ private:
     int m_yOffset;
     int m_id;
     int m_underlineOffset;
+    bool m_sdf = false;
     Size m_glyphSpacing;
     TexturePtr m_texture;
     Rect m_glyphsTextureCoords[256];
@@ -82,6 +82,21 @@ void CoordsBuffer::addRepeatedRects(const Rect& dest, const Rect& src)
     }
 }
 
+void CoordsBuffer::translate(const Point& offset)
+{
+    if (offset.isNull())
+        return;
+    if (m_locked)
+        unlock();
+
+    float* vertices = m_vertexArray->vertices();
+    int size = m_vertexArray->size();
+    for (int i = 0; i < size; i += 2) {
+        vertices[i] += offset.x;
+        vertices[i + 1] += offset.y;
+    }
+}
+
 void CoordsBuffer::unlock(bool clear)
 {
     m_locked = false;
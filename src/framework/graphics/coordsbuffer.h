@@ -83,6 +83,7 @@ public:
 
     void addBoudingRect(const Rect& dest, int innerLineWidth);
     void addRepeatedRects(const Rect& dest, const Rect& src);
+    void translate(const Point& offset);
 
     float *getVertexArray() { return m_vertexArray->vertices(); }
     float *getTextureCoordArray() { return m_textureCoordArray->vertices(); }
@@ -1,13 +1,20 @@
 #include "drawcache.h"
+#include <framework/util/extras.h>
 
 DrawCache g_drawCache;
 
 void DrawCache::draw()
 {
     release();
-    if (m_size == 0) return;
-    g_painter->drawCache(m_destCoord, m_srcCoord, m_color, m_size);
-    m_size = 0;
+    if (m_size != 0) {
+        m_flushes += 1;
+        if (m_compact)
+            g_painter->drawCache(m_vertices.data(), m_size);
+        else
+            g_painter->drawCache(m_destCoord, m_srcCoord, m_color, m_size);
+        m_size = 0;
+    }
+    m_compact = !g_extras.legacyDrawCache;
 }
 
 void DrawCache::bind()
@@ -27,6 +34,11 @@ void DrawCache::release()
 void DrawCache::addRect(const Rect& dest, const Color& color)
 {
     static Rect emptyRect(Point(-10, -10), Point(-10, -10));
+    if (m_compact) {
+        addRectVertices(dest, emptyRect, color);
+        m_size += 6;
+        return;
+    }
     addRectRaw(m_destCoord.data() + (m_size * 2), dest);
     addRectRaw(m_srcCoord.data() + (m_size * 2), emptyRect);
     addColorRaw(color, 6);
@@ -35,6 +47,11 @@ void DrawCache::addRect(const Rect& dest, const Color& color)
 
 void DrawCache::addTexturedRect(const Rect& dest, const Rect& src, const Color& color)
 {
+    if (m_compact) {
+        addRectVertices(dest, src, color);
+        m_size += 6;
+        return;
+    }
     addRectRaw(m_destCoord.data() + (m_size * 2), dest);
     addRectRaw(m_srcCoord.data() + (m_size * 2), src);
     addColorRaw(color, 6);
@@ -44,6 +61,15 @@ void DrawCache::addTexturedRect(const Rect& dest, const Rect& src, const Color&
 void DrawCache::addCoords(CoordsBuffer& coords, const Color& color)
 {
     int size = coords.getVertexCount();
+    if (m_compact) {
+        float* dest = coords.getVertexArray();
+        uint8_t r = color.r(), g = color.g(), b = color.b(), a = color.a();
+        DrawCacheVertex* v = m_vertices.data() + m_size;
+        for (int i = 0; i < size; ++i)
+            v[i] = { toShort(dest[i * 2]), toShort(dest[i * 2 + 1]), -10, -10, r, g, b, a };
+        m_size += size;
+        return;
+    }
     memcpy(m_destCoord.data() + m_size * 2, coords.getVertexArray(), size * 2 * sizeof(float));
     for (int start = m_size * 2, end = (m_size + size) * 2; start < end; ++start)
         m_srcCoord[start] = -10;
@@ -55,6 +81,15 @@ void DrawCache::addTexturedCoords(CoordsBuffer& coords, const Point& offset, con
 {
     int size = coords.getVertexCount();
     float* src = coords.getTextureCoordArray();
+    if (m_compact) {
+        float* dest = coords.getVertexArray();
+        uint8_t r = color.r(), g = color.g(), b = color.b(), a = color.a();
+        DrawCacheVertex* v = m_vertices.data() + m_size;
+        for (int i = 0; i < size; ++i)
+            v[i] = { toShort(dest[i * 2]), toShort(dest[i * 2 + 1]), toShort(src[i * 2] + offset.x), toShort(src[i * 2 + 1] + offset.y), r, g, b, a };
+        m_size += size;
+        return;
+    }
     memcpy(m_destCoord.data() + m_size * 2, coords.getVertexArray(), size * 2 * sizeof(float));
     for (int i = m_size * 2, j = 0, end = (m_size + size) * 2; i < end; ) {
         m_srcCoord[i++] = src[j++] + offset.x;
@@ -6,6 +6,13 @@
 #include "graphics.h"
 #include "painter.h"
 
+// compact interleaved vertex streamed to a vertex buffer, 12 bytes instead of 32
+struct DrawCacheVertex {
+    int16_t x, y;
+    int16_t u, v; // negative for untextured vertices
+    uint8_t r, g, b, a;
+};
+
 class DrawCache {
 public:
     static const int MAX_SIZE = 65536;
@@ -18,12 +25,28 @@ public:
         return size + m_size < MAX_SIZE;
     }
     inline int getSize() { return m_size; }
+    int flushes() { return m_flushes; }
+    void resetFlushes() { m_flushes = 0; }
     void addRect(const Rect& dest, const Color& color);
     void addTexturedRect(const Rect& dest, const Rect& src, const Color& color);
     void addCoords(CoordsBuffer& coords, const Color& color);
     void addTexturedCoords(CoordsBuffer& coords, const Point& offset, const Color& color);
 
 private:
+    static inline int16_t toShort(int value) { return std::min(std::max(value, -32768), 32767); }
+    inline void addRectVertices(const Rect& dest, const Rect& src, const Color& color)
+    {
+        DrawCacheVertex* v = m_vertices.data() + m_size;
+        int16_t left = toShort(dest.left()), top = toShort(dest.top()), right = toShort(dest.right() + 1), bottom = toShort(dest.bottom() + 1);
+        int16_t srcLeft = toShort(src.left()), srcTop = toShort(src.top()), srcRight = toShort(src.right() + 1), srcBottom = toShort(src.bottom() + 1);
+        uint8_t r = color.r(), g = color.g(), b = color.b(), a = color.a();
+        v[0] = { left, top, srcLeft, srcTop, r, g, b, a };
+        v[1] = { right, top, srcRight, srcTop, r, g, b, a };
+        v[2] = { left, bottom, srcLeft, srcBottom, r, g, b, a };
+        v[3] = v[2];
+        v[4] = v[1];
+        v[5] = { right, bottom, srcRight, srcBottom, r, g, b, a };
+    }
     inline void addRectRaw(float* dest, const Rect& rect)
     {
         dest[0] = dest[4] = dest[6] = rect.left();
@@ -43,11 +66,16 @@ private:
         }
     }
 
+    std::vector<DrawCacheVertex> m_vertices = std::vector<DrawCacheVertex>(MAX_SIZE);
+    bool m_compact = true;
+
+    // legacy client-side float arrays, used when g_extras.legacyDrawCache is set
     std::vector<float> m_destCoord = std::vector<float>(MAX_SIZE * 2);
     std::vector<float> m_srcCoord = std::vector<float>(MAX_SIZE * 2);
     std::vector<float> m_color = std::vector<float>(MAX_SIZE * 4);
     bool m_bound = false;
     int m_size = 0;
+    int m_flushes = 0;
 };
 
 extern DrawCache g_drawCache;
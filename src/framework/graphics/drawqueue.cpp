@@ -8,6 +8,7 @@
 #include <framework/graphics/textrender.h>
 #include <framework/graphics/drawcache.h>
 #include <framework/graphics/image.h>
+#include <framework/util/extras.h>
 #include <client/spritemanager.h>
 #include <client/outfit.h>
 
@@ -39,6 +40,14 @@ bool DrawQueueItemTextureCoords::cache()
     return true;
 }
 
+DrawQueueItem* DrawQueueItemTextureCoords::clone(const Point& offset)
+{
+    // shares the vertices until they have to be moved
+    CoordsBuffer coords(std::move(m_coordsBuffer));
+    coords.translate(offset);
+    return new DrawQueueItemTextureCoords(coords, m_texture, m_color);
+}
+
 void DrawQueueItemTextureCoords::draw(const Point& pos)
 {
     g_painter->resetColor();
@@ -50,14 +59,31 @@ void DrawQueueItemColoredTextureCoords::draw()
     g_painter->drawTextureCoords(m_coordsBuffer, m_texture, &m_colors);
 }
 
+DrawQueueItem* DrawQueueItemColoredTextureCoords::clone(const Point& offset)
+{
+    CoordsBuffer coords(std::move(m_coordsBuffer));
+    coords.translate(offset);
+    return new DrawQueueItemColoredTextureCoords(coords, m_texture, m_colors);
+}
+
+void DrawQueueItemSdfTextureCoords::draw()
+{
+    g_painter->drawText(Point(0, 0), m_coordsBuffer, m_colors, m_texture, true);
+}
+
+DrawQueueItem* DrawQueueItemSdfTextureCoords::clone(const Point& offset)
+{
+    CoordsBuffer coords(std::move(m_coordsBuffer));
+    coords.translate(offset);
+    return new DrawQueueItemSdfTextureCoords(coords, m_texture, m_colors);
+}
+
 void DrawQueueItemImageWithShader::draw()
 {
     if (!m_texture) return;
-    PainterShaderProgramPtr shader = g_shaders.getShader(m_shader);
+    PainterShaderProgramPtr shader = g_shaders.bindShader(m_shader);
     if (!shader) return;
 
-    g_painter->setShaderProgram(shader);
-    shader->bindMultiTextures();
     g_painter->setColor(m_color);
     g_painter->drawTextureCoords(m_coordsBuffer, m_texture);
     g_painter->resetShaderProgram();
@@ -66,16 +92,21 @@ void DrawQueueItemImageWithShader::draw()
 void DrawQueueItemImageWithShader::draw(const Point& pos)
 {
     if (!m_texture) return;
-    PainterShaderProgramPtr shader = g_shaders.getShader(m_shader);
+    PainterShaderProgramPtr shader = g_shaders.bindShader(m_shader);
     if (!shader) return;
 
-    g_painter->setShaderProgram(shader);
-    shader->bindMultiTextures();
     g_painter->resetColor();
     g_painter->drawTexturedRect(Rect(pos, m_texture->getSize()), m_texture);
     g_painter->resetShaderProgram();
 }
 
+DrawQueueItem* DrawQueueItemImageWithShader::clone(const Point& offset)
+{
+    CoordsBuffer coords(std::move(m_coordsBuffer));
+    coords.translate(offset);
+    return new DrawQueueItemImageWithShader(coords, m_texture, m_color, m_shader);
+}
+
 void DrawQueueItemTexturedRect::draw()
 {
     g_painter->setColor(m_color);
@@ -132,6 +163,13 @@ bool DrawQueueItemFillCoords::cache()
     return true;
 }
 
+DrawQueueItem* DrawQueueItemFillCoords::clone(const Point& offset)
+{
+    CoordsBuffer coords(std::move(m_coordsBuffer));
+    coords.translate(offset);
+    return new DrawQueueItemFillCoords(coords, m_color);
+}
+
 void DrawQueueItemText::draw()
 {
     g_text.drawText(m_point, m_hash, m_color, m_shadow);
@@ -142,6 +180,59 @@ void DrawQueueItemTextColored::draw()
     g_text.drawColoredText(m_point, m_hash, m_colors, m_shadow);
 }
 
+// glyphs may reach outside of the layout box, the drawn glyph quads are what can overlap other items
+static Rect textBounds(uint64_t hash, const Point& point, bool shadow)
+{
+    Rect bounds = g_text.getBounds(hash);
+    if (!bounds.isValid())
+        return Rect();
+    bounds.translate(point);
+    return shadow ? bounds.united(bounds.translated(1, 1)) : bounds;
+}
+
+Rect DrawQueueItemText::bounds()
+{
+    return textBounds(m_hash, m_point, m_shadow);
+}
+
+Rect DrawQueueItemTextColored::bounds()
+{
+    return textBounds(m_hash, m_point, m_shadow);
+}
+
+DrawQueueItem* DrawQueueItemText::clone(const Point& offset)
+{
+    if (!m_font)
+        return nullptr;
+    // the text cache drops texts which weren't drawn for a while, and may store it again under another hash
+    m_hash = g_text.addText(m_font, m_text, m_size, m_align);
+    DrawQueueItemText* item = new DrawQueueItemText(m_point + offset, m_size, m_texture, m_hash, m_color, m_shadow);
+    item->m_font = m_font;
+    item->m_text = m_text;
+    item->m_align = m_align;
+    return item;
+}
+
+DrawQueueItem* DrawQueueItemTextColored::clone(const Point& offset)
+{
+    if (!m_font)
+        return nullptr;
+    m_hash = g_text.addText(m_font, m_text, m_size, m_align);
+    DrawQueueItemTextColored* item = new DrawQueueItemTextColored(m_point + offset, m_size, m_texture, m_hash, m_colors, m_shadow);
+    item->m_font = m_font;
+    item->m_text = m_text;
+    item->m_align = m_align;
+    return item;
+}
+
+DrawQueueItem* DrawQueueItemLine::clone(const Point& offset)
+{
+    std::vector<Point> points(m_points);
+    for (Point& point : points)
+        point += offset;
+    return new DrawQueueItemLine(points, m_width, m_color);
+}
+
 void::DrawQueueItemLine::draw()
 {
     g_painter->setColor(m_color);
@@ -167,6 +258,22 @@ void DrawQueueConditionClip::end(DrawQueue*)
     g_painter->setClipRect(m_prevClip);
 }
 
+bool DrawQueueConditionClip::needsFlush(bool starting)
+{
+    if (starting)
+        return g_painter->getClipRect() != m_rect;
+    return m_prevClip != m_rect;
+}
+
+bool DrawQueueConditionClip::merge(DrawQueueCondition* next)
+{
+    DrawQueueConditionClip* clip = dynamic_cast<DrawQueueConditionClip*>(next);
+    if (!clip || clip->m_rect != m_rect)
+        return false;
+    clip->m_prevClip = m_prevClip;
+    return true;
+}
+
 void DrawQueueConditionRotation::start(DrawQueue*)
 {
     g_painter->pushTransformMatrix();
@@ -189,7 +296,7 @@ void DrawQueueConditionMark::end(DrawQueue* queue)
     g_painter->setColor(m_color);
     for (size_t i = m_start; i < m_end; ++i) {
         DrawQueueItemTexturedRect* texture = dynamic_cast<DrawQueueItemTexturedRect*>(queue->m_queue[i]);
-        if (texture)
+        if (texture && texture->m_texture) // composed outfits only have a texture once they're in the atlas
             g_painter->drawTexturedRect(texture->m_dest, texture->m_texture, texture->m_src);
     }
     g_painter->resetShaderProgram();
@@ -216,14 +323,74 @@ void DrawQueue::addText(BitmapFontPtr font, const std::string& text, const Rect&
 {
     if (!font || text.empty()) return;
     uint64_t hash = g_text.addText(font, text, screenCoords.size(), align);
-    m_queue.push_back(new DrawQueueItemText(screenCoords.topLeft(), font->getTexture(), hash, color, shadow));
+    DrawQueueItemText* item = new DrawQueueItemText(screenCoords.topLeft(), screenCoords.size(), font->getTexture(), hash, color, shadow);
+    if (m_recording > 0) {
+        item->m_font = font;
+        item->m_text = text;
+        item->m_align = align;
+    }
+    m_queue.push_back(item);
 }
 
 void DrawQueue::addColoredText(BitmapFontPtr font, const std::string& text, const Rect& screenCoords, Fw::AlignmentFlag align, const std::vector<std::pair<int, Color>>& colors, bool shadow)
 {
     if (!font || text.empty()) return;
     uint64_t hash = g_text.addText(font, text, screenCoords.size(), align);
-    m_queue.push_back(new DrawQueueItemTextColored(screenCoords.topLeft(), font->getTexture(), hash, colors, shadow));
+    DrawQueueItemTextColored* item = new DrawQueueItemTextColored(screenCoords.topLeft(), screenCoords.size(), font->getTexture(), hash, colors, shadow);
+    if (m_recording > 0) {
+        item->m_font = font;
+        item->m_text = text;
+        item->m_align = align;
+    }
+    m_queue.push_back(item);
+}
+
+DrawQueueRecording::~DrawQueueRecording()
+{
+    for (auto& item : items)
+        delete item;
+    for (auto& condition : conditions)
+        delete condition;
+}
+
+std::unique_ptr<DrawQueueRecording> DrawQueue::record(size_t start, size_t conditionsStart, const Point& origin)
+{
+    m_recording = std::max<int>(0, m_recording - 1);
+
+    auto recording = std::make_unique<DrawQueueRecording>();
+    recording->origin = origin;
+    recording->items.reserve(m_queue.size() - start);
+    for (size_t i = start; i < m_queue.size(); ++i) {
+        DrawQueueItem* item = m_queue[i]->clone(Point());
+        if (!item)
+            return nullptr;
+        recording->items.push_back(item);
+    }
+    for (size_t i = conditionsStart; i < m_conditions.size(); ++i) {
+        DrawQueueCondition* condition = m_conditions[i];
+        if (condition->m_start < start)
+            return nullptr;
+        condition = condition->clone(0, Point());
+        if (!condition)
+            return nullptr;
+        condition->m_start -= start;
+        condition->m_end -= start;
+        recording->conditions.push_back(condition);
+    }
+    return recording;
+}
+
+void DrawQueue::replay(const DrawQueueRecording& recording, const Point& origin)
+{
+    Point offset = origin - recording.origin;
+    size_t start = m_queue.size();
+    for (DrawQueueItem* item : recording.items) {
+        DrawQueueItem* copy = item->clone(offset);
+        if (copy)
+            m_queue.push_back(copy);
+    }
+    for (DrawQueueCondition* condition : recording.conditions)
+        m_conditions.push_back(condition->clone(start, offset));
 }
 
 void DrawQueue::correctOutfit(const Rect& dest, int fromPos, bool oldScaling, bool center)
@@ -287,6 +454,9 @@ void DrawQueue::draw(DrawType drawType)
         return a->m_start == b->m_start ? a->m_end < b->m_end : a->m_start < b->m_start;
     });
 
+    // shader textures may have been replaced outside of the queues
+    g_shaders.resetBoundShader();
+
     Size originalResolution = g_painter->getResolution();
     if (m_scaling > 0.f && m_scaling < 0.99f) {
         Size resolution = originalResolution * (1.f / m_scaling);
@@ -298,6 +468,24 @@ void DrawQueue::draw(DrawType drawType)
         g_painter->setProjectionMatrix(projectionMatrix);
     }
 
+    // with reordering, items which can't be cached (text, shaders) are drawn after the cached geometry
+    // as long as nothing cached later overlaps them, so the draw cache isn't flushed for every label
+    const bool reorder = g_extras.reorderDrawQueue;
+    std::vector<DrawQueueItem*> deferred;
+    std::vector<Rect> deferredBounds;
+    auto flush = [&] {
+        g_drawCache.draw();
+        for (DrawQueueItem* item : deferred) {
+            if (!item->cache()) {
+                g_drawCache.draw();
+                if (!item->cache())
+                    item->draw();
+            }
+        }
+        deferred.clear();
+        deferredBounds.clear();
+    };
+
     auto condition = m_conditions.begin();
     std::stack<DrawQueueCondition*> activeConditions;
     // skip conditions
@@ -306,28 +494,55 @@ void DrawQueue::draw(DrawType drawType)
     // execute conditions & draw
     for (size_t i = start; i < end; ++i) {
         while (!activeConditions.empty() && activeConditions.top()->m_end <= i) {
-            g_drawCache.draw();
-            activeConditions.top()->end(this);
+            DrawQueueCondition* ending = activeConditions.top();
             activeConditions.pop();
+            if (reorder && condition != m_conditions.end() && (*condition)->m_start == i &&
+                (activeConditions.empty() || activeConditions.top()->m_end > i) && ending->merge(*condition)) {
+                activeConditions.push(*condition);
+                ++condition;
+                continue;
+            }
+            if (!reorder || ending->needsFlush(false))
+                flush();
+            ending->end(this);
         }
         while (condition != m_conditions.end() && (*condition)->m_start <= i) {
-            g_drawCache.draw();
+            if (!reorder || (*condition)->needsFlush(true))
+                flush();
             (*condition)->start(this);
             activeConditions.push(*condition);
             ++condition;
         }
 
-        if (!m_queue[i]->cache()) {
-            g_drawCache.draw();
-            if (!m_queue[i]->cache()) { // try to cache again, now g_drawCache should be empty, maybe there's new space
-                m_queue[i]->draw();
+        DrawQueueItem* item = m_queue[i];
+        Rect bounds;
+        if (reorder) {
+            bounds = item->bounds();
+            if (!deferred.empty()) {
+                bool overlaps = !bounds.isValid() || deferred.size() >= MAX_DEFERRED_ITEMS;
+                for (size_t j = 0; j < deferredBounds.size() && !overlaps; ++j)
+                    overlaps = deferredBounds[j].intersects(bounds);
+                if (overlaps)
+                    flush();
+            }
+        }
+
+        if (!item->cache()) {
+            if (reorder && bounds.isValid()) {
+                deferred.push_back(item);
+                deferredBounds.push_back(bounds);
+                continue;
+            }
+            flush();
+            if (!item->cache()) { // try to cache again, now g_drawCache should be empty, maybe there's new space
+                item->draw();
             }
         }
         if (g_drawCache.getSize() >= g_drawCache.HALF_MAX_SIZE) {
             g_drawCache.draw();
         }
     }
-    g_drawCache.draw();
+    flush();
     // end all actibe conditions
     while (!activeConditions.empty()) {
         activeConditions.top()->end(this);
@@ -26,6 +26,10 @@ struct DrawQueueItem {
     virtual void draw() {}
     virtual void draw(const Point& pos) {}
     virtual bool cache() { return false; }
+    // screen area touched by draw(), invalid if unknown
+    virtual Rect bounds() { return Rect(); }
+    // copy moved by offset for retained draw lists, nullptr if the item can't be copied
+    virtual DrawQueueItem* clone(const Point& offset) { return nullptr; }
 
     TexturePtr m_texture;
     Color m_color;
@@ -40,6 +44,8 @@ struct DrawQueueItemTexturedRect : public DrawQueueItem {
     virtual void draw();
     virtual void draw(const Point& pos);
     virtual bool cache();
+    virtual Rect bounds() { return m_dest; }
+    virtual DrawQueueItem* clone(const Point& offset) { return new DrawQueueItemTexturedRect(m_dest.translated(offset), m_texture, m_src, m_color); }
 
     Rect m_dest;
     Rect m_src;
@@ -53,6 +59,7 @@ struct DrawQueueItemTextureCoords : public DrawQueueItem {
     void draw();
     void draw(const Point& pos);
     bool cache();
+    DrawQueueItem* clone(const Point& offset);
 
     CoordsBuffer m_coordsBuffer;
 };
@@ -63,13 +70,24 @@ struct DrawQueueItemColoredTextureCoords : public DrawQueueItem {
     {};
 
     void draw();
+    DrawQueueItem* clone(const Point& offset);
 
     CoordsBuffer m_coordsBuffer;
     std::vector<std::pair<int, Color>> m_colors;
 };
 
+// glyphs of a distance field font laid out by the caller, drawn with the sdf text program
+struct DrawQueueItemSdfTextureCoords : public DrawQueueItemColoredTextureCoords {
+    DrawQueueItemSdfTextureCoords(CoordsBuffer& coordsBuffer, const TexturePtr& texture, const std::vector<std::pair<int, Color>>& colors) :
+        DrawQueueItemColoredTextureCoords(coordsBuffer, texture, colors)
+    {};
+
+    void draw();
+    DrawQueueItem* clone(const Point& offset);
+};
+
 struct DrawQueueItemImageWithShader : public DrawQueueItemTextureCoords {
-    DrawQueueItemImageWithShader(CoordsBuffer& coords, const TexturePtr& texture, const Color& color, const std::string& shader) :
+    DrawQueueItemImageWithShader(CoordsBuffer& coords, const TexturePtr& texture, const Color& color, int shader) :
         DrawQueueItemTextureCoords(coords, texture, color), m_shader(shader)
     {};
 
@@ -78,14 +96,17 @@ struct DrawQueueItemImageWithShader : public DrawQueueItemTextureCoords {
     bool cache() override {
         return false;
     }
+    DrawQueueItem* clone(const Point& offset) override;
 
-    std::string m_shader;
+    int m_shader;
 };
 
 struct DrawQueueItemFilledRect : public DrawQueueItem {
     DrawQueueItemFilledRect(const Rect& rect, const Color& color) :
         DrawQueueItem(nullptr, color), m_dest(rect) {};
     bool cache();
+    Rect bounds() { return m_dest; }
+    DrawQueueItem* clone(const Point& offset) { return new DrawQueueItemFilledRect(m_dest.translated(offset), m_color); }
 
     Rect m_dest;
 };
@@ -95,6 +116,8 @@ struct DrawQueueItemClearRect : public DrawQueueItem {
         DrawQueueItem(nullptr, color), m_dest(rect)
     {};
     void draw();
+    Rect bounds() { return m_dest; }
+    DrawQueueItem* clone(const Point& offset) { return new DrawQueueItemClearRect(m_dest.translated(offset), m_color); }
 
     Rect m_dest;
 };
@@ -104,31 +127,45 @@ struct DrawQueueItemFillCoords : public DrawQueueItem {
         DrawQueueItem(nullptr, color), m_coordsBuffer(std::move(coordsBuffer))
     {};
     bool cache();
+    DrawQueueItem* clone(const Point& offset);
 
     CoordsBuffer m_coordsBuffer;
 };
 
 struct DrawQueueItemText : public DrawQueueItem {
-    DrawQueueItemText(const Point& point, const TexturePtr& texture, uint64_t hash, const Color& color, bool shadow = false) :
-        DrawQueueItem(texture, color), m_point(point), m_hash(hash), m_shadow(shadow)
+    DrawQueueItemText(const Point& point, const Size& size, const TexturePtr& texture, uint64_t hash, const Color& color, bool shadow = false) :
+        DrawQueueItem(texture, color), m_point(point), m_size(size), m_hash(hash), m_shadow(shadow)
     {};
     void draw();
+    Rect bounds();
+    DrawQueueItem* clone(const Point& offset);
 
     Point m_point;
+    Size m_size;
     uint64_t m_hash;
     bool m_shadow = false;
+    // only kept while recording, to add the text again if the text cache dropped it
+    BitmapFontPtr m_font;
+    std::string m_text;
+    Fw::AlignmentFlag m_align = Fw::AlignTopLeft;
 };
 
 struct DrawQueueItemTextColored : public DrawQueueItem {
-    DrawQueueItemTextColored(const Point& point, const TexturePtr& texture, uint64_t hash, const std::vector<std::pair<int, Color>>& colors, bool shadow = false) :
-        DrawQueueItem(texture), m_point(point), m_hash(hash), m_colors(colors), m_shadow(shadow)
+    DrawQueueItemTextColored(const Point& point, const Size& size, const TexturePtr& texture, uint64_t hash, const std::vector<std::pair<int, Color>>& colors, bool shadow = false) :
+        DrawQueueItem(texture), m_point(point), m_size(size), m_hash(hash), m_colors(colors), m_shadow(shadow)
     {};
     void draw();
+    Rect bounds();
+    DrawQueueItem* clone(const Point& offset);
 
     Point m_point;
+    Size m_size;
     uint64_t m_hash;
     std::vector<std::pair<int, Color>> m_colors;
     bool m_shadow = false;
+    BitmapFontPtr m_font;
+    std::string m_text;
+    Fw::AlignmentFlag m_align = Fw::AlignTopLeft;
 };
 
 struct DrawQueueItemLine : public DrawQueueItem {
@@ -136,6 +173,7 @@ struct DrawQueueItemLine : public DrawQueueItem {
         DrawQueueItem(nullptr, color), m_points(points), m_width(width)
     {};
     void draw();
+    DrawQueueItem* clone(const Point& offset);
 
     std::vector<Point> m_points;
     int m_width;
@@ -148,6 +186,12 @@ struct DrawQueueCondition {
 
     virtual void start(DrawQueue*) = 0;
     virtual void end(DrawQueue*) = 0;
+    // false if pending draw cache geometry can be kept across start/end
+    virtual bool needsFlush(bool starting) { return true; }
+    // takes over an adjacent condition with the same state, next won't be started
+    virtual bool merge(DrawQueueCondition* next) { return false; }
+    // copy for retained draw lists, items moved by shift and offset
+    virtual DrawQueueCondition* clone(size_t shift, const Point& offset) { return nullptr; }
 
     size_t m_start;
     size_t m_end;
@@ -159,6 +203,9 @@ struct DrawQueueConditionClip : public DrawQueueCondition {
 
     void start(DrawQueue* queue) override;
     void end(DrawQueue* queue) override;
+    bool needsFlush(bool starting) override;
+    bool merge(DrawQueueCondition* next) override;
+    DrawQueueCondition* clone(size_t shift, const Point& offset) override { return new DrawQueueConditionClip(m_start + shift, m_end + shift, m_rect.translated(offset)); }
 
     Rect m_rect;
     Rect m_prevClip;
@@ -170,6 +217,7 @@ struct DrawQueueConditionRotation : public DrawQueueCondition {
 
     void start(DrawQueue* queue) override;
     void end(DrawQueue* queue) override;
+    DrawQueueCondition* clone(size_t shift, const Point& offset) override { return new DrawQueueConditionRotation(m_start + shift, m_end + shift, m_center + offset, m_angle); }
 
     Point m_center;
     float m_angle;
@@ -182,10 +230,24 @@ struct DrawQueueConditionMark : public DrawQueueCondition {
 
     void start(DrawQueue* queue) override;
     void end(DrawQueue* queue) override;
+    bool needsFlush(bool starting) override { return !starting; }
+    DrawQueueCondition* clone(size_t shift, const Point& offset) override { return new DrawQueueConditionMark(m_start + shift, m_end + shift, m_color); }
 
     Color m_color;
 };
 
+// items and conditions emitted by an unchanged UI subtree, replayed instead of drawing it again
+struct DrawQueueRecording {
+    DrawQueueRecording() = default;
+    DrawQueueRecording(const DrawQueueRecording&) = delete;
+    DrawQueueRecording& operator=(const DrawQueueRecording&) = delete;
+    ~DrawQueueRecording();
+
+    std::vector<DrawQueueItem*> items;
+    std::vector<DrawQueueCondition*> conditions; // item indexes relative to the first item
+    Point origin;
+};
+
 class DrawQueue {
 public:
     DrawQueue() = default;
@@ -221,6 +283,10 @@ public:
     {
         m_queue.push_back(new DrawQueueItemColoredTextureCoords(coords, texture, colors));
     }
+    void addSdfTextureCoords(CoordsBuffer& coords, const TexturePtr& texture, const std::vector<std::pair<int, Color>>& colors)
+    {
+        m_queue.push_back(new DrawQueueItemSdfTextureCoords(coords, texture, colors));
+    }
     void addFilledRect(const Rect& dest, const Color& color = Color::white)
     {
         m_queue.push_back(new DrawQueueItemFilledRect(dest, color));
@@ -285,6 +351,26 @@ public:
     {
         return m_queue.size();
     }
+    DrawQueueItem* at(size_t index)
+    {
+        return m_queue[index];
+    }
+    // moves the items from start to the end of the queue out of it, the caller owns them
+    std::vector<DrawQueueItem*> detach(size_t start)
+    {
+        std::vector<DrawQueueItem*> items(m_queue.begin() + start, m_queue.end());
+        m_queue.resize(start);
+        return items;
+    }
+    size_t conditionsSize()
+    {
+        return m_conditions.size();
+    }
+
+    // texts added between beginRecording and record keep what's needed to be replayed
+    void beginRecording() { m_recording += 1; }
+    std::unique_ptr<DrawQueueRecording> record(size_t start, size_t conditionsStart, const Point& origin);
+    void replay(const DrawQueueRecording& recording, const Point& origin);
 
     void setOpacity(size_t start, float opacity)
     {
@@ -317,12 +403,12 @@ public:
     }
     void correctOutfit(const Rect& dest, int fromPos, bool oldScaling, bool center);
 
-    void setShader(const std::string& shader)
+    void setShader(int shader)
     {
         m_shader = shader;
     }
 
-    std::string getShader()
+    int getShader()
     {
         return m_shader;
     }
@@ -338,14 +424,17 @@ public:
     }
 
 private:
+    static const size_t MAX_DEFERRED_ITEMS = 64;
+
     std::vector<DrawQueueItem*> m_queue;
     std::vector<DrawQueueCondition*> m_conditions;
     Size m_frameBufferSize;
     Rect m_frameBufferDest, m_frameBufferSrc;
     size_t mapPosition = 0;
     bool m_useFrameBuffer = false;
+    int m_recording = 0;
     float m_scaling = 1.f;
-    std::string m_shader;
+    int m_shader = 0;
     PointF m_walkOffset;
 
     friend struct DrawQueueConditionMark;
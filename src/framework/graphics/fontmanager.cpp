@@ -97,10 +97,11 @@ void FontManager::importTTFFont(const std::string& ttfFile,
                        int spaceWidth,
                        int firstGlyph,
                        int lastGlyph,
-                       bool setDefault)
+                       bool setDefault,
+                       bool sdf)
 {
     if (g_graphicsThreadId != std::this_thread::get_id()) {
-        g_graphicsDispatcher.addEvent(std::bind(&FontManager::importTTFFont, this, ttfFile, fontName, pixelHeight, yOffset, glyphSpacing, spaceWidth, firstGlyph, lastGlyph, setDefault));
+        g_graphicsDispatcher.addEvent(std::bind(&FontManager::importTTFFont, this, ttfFile, fontName, pixelHeight, yOffset, glyphSpacing, spaceWidth, firstGlyph, lastGlyph, setDefault, sdf));
         return;
     }
 
@@ -134,7 +135,7 @@ void FontManager::importTTFFont(const std::string& ttfFile,
                                                fontName,
                                                pixelHeight, firstGlyph, lastGlyph,
                                                glyphSpacing.width(), glyphSpacing.height(), yOffset,
-                                               spaceWidth, atlasRes);
+                                               spaceWidth, sdf, atlasRes);
 
         if (!ok || !atlasRes.image) {
             g_logger.error(stdext::format("Failed to rasterize TTF '%s'", ttfFile));
@@ -199,6 +200,12 @@ void FontManager::importTTFFont(const std::string& ttfFile,
             fontNode->addChild(n);
         }
 
+        if (atlasRes.sdf) {
+            OTMLNodePtr n = OTMLNode::create("sdf");
+            n->write<bool>(true);
+            fontNode->addChild(n);
+        }
+
         if (setDefault) {
             OTMLNodePtr n = OTMLNode::create("default");
             n->write<bool>(true);
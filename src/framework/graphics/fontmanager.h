@@ -43,7 +43,8 @@ public:
                        int spaceWidth = 3,
                        int firstGlyph = 32,
                        int lastGlyph = 255,
-                       bool setDefault = false);
+                       bool setDefault = false,
+                       bool sdf = false);
 
     bool fontExists(const std::string& fontName);
     BitmapFontPtr getFont(const std::string& fontName);
@@ -13,7 +13,8 @@ Graph g_graphs[GRAPH_LAST + 1] = {
     {"Graphics poll time"},
     {"Dispatcher events"},
     {"Graphics events"},
-    {"Latency"}
+    {"Latency"},
+    {"Draw cache flushes"}
 };
 
 Graph::Graph(const std::string& name, size_t capacity) : m_name(name), m_capacity(capacity)
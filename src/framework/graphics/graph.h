@@ -16,7 +16,8 @@ enum GraphType {
     GRAPH_DISPATCHER_EVENTS = 6,
     GRAPH_GRAPHICS_EVENTS = 7,
     GRAPH_LATENCY = 8,
-    GRAPH_LAST = GRAPH_LATENCY
+    GRAPH_DRAW_CACHE_FLUSHES = 9,
+    GRAPH_LAST = GRAPH_DRAW_CACHE_FLUSHES
 };
 
 class Graph 
@@ -46,6 +46,7 @@ public:
     void bind() { glBindBuffer(m_type, m_id); }
     static void unbind(Type type) { glBindBuffer(type, 0); }
     void write(void *data, int count, UsagePattern usage) { glBufferData(m_type, count, data, usage); }
+    void update(const void *data, int offset, int count) { glBufferSubData(m_type, offset, count, data); }
 
 private:
     Type m_type;
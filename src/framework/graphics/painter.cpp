@@ -25,8 +25,10 @@
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/colorarray.h>
 #include <framework/graphics/deptharray.h>
+#include <framework/graphics/drawcache.h>
 #include <framework/platform/platformwindow.h>
 
+#include <framework/graphics/shadermanager.h>
 #include <framework/graphics/shaders/shaders.h>
 #include <framework/platform/platformwindow.h>
 #include <framework/util/extras.h>
@@ -61,10 +63,11 @@ Painter::Painter()
     m_drawOutfitLayersProgram = PainterShaderProgram::create("drawOutfitLayersProgram", glslOutfitVertexShader, glslOutfitFragmentShader, true);
     m_drawNewProgram = PainterShaderProgram::create("drawNewProgram", newVertexShader, newFragmentShader);
     m_drawTextProgram = PainterShaderProgram::create("drawTextProgram", textVertexShader, textFragmentShader);
+    m_drawSdfTextProgram = PainterShaderProgram::create("drawSdfTextProgram", textVertexShader, sdfTextFragmentShader);
     m_drawLineProgram = PainterShaderProgram::create("drawLineProgram", lineVertexShader, lineFragmentShader);
 
     if (!m_drawTexturedProgram || !m_drawSolidColorProgram || !m_drawSolidColorOnTextureProgram || !m_drawOutfitLayersProgram ||
-        !m_drawNewProgram || !m_drawTextProgram || !m_drawLineProgram) {
+        !m_drawNewProgram || !m_drawTextProgram || !m_drawSdfTextProgram || !m_drawLineProgram) {
         g_logger.fatal("Can't setup default shaders, check log file for details");
     }
 
@@ -623,33 +626,34 @@ void Painter::drawFilledRect(const Rect& dest)
 }
 
 // new render
-void Painter::drawText(const Point& pos, CoordsBuffer& coordsBuffer, const Color& color, const TexturePtr& texture)
+void Painter::drawText(const Point& pos, CoordsBuffer& coordsBuffer, const Color& color, const TexturePtr& texture, bool sdf)
 {
+    PainterShaderProgram* program = sdf ? m_drawSdfTextProgram.get() : m_drawTextProgram.get();
     setTexture(texture);
     // update shader with the current painter state
-    m_drawTextProgram->bind();
-    m_drawTextProgram->setTransformMatrix(m_transformMatrix);
-    m_drawTextProgram->setProjectionMatrix(m_projectionMatrix);
-    m_drawTextProgram->setTextureMatrix(m_textureMatrix);
-    m_drawTextProgram->setOffset(pos);
-    m_drawTextProgram->setColor(color);
+    program->bind();
+    program->setTransformMatrix(m_transformMatrix);
+    program->setProjectionMatrix(m_projectionMatrix);
+    program->setTextureMatrix(m_textureMatrix);
+    program->setOffset(pos);
+    program->setColor(color);
 
     HardwareBuffer* hardwareCache = coordsBuffer.getVertexHardwareCache();
     if (hardwareCache) {
         hardwareCache->bind();
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, nullptr, 2);
+        program->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, nullptr, 2);
         HardwareBuffer::unbind(HardwareBuffer::VertexBuffer);
     } else {
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, coordsBuffer.getVertexArray(), 2);
+        program->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, coordsBuffer.getVertexArray(), 2);
     }
 
     HardwareBuffer* texHardwareCache = coordsBuffer.getTextureHardwareCache();
     if (texHardwareCache) {
         texHardwareCache->bind();
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, nullptr, 2);
+        program->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, nullptr, 2);
         HardwareBuffer::unbind(HardwareBuffer::VertexBuffer);
     } else {
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, coordsBuffer.getTextureCoordArray(), 2);
+        program->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, coordsBuffer.getTextureCoordArray(), 2);
     }
 
     glDrawArrays(GL_TRIANGLES, 0, coordsBuffer.getVertexCount());
@@ -657,37 +661,38 @@ void Painter::drawText(const Point& pos, CoordsBuffer& coordsBuffer, const Color
     m_calls += 1;
 }
 
-void Painter::drawText(const Point& pos, CoordsBuffer& coordsBuffer, const std::vector<std::pair<int, Color>>& colors, const TexturePtr& texture)
+void Painter::drawText(const Point& pos, CoordsBuffer& coordsBuffer, const std::vector<std::pair<int, Color>>& colors, const TexturePtr& texture, bool sdf)
 {
+    PainterShaderProgram* program = sdf ? m_drawSdfTextProgram.get() : m_drawTextProgram.get();
     setTexture(texture);
     // update shader with the current painter state
-    m_drawTextProgram->bind();
-    m_drawTextProgram->setTransformMatrix(m_transformMatrix);
-    m_drawTextProgram->setProjectionMatrix(m_projectionMatrix);
-    m_drawTextProgram->setTextureMatrix(m_textureMatrix);
-    m_drawTextProgram->setOffset(pos);
+    program->bind();
+    program->setTransformMatrix(m_transformMatrix);
+    program->setProjectionMatrix(m_projectionMatrix);
+    program->setTextureMatrix(m_textureMatrix);
+    program->setOffset(pos);
 
     HardwareBuffer* hardwareCache = coordsBuffer.getVertexHardwareCache();
     if (hardwareCache) {
         hardwareCache->bind();
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, nullptr, 2);
+        program->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, nullptr, 2);
         HardwareBuffer::unbind(HardwareBuffer::VertexBuffer);
     } else {
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, coordsBuffer.getVertexArray(), 2);
+        program->setAttributeArray(PainterShaderProgram::VERTEX_ATTR, coordsBuffer.getVertexArray(), 2);
     }
 
     HardwareBuffer* texHardwareCache = coordsBuffer.getTextureHardwareCache();
     if (texHardwareCache) {
         texHardwareCache->bind();
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, nullptr, 2);
+        program->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, nullptr, 2);
         HardwareBuffer::unbind(HardwareBuffer::VertexBuffer);
     } else {
-        m_drawTextProgram->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, coordsBuffer.getTextureCoordArray(), 2);
+        program->setAttributeArray(PainterShaderProgram::TEXCOORD_ATTR, coordsBuffer.getTextureCoordArray(), 2);
     }
 
     int s = 0;
     for (auto& cp : colors) {
-        m_drawTextProgram->setColor(cp.second);
+        program->setColor(cp.second);
         glDrawArrays(GL_TRIANGLES, s * 6, (cp.first - s) * 6);
         s = cp.first;
     }
@@ -745,6 +750,7 @@ void Painter::setSecondTexture(const TexturePtr& texture)
     glActiveTexture(GL_TEXTURE1); // u_Tex1
     glBindTexture(GL_TEXTURE_2D, activeTexture);
     glActiveTexture(GL_TEXTURE0);
+    g_shaders.resetBoundShader(); // replaced the first shader texture
 }
 
 void Painter::setOffset(const Point& offset)
@@ -775,3 +781,44 @@ void Painter::drawCache(const std::vector<float>& vertex, const std::vector<floa
     PainterShaderProgram::disableAttributeArray(PainterShaderProgram::COLOR_ATTR); 
 }
 
+void Painter::drawCache(const DrawCacheVertex* vertices, int size)
+{
+    // vertices are streamed into a ring buffer, it's orphaned when it's full so the driver
+    // doesn't have to wait for the draws still using its previous content
+    const int BUFFER_SIZE = DrawCache::MAX_SIZE * 4 * sizeof(DrawCacheVertex);
+    int bytes = size * sizeof(DrawCacheVertex);
+    if (!m_drawCacheBuffer) {
+        m_drawCacheBuffer = std::make_unique<HardwareBuffer>(HardwareBuffer::VertexBuffer);
+        m_drawCacheBufferOffset = BUFFER_SIZE;
+    }
+
+    m_drawCacheBuffer->bind();
+    if (m_drawCacheBufferOffset + bytes > BUFFER_SIZE) {
+        m_drawCacheBuffer->write(nullptr, BUFFER_SIZE, HardwareBuffer::StreamDraw);
+        m_drawCacheBufferOffset = 0;
+    }
+    m_drawCacheBuffer->update(vertices, m_drawCacheBufferOffset, bytes);
+
+    setTexture(g_atlas.get(0)); // todo: remove it
+    // update shader with the current painter state
+    m_drawNewProgram->bind();
+    m_drawNewProgram->setTransformMatrix(m_transformMatrix);
+    m_drawNewProgram->setProjectionMatrix(m_projectionMatrix);
+    m_drawNewProgram->setTextureMatrix(m_textureMatrix);
+
+    PainterShaderProgram::enableAttributeArray(PainterShaderProgram::COLOR_ATTR);
+
+    uintptr_t offset = m_drawCacheBufferOffset;
+    glVertexAttribPointer(PainterShaderProgram::VERTEX_ATTR, 2, GL_SHORT, GL_FALSE, sizeof(DrawCacheVertex), (const void*)(offset + offsetof(DrawCacheVertex, x)));
+    glVertexAttribPointer(PainterShaderProgram::TEXCOORD_ATTR, 2, GL_SHORT, GL_FALSE, sizeof(DrawCacheVertex), (const void*)(offset + offsetof(DrawCacheVertex, u)));
+    glVertexAttribPointer(PainterShaderProgram::COLOR_ATTR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DrawCacheVertex), (const void*)(offset + offsetof(DrawCacheVertex, r)));
+
+    glDrawArrays(GL_TRIANGLES, 0, size);
+    m_draws += size;
+    m_calls += 1;
+    m_drawCacheBufferOffset += bytes;
+
+    PainterShaderProgram::disableAttributeArray(PainterShaderProgram::COLOR_ATTR);
+    HardwareBuffer::unbind(HardwareBuffer::VertexBuffer);
+}
+
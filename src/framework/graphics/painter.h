@@ -30,6 +30,8 @@
 #include <framework/graphics/colorarray.h>
 #include <framework/graphics/drawqueue.h>
 
+struct DrawCacheVertex;
+
 class Painter {
 public:
     enum BlendEquation {
@@ -146,8 +148,8 @@ public:
     void setDrawProgram(PainterShaderProgram* drawProgram) { m_drawProgram = drawProgram; }
     bool hasShaders() { return true; }
 
-    void drawText(const Point& pos, CoordsBuffer& coordsBuffer, const Color& color, const TexturePtr& texture);
-    void drawText(const Point& pos, CoordsBuffer& coordsBuffer, const std::vector<std::pair<int, Color>>& colors, const TexturePtr& texture);
+    void drawText(const Point& pos, CoordsBuffer& coordsBuffer, const Color& color, const TexturePtr& texture, bool sdf = false);
+    void drawText(const Point& pos, CoordsBuffer& coordsBuffer, const std::vector<std::pair<int, Color>>& colors, const TexturePtr& texture, bool sdf = false);
 
     void drawLine(const std::vector<float>& vertex, int size, int width = 1);
 
@@ -156,6 +158,7 @@ public:
 
     void setAtlasTextures(const TexturePtr& atlas);
     void drawCache(const std::vector<float>& vertex, const std::vector<float>& texture, const std::vector<float>& color, int size);
+    void drawCache(const DrawCacheVertex* vertices, int size);
 
     void setColor(const Color& color) { m_color = color; }
     void setShaderProgram(const PainterShaderProgramPtr& shaderProgram) { setShaderProgram(shaderProgram.get()); }
@@ -249,8 +252,11 @@ private:
     PainterShaderProgramPtr m_drawOutfitLayersProgram;
 
     PainterShaderProgramPtr m_drawNewProgram;
+    std::unique_ptr<HardwareBuffer> m_drawCacheBuffer;
+    int m_drawCacheBufferOffset = 0;
 
     PainterShaderProgramPtr m_drawTextProgram;
+    PainterShaderProgramPtr m_drawSdfTextProgram;
     PainterShaderProgramPtr m_drawLineProgram;
 };
 
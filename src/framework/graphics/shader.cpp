@@ -54,7 +54,9 @@ bool Shader::compileSourceCode(const std::string& sourceCode)
 #ifdef OPENGL_ES
     static const char *qualifierDefines =
         "precision highp float;\n";
-    std::string code = qualifierDefines;
+    // derivatives are an extension in GLSL ES 1.00, its directive must come before any statement
+    std::string code = sourceCode.find("fwidth") != std::string::npos ? "#extension GL_OES_standard_derivatives : enable\n" : "";
+    code.append(qualifierDefines);
     code.append(sourceCode);
     const char* c_source = code.c_str();
 #else
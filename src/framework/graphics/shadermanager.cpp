@@ -25,6 +25,7 @@
 #include <framework/graphics/graphics.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/util/stats.h>
 
 ShaderManager g_shaders;
 
@@ -36,6 +37,8 @@ void ShaderManager::init()
 void ShaderManager::terminate()
 {
     m_shaders.clear();
+    m_programs.clear();
+    m_boundShader = 0;
 }
 
 void ShaderManager::createShader(const std::string& name, std::string vertex, std::string fragment, bool colorMatrix)
@@ -51,8 +54,14 @@ void ShaderManager::createShader(const std::string& name, std::string vertex, st
 
     g_graphicsDispatcher.addEventEx("createShader", [&, name, vertex, fragment, colorMatrix] {
         auto program = PainterShaderProgram::create(name, vertex, fragment, colorMatrix);
-        if (program)
-            m_shaders[name] = program;
+        if (!program)
+            return;
+        m_shaders[name] = program;
+        size_t id = getShaderId(name);
+        if (m_programs.size() <= id)
+            m_programs.resize(id + 1);
+        m_programs[id] = program;
+        m_boundShader = 0;
     });
 }
 
@@ -62,15 +71,62 @@ void ShaderManager::addTexture(const std::string& name, const std::string& file)
         auto program = getShader(name);
         if (program)
             program->addMultiTexture(file);
+        m_boundShader = 0;
     });
 }
 
 PainterShaderProgramPtr ShaderManager::getShader(const std::string& name)
 {
     VALIDATE_GRAPHICS_THREAD();
+    g_stats.addShaderLookup();
     auto it = m_shaders.find(name);
     if(it != m_shaders.end())
         return it->second;
     return nullptr;
 }
 
+int ShaderManager::getShaderId(const std::string& name)
+{
+    if (name.empty())
+        return 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_shaderIds.find(name);
+    if (it != m_shaderIds.end())
+        return it->second;
+    int id = (int)m_shaderNames.size();
+    m_shaderNames.push_back(name);
+    m_shaderIds[name] = id;
+    return id;
+}
+
+std::string ShaderManager::getShaderName(int id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (id <= 0 || id >= (int)m_shaderNames.size())
+        return "";
+    return m_shaderNames[id];
+}
+
+PainterShaderProgramPtr ShaderManager::getShader(int id)
+{
+    VALIDATE_GRAPHICS_THREAD();
+    if (id <= 0 || id >= (int)m_programs.size())
+        return nullptr;
+    return m_programs[id];
+}
+
+PainterShaderProgramPtr ShaderManager::bindShader(int id)
+{
+    PainterShaderProgramPtr shader = getShader(id);
+    if (!shader)
+        return nullptr;
+    g_painter->setShaderProgram(shader);
+    if (m_boundShader != id) {
+        shader->bindMultiTextures();
+        m_boundShader = id;
+        g_stats.addShaderBind();
+    }
+    g_stats.addShaderDraw();
+    return shader;
+}
+
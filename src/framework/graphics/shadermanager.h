@@ -25,6 +25,7 @@
 
 #include "declarations.h"
 #include <framework/graphics/paintershaderprogram.h>
+#include <mutex>
 
 //@bindsingleton g_shaders
 class ShaderManager
@@ -41,8 +42,23 @@ public:
     void addTexture(const std::string& name, const std::string& file);
     PainterShaderProgramPtr getShader(const std::string& name);
 
+    // shaders are referenced by handles resolved once from their names, 0 is no shader
+    // handles can be taken before the shader is created and from any thread
+    int getShaderId(const std::string& name);
+    std::string getShaderName(int id);
+    PainterShaderProgramPtr getShader(int id);
+
+    // sets the shader as the painter program, its textures are only bound again when another shader was bound in between
+    PainterShaderProgramPtr bindShader(int id);
+    void resetBoundShader() { m_boundShader = 0; }
+
 private:
     std::unordered_map<std::string, PainterShaderProgramPtr> m_shaders;
+    std::unordered_map<std::string, int> m_shaderIds;
+    std::vector<std::string> m_shaderNames = { "" };
+    std::vector<PainterShaderProgramPtr> m_programs; // by handle, graphics thread only
+    std::mutex m_mutex;
+    int m_boundShader = 0;
 };
 
 
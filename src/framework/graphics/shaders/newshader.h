@@ -68,6 +68,25 @@ static const std::string textFragmentShader = "\n\
         gl_FragColor = texture2D(u_Tex0, v_TexCoord) * u_Color;\n\
     }\n";
 
+// SDF TEXT
+// the edge is stored as 0.5, smoothing over about one screen pixel keeps it sharp at any scale,
+// without derivatives (GLES lacking GL_OES_standard_derivatives) it smooths half a pixel of distance field
+static const std::string sdfTextFragmentShader = "\n\
+    varying vec2 v_TexCoord;\n\
+    uniform vec4 u_Color;\n\
+    uniform sampler2D u_Tex0;\n\
+    void main()\n\
+    {\n\
+        float edgeDistance = texture2D(u_Tex0, v_TexCoord).a;\n\
+#if defined(GL_ES) && !defined(GL_OES_standard_derivatives)\n\
+        float smoothing = 0.0625;\n\
+#else\n\
+        float smoothing = max(0.5 * fwidth(edgeDistance), 0.001);\n\
+#endif\n\
+        float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, edgeDistance);\n\
+        gl_FragColor = vec4(u_Color.rgb, u_Color.a * alpha);\n\
+    }\n";
+
 // LINE
 static const std::string lineFragmentShader = "\n\
     uniform vec4 u_Color;\n\
@@ -1,6 +1,5 @@
-// Minimal subset redirect to system-provided stb_truetype if available.
+// Redirect to the stb_truetype.h provided by the stb package (vcpkg "stb", FindStb.cmake).
 // This header expects STB_TRUETYPE_IMPLEMENTATION to be defined in exactly one .cpp.
-// For full functionality, embed the official stb_truetype.h content.
 
 #ifndef STB_TRUETYPE_H_MINIMAL
 #define STB_TRUETYPE_H_MINIMAL
@@ -8,10 +7,12 @@
 // If the build already provides stb_truetype from elsewhere, include it.
 #if __has_include(<stb_truetype.h>)
 #include <stb_truetype.h>
+// the portable rasterizer in truetypefont.cpp is only built with the full library
+#define STB_TRUETYPE_AVAILABLE
 #else
 
-// Fallback: embed a trimmed forward-declaration-only header and rely on implementation being compiled here.
-// Note: For production use, replace this with the full stb_truetype.h.
+// Fallback for builds without the stb package (android prebuilts): declarations only,
+// TrueType atlases are then limited to GDI+ on Windows.
 
 typedef unsigned char stbtt_uint8;
 typedef signed char stbtt_int8;
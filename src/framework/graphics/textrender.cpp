@@ -2,6 +2,7 @@
 #include "textrender.h"
 #include <framework/core/logger.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/util/stats.h>
 
 TextRender g_text;
 
@@ -12,34 +13,29 @@ void TextRender::init()
 
 void TextRender::terminate()
 {
-    for (auto& cache : m_cache) {
-        cache.clear();
+    for (int i = 0; i < INDEXES; ++i) {
+        std::lock_guard<std::mutex> lock(m_mutex[i]);
+        m_cache[i].clear();
+        m_lru[i].clear();
+        m_bytes[i] = 0;
     }
 }
 
 void TextRender::poll()
 {
+    // least recently used layouts are dropped while a shard is over its part of the budget
     static int iteration = 0;
     int index = (iteration++) % INDEXES;
     std::lock_guard<std::mutex> lock(m_mutex[index]);
-    auto& cache = m_cache[index];
-    if (cache.size() < 100)
-        return;
-
-    ticks_t dropPoint = g_clock.millis();
-    if (cache.size() > 500)
-        dropPoint -= 10;
-    else if (cache.size() > 250)
-        dropPoint -= 100;
-    else
-        dropPoint -= 1000;
-
-    for (auto it = cache.begin(); it != cache.end(); ) {
-        if (it->second->lastUse < dropPoint) {
-            it = cache.erase(it);
-            continue;
-        }
-        ++it;
+    ticks_t keepPoint = g_clock.millis() - KEEP_TIME;
+    while (m_bytes[index] > BUDGET / INDEXES && !m_lru[index].empty()) {
+        auto it = m_cache[index].find(m_lru[index].front());
+        if (it->second->lastUse >= keepPoint)
+            break;
+        m_bytes[index] -= it->second->bytes;
+        m_lru[index].pop_front();
+        m_cache[index].erase(it);
+        g_stats.addTextLayoutEviction();
     }
 }
 
@@ -57,15 +53,72 @@ uint64_t TextRender::addText(BitmapFontPtr font, const std::string& text, const
     hash = hash * 31 + (uint64_t)font->getId();
 
     int index = hash % INDEXES;
-    m_mutex[index].lock();
-    auto it = m_cache[index].find(hash);
-    if (it == m_cache[index].end()) {
-        m_cache[index][hash] = std::make_shared<TextRenderCache>(TextRenderCache{ font, text, size, align, font->getTexture(), CoordsBuffer(), g_clock.millis() });
+    std::lock_guard<std::mutex> lock(m_mutex[index]);
+    ticks_t now = g_clock.millis();
+    while (true) {
+        auto it = m_cache[index].find(hash);
+        if (it == m_cache[index].end())
+            break;
+        TextRenderCache& cache = *it->second;
+        if (cache.fontId == font->getId() && cache.size == size && cache.align == align && cache.text == text) {
+            cache.lastUse = now;
+            m_lru[index].splice(m_lru[index].end(), m_lru[index], cache.lru);
+            g_stats.addTextLayoutLookup(true);
+            return hash;
+        }
+        hash += INDEXES; // another text with the same hash, probe the next one in this shard
     }
-    m_mutex[index].unlock();
+
+    m_lru[index].push_back(hash);
+    auto cache = std::make_shared<TextRenderCache>(TextRenderCache{ font, text, size, align, font->getTexture(), font->isSdf(), CoordsBuffer(), Rect(), now, font->getId(), sizeof(TextRenderCache) + text.capacity(), std::prev(m_lru[index].end()) });
+    m_bytes[index] += cache->bytes;
+    m_cache[index].emplace(hash, cache);
+    g_stats.addTextLayoutLookup(false);
     return hash;
 }
 
+std::shared_ptr<TextRenderCache> TextRender::get(uint64_t hash)
+{
+    int index = hash % INDEXES;
+    std::lock_guard<std::mutex> lock(m_mutex[index]);
+    auto it = m_cache[index].find(hash);
+    if (it == m_cache[index].end())
+        return nullptr;
+    // replayed draw lists don't add their texts again
+    it->second->lastUse = g_clock.millis();
+    m_lru[index].splice(m_lru[index].end(), m_lru[index], it->second->lru);
+    return it->second;
+}
+
+void TextRender::layout(TextRenderCache& cache, uint64_t hash)
+{
+    ticks_t start = stdext::micros();
+    cache.font->calculateDrawTextCoords(cache.coords, cache.text, Rect(0, 0, cache.size), cache.align);
+    cache.coords.cache();
+    cache.font.reset();
+    const float* vertices = cache.coords.getVertexArray();
+    int left = std::numeric_limits<int>::max(), top = left, right = std::numeric_limits<int>::min(), bottom = right;
+    for (int i = 0, count = cache.coords.getVertexCount(); i < count; ++i) {
+        left = std::min<int>(left, std::floor(vertices[i * 2]));
+        top = std::min<int>(top, std::floor(vertices[i * 2 + 1]));
+        right = std::max<int>(right, std::ceil(vertices[i * 2]));
+        bottom = std::max<int>(bottom, std::ceil(vertices[i * 2 + 1]));
+    }
+    // a text without glyphs keeps the layout box
+    cache.bounds = right > left && bottom > top ? Rect(Point(left, top), Point(right - 1, bottom - 1)) : Rect(0, 0, cache.size);
+    // vertices and texture coords, kept on the client and in the hardware buffers
+    size_t bytes = cache.coords.getVertexCount() * 4 * sizeof(float) * 2;
+    g_stats.addTextLayout(stdext::micros() - start);
+
+    int index = hash % INDEXES;
+    std::lock_guard<std::mutex> lock(m_mutex[index]);
+    auto it = m_cache[index].find(hash);
+    if (it == m_cache[index].end() || it->second.get() != &cache) // dropped in the meantime
+        return;
+    cache.bytes += bytes;
+    m_bytes[index] += bytes;
+}
+
 void TextRender::drawText(const Rect& rect, const std::string& text, BitmapFontPtr font, const Color& color, Fw::AlignmentFlag align, bool shadow)
 {
     VALIDATE_GRAPHICS_THREAD();
@@ -76,31 +129,31 @@ void TextRender::drawText(const Rect& rect, const std::string& text, BitmapFontP
 void TextRender::drawText(const Point& pos, uint64_t hash, const Color& color, bool shadow)
 {
     VALIDATE_GRAPHICS_THREAD();
-    int index = hash % INDEXES;
-    m_mutex[index].lock();
-    auto _it = m_cache[index].find(hash);
-    if (_it == m_cache[index].end()) {
-        m_mutex[index].unlock();
+    auto it = get(hash);
+    if (!it)
         return;
-    }
-    auto it = _it->second;
-    it->lastUse = g_clock.millis();
-    m_mutex[index].unlock();
-    if (it->font) { // calculate text coords
-        it->font->calculateDrawTextCoords(it->coords, it->text, Rect(0, 0, it->size), it->align);
-        it->coords.cache();
-        it->text.clear();
-        it->font.reset();
-    }
+    if (it->font) // calculate text coords
+        layout(*it, hash);
 
     if (shadow) {
         auto shadowPos = Point(pos);
         shadowPos.x += 1;
         shadowPos.y += 1;
-        g_painter->drawText(shadowPos, it->coords, Color::black, it->texture);
+        g_painter->drawText(shadowPos, it->coords, Color::black, it->texture, it->sdf);
     }
 
-    g_painter->drawText(pos, it->coords, color, it->texture);
+    g_painter->drawText(pos, it->coords, color, it->texture, it->sdf);
+}
+
+Rect TextRender::getBounds(uint64_t hash)
+{
+    VALIDATE_GRAPHICS_THREAD();
+    auto it = get(hash);
+    if (!it)
+        return Rect();
+    if (it->font)
+        layout(*it, hash);
+    return it->bounds;
 }
 
 void TextRender::drawColoredText(const Point& pos, uint64_t hash, const std::vector<std::pair<int, Color>>& colors, bool shadow)
@@ -108,22 +161,11 @@ void TextRender::drawColoredText(const Point& pos, uint64_t hash, const std::vec
     VALIDATE_GRAPHICS_THREAD();
     if (colors.empty())
         return drawText(pos, hash, Color::white);
-    int index = hash % INDEXES;
-    m_mutex[index].lock();
-    auto _it = m_cache[index].find(hash);
-    if (_it == m_cache[index].end()) {
-        m_mutex[index].unlock();
+    auto it = get(hash);
+    if (!it)
         return;
-    }
-    auto it = _it->second;
-    it->lastUse = g_clock.millis();
-    m_mutex[index].unlock();
-    if (it->font) { // calculate text coords
-        it->font->calculateDrawTextCoords(it->coords, it->text, Rect(0, 0, it->size), it->align);
-        it->coords.cache();
-        it->text.clear();
-        it->font.reset();
-    }
-    g_painter->drawText(pos, it->coords, colors, it->texture);
+    if (it->font) // calculate text coords
+        layout(*it, hash);
+    g_painter->drawText(pos, it->coords, colors, it->texture, it->sdf);
 }
 
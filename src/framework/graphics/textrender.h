@@ -1,6 +1,7 @@
 #ifndef TEXTRENDER_H
 #define TEXTRENDER_H
 
+#include <list>
 #include <map>
 #include <mutex>
 #include "bitmapfont.h"
@@ -8,18 +9,31 @@
 #include <framework/core/clock.h>
 
 struct TextRenderCache {
-    BitmapFontPtr font;
+    BitmapFontPtr font; // only until the glyphs are laid out
     std::string text;
     Size size;
     Fw::AlignmentFlag align;
     TexturePtr texture;
+    bool sdf;
     CoordsBuffer coords;
+    Rect bounds; // area covered by the glyphs in the layout box, once laid out
     ticks_t lastUse;
+    int fontId;
+    size_t bytes;
+    std::list<uint64_t>::iterator lru;
 };
 
+// glyph layouts of drawn texts, shared by every widget, label and name drawing the same text in the same box
 class TextRender
 {
     static const int INDEXES = 10;
+    // texts used this recently are kept even over the budget, they may still be waiting in a draw queue
+    static const int KEEP_TIME = 250;
+#ifdef ANDROID
+    static const size_t BUDGET = 4 * 1024 * 1024;
+#else
+    static const size_t BUDGET = 16 * 1024 * 1024;
+#endif
 public:
     void init();
     void terminate();
@@ -28,9 +42,16 @@ public:
     void drawText(const Rect& rect, const std::string& text, BitmapFontPtr font, const Color& color = Color::white, Fw::AlignmentFlag align = Fw::AlignTopLeft, bool shadow = false);
     void drawText(const Point& pos, uint64_t hash, const Color& color, bool shadow = false);
     void drawColoredText(const Point& pos, uint64_t hash, const std::vector<std::pair<int, Color>>& colors, bool shadow = false);
+    // glyph extents relative to the layout box, invalid if the text isn't cached
+    Rect getBounds(uint64_t hash);
 
 private:
+    std::shared_ptr<TextRenderCache> get(uint64_t hash);
+    void layout(TextRenderCache& cache, uint64_t hash);
+
     std::map<uint64_t, std::shared_ptr<TextRenderCache>> m_cache[INDEXES];
+    std::list<uint64_t> m_lru[INDEXES]; // least recently used first
+    size_t m_bytes[INDEXES] = {};
     std::mutex m_mutex[INDEXES];
 };
 
@@ -60,6 +60,9 @@ public:
     bool hasMipmaps() { return m_hasMipmaps; }
     bool canCache() { return m_canCache; }
     virtual bool isAnimatedTexture() { return false; }
+    // set by whoever built the pixels, alpha other than 0 and 255 can't be composed with other textures
+    void setPartialAlpha(bool partialAlpha) { m_partialAlpha = partialAlpha; }
+    bool hasPartialAlpha() { return m_partialAlpha; }
 
     void loadTransparentPixels(const ImagePtr& image);
     bool hasTransparentPixels() const {
@@ -91,6 +94,7 @@ protected:
     bool m_buildHardwareMipmaps = false;
     bool m_needsUpdate = false;
     bool m_canCache = true;
+    bool m_partialAlpha = false;
     ImagePtr m_image;
 
     std::vector<char> m_transparentPixels; // vector of chars is better than vector of bools, silly C++
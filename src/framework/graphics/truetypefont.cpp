@@ -13,8 +13,123 @@
 #  pragma comment(lib, "gdiplus.lib")
 #endif
 
+#if __has_include(<stb_truetype.h>)
+#  define STBTT_STATIC
+#  define STB_TRUETYPE_IMPLEMENTATION
+#endif
+#include "stb_truetype.h"
+
+#ifdef STB_TRUETYPE_AVAILABLE
+// Rasterização portátil via stb_truetype, no mesmo formato de atlas do GDI+:
+// 16 colunas, origem do glifo em padX e topo da célula (ascent) em padY + yOffset.
+static bool rasterizeAtlasStb(const uint8_t* ttfData,
+                              const std::string& fontFamilyName,
+                              int pixelHeight,
+                              int firstGlyph,
+                              int lastGlyph,
+                              int spacingX,
+                              int spacingY,
+                              int yOffset,
+                              int spaceWidth,
+                              bool sdf,
+                              TrueTypeAtlasResult& out)
+{
+    // Seleciona família pelo nome (se encontrado) ou a primeira
+    int offset = -1;
+    if (!fontFamilyName.empty())
+        offset = stbtt_FindMatchingFont(ttfData, fontFamilyName.c_str(), STBTT_MACSTYLE_DONTCARE);
+    if (offset < 0)
+        offset = stbtt_GetFontOffsetForIndex(ttfData, 0);
+
+    stbtt_fontinfo info;
+    if (offset < 0 || !stbtt_InitFont(&info, ttfData, offset))
+        return false;
+
+    // GDI+ usa pixelHeight como altura do em, não como ascent - descent
+    const float scale = stbtt_ScaleForMappingEmToPixels(&info, (float)pixelHeight);
+    int ascent = 0, descent = 0, lineGap = 0;
+    stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+    const float ascentPx = ascent * scale;
+    const float descentPx = -descent * scale;
+    const float lineSpacingPx = (ascent - descent + lineGap) * scale;
+
+    // o campo de distância precisa de SDF_SPREAD pixels livres em volta do glifo
+    const int spread = sdf ? TrueTypeFont::SDF_SPREAD : 0;
+    const int padX = std::max(std::max(1, spread), spacingX);
+    const int padY = std::max(spread, spacingY);
+
+    const int columns = 16;
+    const int glyphCount = lastGlyph - firstGlyph + 1;
+    int maxGlyphW = 0;
+    for (int cp = firstGlyph; cp <= lastGlyph; ++cp) {
+        int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        stbtt_GetCodepointBitmapBox(&info, cp, scale, scale, &x0, &y0, &x1, &y1);
+        maxGlyphW = std::max(maxGlyphW, x1 - x0);
+    }
+
+    int spaceAdvance = 0, spaceBearing = 0;
+    stbtt_GetCodepointHMetrics(&info, ' ', &spaceAdvance, &spaceBearing);
+    const float measuredSpaceW = spaceAdvance * scale;
+    // mesma regra do GDI+: a largura pedida vale, a medida só quando não fornecida
+    if (spaceWidth <= 0)
+        spaceWidth = std::max(3, (int)std::ceil(measuredSpaceW));
+
+    const int tileWidth = std::max(pixelHeight, maxGlyphW) + padX * 2;
+    const int tileHeight = (int)std::ceil(lineSpacingPx) + padY * 2;
+    const int rows = (glyphCount + columns - 1) / columns;
+    const int atlasWidth = columns * tileWidth;
+    const int atlasHeight = rows * tileHeight;
+    const int baseline = padY + yOffset + (int)std::round(ascentPx);
+
+    ImagePtr atlas = std::make_shared<Image>(Size(atlasWidth, atlasHeight));
+    for (int i = 0; i < glyphCount; ++i) {
+        int cp = firstGlyph + i;
+        int width = 0, height = 0, xoff = 0, yoff = 0;
+        unsigned char* bitmap;
+        if (sdf) // borda em 128, cada pixel de distância vale 128 / SDF_SPREAD
+            bitmap = stbtt_GetCodepointSDF(&info, scale, cp, spread, 128, 128.0f / spread, &width, &height, &xoff, &yoff);
+        else
+            bitmap = stbtt_GetCodepointBitmap(&info, scale, scale, cp, &width, &height, &xoff, &yoff);
+        if (!bitmap)
+            continue;
+
+        const int tileX = (i % columns) * tileWidth;
+        const int tileY = (i / columns) * tileHeight;
+        for (int y = 0; y < height; ++y) {
+            int destY = baseline + yoff + y;
+            if (destY < 0 || destY >= tileHeight)
+                continue;
+            for (int x = 0; x < width; ++x) {
+                int destX = padX + xoff + x;
+                if (destX < 0 || destX >= tileWidth)
+                    continue;
+                uint8 a = bitmap[y * width + x];
+                if (a)
+                    atlas->setPixel(tileX + destX, tileY + destY, Color((uint8)255, (uint8)255, (uint8)255, a));
+            }
+        }
+
+        if (sdf)
+            stbtt_FreeSDF(bitmap, nullptr);
+        else
+            stbtt_FreeBitmap(bitmap, nullptr);
+    }
+
+    out.image = atlas;
+    out.tileWidth = tileWidth;
+    out.tileHeight = tileHeight;
+    out.glyphHeight = (int)std::ceil(ascentPx + descentPx);
+    out.yOffset = yOffset;
+    out.spaceWidth = spaceWidth;
+    out.underlineOffset = std::max(1, pixelHeight / 6);
+    out.sdf = sdf;
+    return true;
+}
+#endif
+
+#ifdef _WIN32
 // Rasterização via GDI+ (Windows) com antialiasing e alpha.
-bool TrueTypeFont::rasterizeAtlas(const uint8_t* ttfData,
+static bool rasterizeAtlasGdiplus(const uint8_t* ttfData,
                                   int ttfSize,
                                   const std::string& fontFamilyName,
                                   int pixelHeight,
@@ -26,17 +141,8 @@ bool TrueTypeFont::rasterizeAtlas(const uint8_t* ttfData,
                                   int spaceWidth,
                                   TrueTypeAtlasResult& out)
 {
-    if (pixelHeight <= 0)
-        return false;
-
-    const int glyphCount = std::max(0, lastGlyph - firstGlyph + 1);
-    if (glyphCount <= 0)
-        return false;
+    const int glyphCount = lastGlyph - firstGlyph + 1;
 
-#ifndef _WIN32
-    // Sem GDI+, aborta em plataformas não-Windows.
-    return false;
-#else
     // Inicializa GDI+
     ULONG_PTR gdiplusToken = 0;
     Gdiplus::GdiplusStartupInput gdiplusStartupInput;
@@ -176,12 +282,47 @@ bool TrueTypeFont::rasterizeAtlas(const uint8_t* ttfData,
         out.tileHeight = tileHeight;
         out.glyphHeight = (int)std::ceil(ascentPx + descentPx);
         out.yOffset = yOffset;
-        out.spaceWidth = (int)std::ceil(measuredSpaceW);
+        out.spaceWidth = spaceWidth;
         out.underlineOffset = std::max(1, pixelHeight / 6);
         ok = true;
     } while (false);
 
     Gdiplus::GdiplusShutdown(gdiplusToken);
     return ok;
+}
+#endif
+
+bool TrueTypeFont::rasterizeAtlas(const uint8_t* ttfData,
+                                  int ttfSize,
+                                  const std::string& fontFamilyName,
+                                  int pixelHeight,
+                                  int firstGlyph,
+                                  int lastGlyph,
+                                  int spacingX,
+                                  int spacingY,
+                                  int yOffset,
+                                  int spaceWidth,
+                                  bool sdf,
+                                  TrueTypeAtlasResult& out)
+{
+    if (pixelHeight <= 0)
+        return false;
+
+    const int glyphCount = std::max(0, lastGlyph - firstGlyph + 1);
+    if (glyphCount <= 0)
+        return false;
+
+#ifdef _WIN32
+    // GDI+ continua gerando os atlas comuns no Windows
+    if (!sdf)
+        return rasterizeAtlasGdiplus(ttfData, ttfSize, fontFamilyName, pixelHeight, firstGlyph, lastGlyph,
+                                     spacingX, spacingY, yOffset, spaceWidth, out);
+#endif
+#ifdef STB_TRUETYPE_AVAILABLE
+    return rasterizeAtlasStb(ttfData, fontFamilyName, pixelHeight, firstGlyph, lastGlyph,
+                             spacingX, spacingY, yOffset, spaceWidth, sdf, out);
+#else
+    // Sem stb_truetype completo não há rasterizador portátil
+    return false;
 #endif
 }
\ No newline at end of file
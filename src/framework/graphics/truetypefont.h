@@ -1,5 +1,6 @@
 /*
- * Minimal TTF atlas builder interface. Real rasterization may use stb_truetype.
+ * Minimal TTF atlas builder interface. Glyphs are rasterized with GDI+ on Windows
+ * and with stb_truetype everywhere else, signed distance field atlases always use stb_truetype.
  */
 
 #ifndef TRUETYPEFONT_H
@@ -16,10 +17,14 @@ struct TrueTypeAtlasResult {
     int yOffset = 0;
     int spaceWidth = 0;
     int underlineOffset = 0;
+    bool sdf = false;
 };
 
 class TrueTypeFont {
 public:
+    // pixels of distance stored around each glyph of a signed distance field atlas
+    static const int SDF_SPREAD = 4;
+
     static bool rasterizeAtlas(const uint8_t* ttfData,
                                int ttfSize,
                                const std::string& fontFamilyName,
@@ -30,6 +35,7 @@ public:
                                int spacingY,
                                int yOffset,
                                int spaceWidth,
+                               bool sdf,
                                TrueTypeAtlasResult& out);
 };
 
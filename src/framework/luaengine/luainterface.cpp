@@ -25,15 +25,18 @@
 
 #include <framework/core/resourcemanager.h>
 #include <framework/util/stats.h>
+#include <framework/util/crypt.h>
 extern "C" {
 #if defined(_MSC_VER) || defined(ANDROID)
 #include <luajit/lua.h>
 #include <luajit/lualib.h>
 #include <luajit/lauxlib.h>
+#include <luajit/luajit.h>
 #else
 #include <lua.h>
 #include <lualib.h>
 #include <lauxlib.h>
+#include <luajit.h>
 #endif
 }
 
@@ -342,7 +345,10 @@ void LuaInterface::loadScript(const std::string& fileName)
 
     std::string buffer = g_resources.readFileContents(filePath);
     std::string source = std::string("@") + filePath;
-    loadBuffer(buffer, source);
+
+    ticks_t start = stdext::micros();
+    bool cached = loadCachedBuffer(buffer, source);
+    g_stats.addScriptLoad(cached, stdext::micros() - start);
 }
 
 void LuaInterface::loadFunction(const std::string& buffer, const std::string& source)
@@ -826,6 +832,49 @@ std::string LuaInterface::generateByteCode(const std::string& buffer, std::strin
     return ret;
 }
 
+bool LuaInterface::loadCachedBuffer(const std::string& buffer, const std::string& source)
+{
+    static const std::string cacheDir = "/bytecode";
+    static const std::string byteCodeSignature = "\x1bLJ";
+    static bool cacheAvailable = true;
+
+    // already compiled (encrypted data) or shipped in an archive, never replaced by files from the write dir
+    if(!cacheAvailable || stdext::starts_with(buffer, byteCodeSignature) ||
+       g_resources.isLoadedFromArchive() || g_resources.isLoadedFromMemory()) {
+        loadBuffer(buffer, source);
+        return false;
+    }
+
+    // the bytecode format depends on the LuaJIT build
+    std::string hash = g_crypt.sha1Encode(stdext::format("%s|%d|%s|", LUAJIT_VERSION, (int)sizeof(void*), source) + buffer, false);
+    std::string cacheFile = cacheDir + "/" + g_crypt.sha1Encode(source, false) + ".bc";
+
+    if(g_resources.fileExists(cacheFile)) {
+        try {
+            std::string data = g_resources.readFileContentsSafe(cacheFile);
+            if(data.size() > hash.size() && data.compare(0, hash.size(), hash) == 0) {
+                if(luaL_loadbufferx(L, data.data() + hash.size(), data.size() - hash.size(), source.c_str(), "b") == 0)
+                    return true;
+                pop(); // error message, compiled again below
+            }
+        } catch(stdext::exception&) {
+        }
+    }
+
+    loadBuffer(buffer, source);
+
+    std::string bytecode;
+    if(lua_dump(L, dumpWriter, &bytecode) != 0 || bytecode.empty())
+        return false;
+
+    if(!g_resources.directoryExists(cacheDir) && !g_resources.makeDir(cacheDir)) {
+        cacheAvailable = false;
+        return false;
+    }
+    g_resources.writeFileContents(cacheFile, hash + bytecode);
+    return false;
+}
+
 int LuaInterface::pcall(int numArgs, int numRets, int errorFuncIndex)
 {
     VALIDATE(hasIndex(-numArgs - 1));
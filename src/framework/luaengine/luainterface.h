@@ -230,6 +230,8 @@ public:
     void collectGarbage();
 
     void loadBuffer(const std::string& buffer, const std::string& source);
+    /// Loads a script from the bytecode cache in the write dir, compiles and caches it on a miss
+    bool loadCachedBuffer(const std::string& buffer, const std::string& source);
 
     std::string generateByteCode(const std::string & buffer, std::string source);
 
@@ -208,6 +208,18 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_stats", "getSleepTime", &Stats::getSleepTime, &g_stats);
     g_lua.bindSingletonFunction("g_stats", "resetSleepTime", &Stats::resetSleepTime, &g_stats);
     g_lua.bindSingletonFunction("g_stats", "getWidgetsInfo", &Stats::getWidgetsInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getLayoutInfo", &Stats::getLayoutInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getRetainedDrawInfo", &Stats::getRetainedDrawInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getInputInfo", &Stats::getInputInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getScriptLoadInfo", &Stats::getScriptLoadInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getPathResolveInfo", &Stats::getPathResolveInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getTextureResidencyInfo", &Stats::getTextureResidencyInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getOutfitCompositionInfo", &Stats::getOutfitCompositionInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getThingPoolInfo", &Stats::getThingPoolInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getTextLayoutInfo", &Stats::getTextLayoutInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getShaderInfo", &Stats::getShaderInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getMapDrawInfo", &Stats::getMapDrawInfo, &g_stats);
+    g_lua.bindSingletonFunction("g_stats", "getLightDrawInfo", &Stats::getLightDrawInfo, &g_stats);
     
     g_lua.registerSingletonClass("g_extras");
     g_lua.bindSingletonFunction("g_extras", "set", &Extras::set, &g_extras);
@@ -331,6 +343,8 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_app", "scale", &GraphicalApplication::scale, &g_app);
     g_lua.bindSingletonFunction("g_app", "setSmooth", &GraphicalApplication::setSmooth, &g_app);
     g_lua.bindSingletonFunction("g_app", "doMapScreenshot", &GraphicalApplication::doMapScreenshot, &g_app);
+    g_lua.bindSingletonFunction("g_app", "injectMouseMove", &GraphicalApplication::injectMouseMove, &g_app);
+    g_lua.bindSingletonFunction("g_app", "injectMouseWheel", &GraphicalApplication::injectMouseWheel, &g_app);
 
     // AdaptiveRenderer
     g_lua.registerSingletonClass("g_adaptiveRenderer");
@@ -496,6 +510,8 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UIWidget>("setDraggable", &UIWidget::setDraggable);
     g_lua.bindClassMemberFunction<UIWidget>("setFixedSize", &UIWidget::setFixedSize);
     g_lua.bindClassMemberFunction<UIWidget>("setClipping", &UIWidget::setClipping);
+    g_lua.bindClassMemberFunction<UIWidget>("setRetainedDraw", &UIWidget::setRetainedDraw);
+    g_lua.bindClassMemberFunction<UIWidget>("invalidateDraw", &UIWidget::invalidateDraw);
     g_lua.bindClassMemberFunction<UIWidget>("setLastFocusReason", &UIWidget::setLastFocusReason);
     g_lua.bindClassMemberFunction<UIWidget>("setAutoFocusPolicy", &UIWidget::setAutoFocusPolicy);
     g_lua.bindClassMemberFunction<UIWidget>("setAutoRepeatDelay", &UIWidget::setAutoRepeatDelay);
@@ -548,6 +564,7 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UIWidget>("isDraggable", &UIWidget::isDraggable);
     g_lua.bindClassMemberFunction<UIWidget>("isFixedSize", &UIWidget::isFixedSize);
     g_lua.bindClassMemberFunction<UIWidget>("isClipping", &UIWidget::isClipping);
+    g_lua.bindClassMemberFunction<UIWidget>("isRetainedDraw", &UIWidget::isRetainedDraw);
     g_lua.bindClassMemberFunction<UIWidget>("isDestroyed", &UIWidget::isDestroyed);
     g_lua.bindClassMemberFunction<UIWidget>("hasChildren", &UIWidget::hasChildren);
     g_lua.bindClassMemberFunction<UIWidget>("containsMarginPoint", &UIWidget::containsMarginPoint);
@@ -864,6 +881,37 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UITextEdit>("setPlaceholderAlign", &UITextEdit::setPlaceholderAlign);
     g_lua.bindClassMemberFunction<UITextEdit>("setPlaceholderFont", &UITextEdit::setPlaceholderFont);
 
+    // UIVirtualList
+    g_lua.registerClass<UIVirtualList, UIWidget>();
+    g_lua.bindClassStaticFunction<UIVirtualList>("create", []{ return std::make_shared<UIVirtualList>(); } );
+    g_lua.bindClassMemberFunction<UIVirtualList>("setItemCount", &UIVirtualList::setItemCount);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setRowStyle", &UIVirtualList::setRowStyle);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setRowHeight", &UIVirtualList::setRowHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setRowSpacing", &UIVirtualList::setRowSpacing);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setItemHeight", &UIVirtualList::setItemHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("clearItemHeights", &UIVirtualList::clearItemHeights);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setOverscan", &UIVirtualList::setOverscan);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setScrollStep", &UIVirtualList::setScrollStep);
+    g_lua.bindClassMemberFunction<UIVirtualList>("setScrollOffset", &UIVirtualList::setScrollOffset);
+    g_lua.bindClassMemberFunction<UIVirtualList>("scrollToItem", &UIVirtualList::scrollToItem);
+    g_lua.bindClassMemberFunction<UIVirtualList>("refresh", &UIVirtualList::refresh);
+    g_lua.bindClassMemberFunction<UIVirtualList>("refreshItem", &UIVirtualList::refreshItem);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemCount", &UIVirtualList::getItemCount);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowStyle", &UIVirtualList::getRowStyle);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowHeight", &UIVirtualList::getRowHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowSpacing", &UIVirtualList::getRowSpacing);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemHeight", &UIVirtualList::getItemHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemOffset", &UIVirtualList::getItemOffset);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getItemAt", &UIVirtualList::getItemAt);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getOverscan", &UIVirtualList::getOverscan);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getScrollStep", &UIVirtualList::getScrollStep);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getScrollOffset", &UIVirtualList::getScrollOffset);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getMaxScrollOffset", &UIVirtualList::getMaxScrollOffset);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getContentHeight", &UIVirtualList::getContentHeight);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowWidget", &UIVirtualList::getRowWidget);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getRowIndex", &UIVirtualList::getRowIndex);
+    g_lua.bindClassMemberFunction<UIVirtualList>("getPoolSize", &UIVirtualList::getPoolSize);
+
     g_lua.registerClass<ShaderProgram>();
     g_lua.registerClass<PainterShaderProgram>();
     g_lua.bindClassMemberFunction<PainterShaderProgram>("addMultiTexture", &PainterShaderProgram::addMultiTexture);
@@ -106,6 +106,7 @@ void OTMLNode::addChild(const OTMLNodePtr& newChild)
     if(newChild->getIndex() == 0)
         newChild->setIndex(++index);
     m_children[newChild->tag()].push_back(newChild);
+    m_childList.reset();
     newChild->lockTag();
 }
 
@@ -118,6 +119,7 @@ bool OTMLNode::removeChild(const OTMLNodePtr& oldChild)
     auto it2 = std::find(it->second.begin(), it->second.end(), oldChild);
     if(it2 != it->second.end()) {
         it->second.erase(it2);
+        m_childList.reset();
         return true;
     }
     return false;
@@ -153,21 +155,26 @@ void OTMLNode::merge(const OTMLNodePtr& node)
 void OTMLNode::clear()
 {
     m_children.clear();
+    m_childList.reset();
 }
 
-OTMLNodeList OTMLNode::children()
+OTMLNodeListView OTMLNode::children()
 {
-    OTMLNodeList ret;
+    if (m_childList)
+        return OTMLNodeListView(m_childList);
+
+    auto ret = std::make_shared<OTMLNodeList>();
     for (auto& [tag, children] : m_children) {
         for (auto& child : children) {
             if (!child->isNull())
-                ret.push_back(child);
+                ret->push_back(child);
         }
     }
-    std::sort(ret.begin(), ret.end(), [](auto& n1, auto& n2) {
+    std::sort(ret->begin(), ret->end(), [](auto& n1, auto& n2) {
         return n1->getIndex() < n2->getIndex();
     });
-    return ret;
+    m_childList = ret;
+    return OTMLNodeListView(m_childList);
 }
 
 OTMLNodePtr OTMLNode::clone()
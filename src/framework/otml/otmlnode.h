@@ -26,6 +26,22 @@
 #include "declarations.h"
 #include <framework/ui/uimanager.h>
 
+// snapshot of node children, stays valid when the node is modified during iteration
+class OTMLNodeListView
+{
+public:
+    OTMLNodeListView(const std::shared_ptr<const OTMLNodeList>& list) : m_list(list) { }
+
+    OTMLNodeList::const_iterator begin() const { return m_list->begin(); }
+    OTMLNodeList::const_iterator end() const { return m_list->end(); }
+    const OTMLNodePtr& operator[](size_t index) const { return (*m_list)[index]; }
+    size_t size() const { return m_list->size(); }
+    bool empty() const { return m_list->empty(); }
+
+private:
+    std::shared_ptr<const OTMLNodeList> m_list;
+};
+
 class OTMLNode : public std::enable_shared_from_this<OTMLNode>
 {
 public:
@@ -34,10 +50,10 @@ public:
     static OTMLNodePtr create(std::string tag = "", bool unique = false);
     static OTMLNodePtr create(std::string tag, std::string value);
 
-    std::string tag() { return m_tag; }
+    const std::string& tag() { return m_tag; }
     int size() { return m_children.size(); }
-    std::string source() { return m_source; }
-    std::string rawValue() { return m_value; }
+    const std::string& source() { return m_source; }
+    const std::string& rawValue() { return m_value; }
 
     bool isUnique() { return m_unique; }
     bool isNull() { return m_null; }
@@ -70,7 +86,7 @@ public:
     void merge(const OTMLNodePtr& node);
     void clear();
 
-    OTMLNodeList children();
+    OTMLNodeListView children();
     OTMLNodePtr clone();
 
     template<typename T = std::string>
@@ -99,6 +115,7 @@ protected:
     OTMLNode() : m_unique(false), m_null(false) { }
 
     std::unordered_map<std::string, std::vector<OTMLNodePtr>> m_children;
+    std::shared_ptr<const OTMLNodeList> m_childList; // ordered non null children, rebuilt after a change
     std::string m_tag;
     std::string m_value;
     std::string m_source;
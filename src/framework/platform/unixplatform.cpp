@@ -177,7 +177,12 @@ double Platform::getTotalSystemMemory()
 
 double Platform::getMemoryUsage()
 {
-    return 0;
+    // resident set size in bytes, like the working set size on windows
+    long pages = 0, residentPages = 0;
+    std::ifstream in("/proc/self/statm");
+    if(!(in >> pages >> residentPages))
+        return 0;
+    return (double)residentPages * sysconf(_SC_PAGESIZE);
 }
 
 std::string Platform::getOSName()
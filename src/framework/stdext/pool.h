@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2010-2017 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef STDEXT_POOL_H
+#define STDEXT_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace stdext {
+
+struct pool_counters {
+    std::atomic<uint64_t> allocations{0}; // blocks handed out
+    std::atomic<uint64_t> heap_allocations{0}; // blocks which had to come from the heap
+};
+
+inline pool_counters& get_pool_counters() { static pool_counters counters; return counters; }
+
+// free list of same sized blocks, one per thread so it needs no locking
+// a block freed by another thread than the one which allocated it just moves to that thread's list
+// the pool of an exiting thread and the blocks left on its list aren't returned to the heap
+template<std::size_t Size, std::size_t Align>
+class block_pool {
+    enum { MAX_FREE_BLOCKS = 16384 };
+    struct free_block { free_block* next; };
+    static_assert(Size >= sizeof(free_block), "block too small");
+
+public:
+    // each thread's pool is leaked rather than destroyed at thread exit, so objects released
+    // during shutdown or after their allocating thread is gone can still return their blocks
+    static block_pool& instance() { thread_local block_pool* pool = new block_pool; return *pool; }
+
+    void* allocate() {
+        get_pool_counters().allocations += 1;
+        if(m_free) {
+            free_block* block = m_free;
+            m_free = block->next;
+            m_freeCount -= 1;
+            return block;
+        }
+        get_pool_counters().heap_allocations += 1;
+        return ::operator new(Size, std::align_val_t(Align));
+    }
+
+    void deallocate(void* ptr) {
+        if(m_freeCount >= MAX_FREE_BLOCKS) {
+            ::operator delete(ptr, std::align_val_t(Align));
+            return;
+        }
+        free_block* block = static_cast<free_block*>(ptr);
+        block->next = m_free;
+        m_free = block;
+        m_freeCount += 1;
+    }
+
+private:
+    free_block* m_free = nullptr;
+    std::size_t m_freeCount = 0;
+};
+
+// allocator for std::allocate_shared, the object and its control block share one pooled block
+template<typename T>
+struct pool_allocator {
+    using value_type = T;
+
+    pool_allocator() = default;
+    template<typename U> pool_allocator(const pool_allocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        if(n != 1)
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        return static_cast<T*>(block_pool<sizeof(T), alignof(T)>::instance().allocate());
+    }
+    void deallocate(T* ptr, std::size_t n) {
+        if(n != 1)
+            return ::operator delete(ptr, std::align_val_t(alignof(T)));
+        block_pool<sizeof(T), alignof(T)>::instance().deallocate(ptr);
+    }
+
+    template<typename U> bool operator==(const pool_allocator<U>&) const { return true; }
+    template<typename U> bool operator!=(const pool_allocator<U>&) const { return false; }
+};
+
+template<typename T, typename... Args>
+std::shared_ptr<T> make_pooled(Args&&... args) {
+    return std::allocate_shared<T>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
+
+}
+
+#endif
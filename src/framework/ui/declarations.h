@@ -28,6 +28,7 @@
 class UIManager;
 class UIWidget;
 class UITextEdit;
+class UIVirtualList;
 class UILayout;
 class UIBoxLayout;
 class UIHorizontalLayout;
@@ -36,9 +37,11 @@ class UIGridLayout;
 class UIAnchor;
 class UIAnchorGroup;
 class UIAnchorLayout;
+class UICompiledStyle;
 
 using UIWidgetPtr = std::shared_ptr<UIWidget>;
 using UITextEditPtr = std::shared_ptr<UITextEdit>;
+using UIVirtualListPtr = std::shared_ptr<UIVirtualList>;
 using UILayoutPtr = std::shared_ptr<UILayout>;
 using UIBoxLayoutPtr = std::shared_ptr<UIBoxLayout>;
 using UIHorizontalLayoutPtr = std::shared_ptr<UIHorizontalLayout>;
@@ -47,6 +50,7 @@ using UIGridLayoutPtr = std::shared_ptr<UIGridLayout>;
 using UIAnchorPtr = std::shared_ptr<UIAnchor>;
 using UIAnchorGroupPtr = std::shared_ptr<UIAnchorGroup>;
 using UIAnchorLayoutPtr = std::shared_ptr<UIAnchorLayout>;
+using UICompiledStylePtr = std::shared_ptr<UICompiledStyle>;
 
 using UIWidgetList = std::deque<UIWidgetPtr>;
 using UIAnchorList = std::vector<UIAnchorPtr>;
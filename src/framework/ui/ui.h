@@ -26,6 +26,7 @@
 #include "uimanager.h"
 #include "uiwidget.h"
 #include "uitextedit.h"
+#include "uivirtuallist.h"
 #include "uilayout.h"
 #include "uihorizontallayout.h"
 #include "uiverticallayout.h"
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2010-2017 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "uicompiledstyle.h"
+#include "uitranslator.h"
+
+#include <framework/otml/otmlnode.h>
+
+static bool isSameNode(const OTMLNodePtr& a, const OTMLNodePtr& b)
+{
+    if(a->tag() != b->tag() || a->rawValue() != b->rawValue() || a->isNull() != b->isNull() || a->size() != b->size())
+        return false;
+    if(a->size() == 0)
+        return true;
+    OTMLNodeListView aChildren = a->children(), bChildren = b->children();
+    for(size_t i = 0; i < aChildren.size(); ++i) {
+        if(!isSameNode(aChildren[i], bChildren[i]))
+            return false;
+    }
+    return true;
+}
+
+UICompiledStylePtr UICompiledStyle::compile(const OTMLNodePtr& style)
+{
+    UICompiledStylePtr compiled = std::make_shared<UICompiledStyle>();
+    for(const OTMLNodePtr& node : style->children()) {
+        if(!stdext::starts_with(node->tag(), "$"))
+            continue;
+        compiled->m_nodes.push_back(node);
+
+        StateBlock block = { 0, 0, node };
+        bool match = true;
+        for(std::string stateStr : stdext::split(node->tag().substr(1), " ")) {
+            if(stateStr.length() == 0)
+                continue;
+
+            bool notstate = (stateStr[0] == '!');
+            if(notstate)
+                stateStr = stateStr.substr(1);
+
+            Fw::WidgetState state = Fw::translateState(stateStr);
+            if(state == Fw::InvalidState) {
+                // unknown states are never on
+                if(!notstate)
+                    match = false;
+                continue;
+            }
+
+            if(notstate)
+                block.notStates |= state;
+            else
+                block.states |= state;
+        }
+
+        if(!match)
+            continue;
+        compiled->m_statesMask |= block.states | block.notStates;
+        compiled->m_blocks.push_back(block);
+    }
+    return compiled;
+}
+
+bool UICompiledStyle::matches(const OTMLNodePtr& style)
+{
+    size_t index = 0;
+    for(const OTMLNodePtr& node : style->children()) {
+        if(!stdext::starts_with(node->tag(), "$"))
+            continue;
+        if(index >= m_nodes.size() || (node != m_nodes[index] && !isSameNode(node, m_nodes[index])))
+            return false;
+        ++index;
+    }
+    return index == m_nodes.size();
+}
+
+OTMLNodePtr UICompiledStyle::getStateStyle(int states)
+{
+    auto it = m_stateStyles.find(states);
+    if(it != m_stateStyles.end())
+        return it->second;
+
+    // merged once per states combination, never modified later
+    OTMLNodePtr stateStyle = OTMLNode::create();
+    for(const StateBlock& block : m_blocks) {
+        if((states & block.states) == block.states && (states & block.notStates) == 0)
+            stateStyle->merge(block.node);
+    }
+    m_stateStyles[states] = stateStyle;
+    return stateStyle;
+}
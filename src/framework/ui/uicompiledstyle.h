@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2010-2017 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef UICOMPILEDSTYLE_H
+#define UICOMPILEDSTYLE_H
+
+#include "declarations.h"
+#include <framework/otml/declarations.h>
+
+// The $state blocks of a style parsed into state masks. Styles are compiled once when
+// imported and shared by every widget created from them, the merged attributes of each
+// combination of states are cached the first time a widget needs them.
+class UICompiledStyle
+{
+public:
+    static UICompiledStylePtr compile(const OTMLNodePtr& style);
+
+    // whether the $state blocks of the style are the ones this was compiled from
+    bool matches(const OTMLNodePtr& style);
+    OTMLNodePtr getStateStyle(int states);
+    // states referred by any block, other states never change the merged attributes
+    int getStatesMask() { return m_statesMask; }
+
+private:
+    struct StateBlock {
+        int states; // states which must be set
+        int notStates; // states which must not be set
+        OTMLNodePtr node;
+    };
+
+    std::vector<OTMLNodePtr> m_nodes; // every $ block, including the ones never matched
+    std::vector<StateBlock> m_blocks;
+    std::unordered_map<int, OTMLNodePtr> m_stateStyles; // merged state blocks by widget states
+    int m_statesMask = 0;
+};
+
+#endif
@@ -23,7 +23,7 @@
 #include "uigridlayout.h"
 #include "uiwidget.h"
 
-#include <framework/core/eventdispatcher.h>
+#include "uimanager.h"
 
 UIGridLayout::UIGridLayout(UIWidgetPtr parentWidget): UILayout(parentWidget)
 {
@@ -122,8 +122,8 @@ bool UIGridLayout::internalUpdate()
     preferredHeight += parentWidget->getPaddingTop() + parentWidget->getPaddingBottom();
 
     if(m_fitChildren && preferredHeight != parentWidget->getHeight()) {
-        // must set the preferred height later
-        g_dispatcher.addEvent([=] {
+        // must set the preferred height later, once this layout finished updating
+        g_ui.addLayoutCallback([=] {
             parentWidget->setHeight(preferredHeight);
         });
     }
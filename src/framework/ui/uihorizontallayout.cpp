@@ -22,7 +22,7 @@
 
 #include "uihorizontallayout.h"
 #include "uiwidget.h"
-#include <framework/core/eventdispatcher.h>
+#include "uimanager.h"
 
 
 void UIHorizontalLayout::applyStyle(const OTMLNodePtr& styleNode)
@@ -94,8 +94,8 @@ bool UIHorizontalLayout::internalUpdate()
     preferredWidth += parentWidget->getPaddingLeft() + parentWidget->getPaddingRight();
 
     if(m_fitChildren && preferredWidth != parentWidget->getWidth()) {
-        // must set the preferred width later
-        g_dispatcher.addEvent([=] {
+        // must set the preferred width later, once this layout finished updating
+        g_ui.addLayoutCallback([=] {
             parentWidget->setWidth(preferredWidth);
         });
     }
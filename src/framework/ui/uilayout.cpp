@@ -23,7 +23,7 @@
 #include "uilayout.h"
 #include "uiwidget.h"
 
-#include <framework/core/eventdispatcher.h>
+#include "uimanager.h"
 
 void UILayout::update()
 {
@@ -63,10 +63,7 @@ void UILayout::updateLater()
     if(!getParentWidget())
         return;
 
-    auto self = static_self_cast<UILayout>();
-    g_dispatcher.addEvent([self] {
-        self->m_updateScheduled = false;
-        self->update();
-    });
+    // resolved later by the layout phase, parents first
     m_updateScheduled = true;
+    g_ui.scheduleLayoutUpdate(static_self_cast<UILayout>());
 }
@@ -62,6 +62,8 @@ protected:
     stdext::boolean<false> m_updating;
     stdext::boolean<false> m_updateScheduled;
     UIWidgetPtr m_parentWidget;
+
+    friend class UIManager;
 };
 
 #endif
@@ -23,14 +23,17 @@
 #include "uimanager.h"
 #include "ui.h"
 #include "uiwidget.h"
+#include "uicompiledstyle.h"
 
 #include <framework/otml/otml.h>
 #include <framework/graphics/graphics.h>
 #include <framework/platform/platformwindow.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/timer.h>
 #include <framework/core/application.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/util/extras.h>
+#include <framework/util/stats.h>
 
 UIManager g_ui;
 
@@ -56,8 +59,11 @@ void UIManager::terminate()
     for(auto& widget : m_pressedWidget)
         widget = nullptr;
     m_styles.clear();
+    m_compiledStyles.clear();
     m_destroyedWidgets.clear();
     m_checkEvent = nullptr;
+    m_dirtyLayouts.clear();
+    m_layoutCallbacks.clear();
     m_vars.clear();
     m_hoveredText.clear();
 }
@@ -73,28 +79,56 @@ void UIManager::resize(const Size& size)
     m_moveTimer.restart();
 }
 
+static const char* inputHookNames[] = {
+    "onKeyText",
+    "onKeyDown",
+    "onKeyPress",
+    "onKeyUp",
+    "onMousePress",
+    "onMouseRelease",
+    "onMouseMove",
+    "onMouseWheel"
+};
+
+template<typename... T>
+void UIManager::callInputHook(InputHook hook, const T&... args)
+{
+    // looked up on every event, hooks can be assigned or connected at any time
+    g_lua.getGlobalField("g_ui", inputHookNames[hook]);
+    if(g_lua.isNil()) {
+        g_lua.pop();
+        return;
+    }
+
+    AutoStat s(STATS_LUA, std::string("g_ui:") + inputHookNames[hook]);
+    int numArgs = g_lua.polymorphicPush(args...);
+    int rets = g_lua.signalCall(numArgs);
+    if(rets > 0)
+        g_lua.pop(rets);
+}
+
 void UIManager::inputEvent(const InputEvent& event)
 {
     UIWidgetList widgetList;
     switch(event.type) {
         case Fw::KeyTextInputEvent:
-            g_lua.callGlobalField("g_ui", "onKeyText", event.keyText);
+            callInputHook(InputHookKeyText, event.keyText);
             m_keyboardReceiver->propagateOnKeyText(event.keyText);
             break;
         case Fw::KeyDownInputEvent:
-            g_lua.callGlobalField("g_ui", "onKeyDown", event.keyCode, event.keyboardModifiers);
+            callInputHook(InputHookKeyDown, event.keyCode, event.keyboardModifiers);
             m_keyboardReceiver->propagateOnKeyDown(event.keyCode, event.keyboardModifiers);
             break;
         case Fw::KeyPressInputEvent:
-            g_lua.callGlobalField("g_ui", "onKeyPress", event.keyCode, event.keyboardModifiers, event.autoRepeatTicks);
+            callInputHook(InputHookKeyPress, event.keyCode, event.keyboardModifiers, event.autoRepeatTicks);
             m_keyboardReceiver->propagateOnKeyPress(event.keyCode, event.keyboardModifiers, event.autoRepeatTicks);
             break;
         case Fw::KeyUpInputEvent:
-            g_lua.callGlobalField("g_ui", "onKeyUp", event.keyCode, event.keyboardModifiers);
+            callInputHook(InputHookKeyUp, event.keyCode, event.keyboardModifiers);
             m_keyboardReceiver->propagateOnKeyUp(event.keyCode, event.keyboardModifiers);
             break;
         case Fw::MousePressInputEvent:
-            g_lua.callGlobalField("g_ui", "onMousePress", event.mousePos, event.mouseButton);
+            callInputHook(InputHookMousePress, event.mousePos, event.mouseButton);
 
             if(m_mouseReceiver->isVisible() && (event.mouseButton == Fw::MouseLeftButton || event.mouseButton == Fw::MouseTouch2 || event.mouseButton == Fw::MouseTouch3)) {
                 UIWidgetPtr pressedWidget = m_mouseReceiver->recursiveGetChildByPos(event.mousePos, false);
@@ -112,7 +146,7 @@ void UIManager::inputEvent(const InputEvent& event)
 
             break;
         case Fw::MouseReleaseInputEvent: {
-            g_lua.callGlobalField("g_ui", "onMouseRelease", event.mousePos, event.mouseButton);
+            callInputHook(InputHookMouseRelease, event.mousePos, event.mouseButton);
 
             // release dragging widget
             bool accepted = false;
@@ -144,7 +178,7 @@ void UIManager::inputEvent(const InputEvent& event)
             break;
         }
         case Fw::MouseMoveInputEvent: {
-            g_lua.callGlobalField("g_ui", "onMouseMove", event.mousePos, event.mouseMoved);
+            callInputHook(InputHookMouseMove, event.mousePos, event.mouseMoved);
 
             // start dragging when moving a pressed widget
             if(m_pressedWidget[Fw::MouseLeftButton] && m_pressedWidget[Fw::MouseLeftButton]->isDraggable() && m_draggingWidget != m_pressedWidget[Fw::MouseLeftButton]) {
@@ -178,7 +212,7 @@ void UIManager::inputEvent(const InputEvent& event)
             break;
         }
         case Fw::MouseWheelInputEvent:
-            g_lua.callGlobalField("g_ui", "onMouseWheel", event.mousePos, event.wheelDirection);
+            callInputHook(InputHookMouseWheel, event.mousePos, event.wheelDirection);
 
             m_rootWidget->propagateOnMouseEvent(event.mousePos, widgetList);
             for(const UIWidgetPtr& widget : widgetList) {
@@ -317,6 +351,108 @@ void UIManager::updateHoveredText(bool now)
     }
 }
 
+void UIManager::scheduleLayoutUpdate(const UILayoutPtr& layout)
+{
+    m_dirtyLayouts.push_back(layout);
+    if(m_layoutUpdateScheduled)
+        return;
+
+    m_layoutUpdateScheduled = true;
+    g_dispatcher.addEvent([this] { updateLayouts(); });
+}
+
+void UIManager::addLayoutCallback(const std::function<void()>& callback)
+{
+    m_layoutCallbacks.push_back(callback);
+    if(m_layoutUpdateScheduled)
+        return;
+
+    m_layoutUpdateScheduled = true;
+    g_dispatcher.addEvent([this] { updateLayouts(); });
+}
+
+void UIManager::updateLayouts()
+{
+    static constexpr int MAX_LAYOUT_PASSES = 16;
+
+    AutoStat s(STATS_MAIN, "UIManager::updateLayouts");
+
+    auto getDepth = [](const UILayoutPtr& layout) {
+        int depth = 0;
+        for(UIWidgetPtr widget = layout->getParentWidget(); widget; widget = widget->getParent())
+            ++depth;
+        return depth;
+    };
+
+    // every pass sweeps the dirty layouts parents first, layouts dirtied deeper than the one
+    // being updated join the current pass, the others (parents fitting their children) wait for the next one
+    int passes = 0;
+    int updates = 0;
+    std::vector<UILayoutPtr> nextPass;
+    std::multimap<int, UILayoutPtr> queue;
+    while(!m_dirtyLayouts.empty() || !m_layoutCallbacks.empty()) {
+        if(passes == MAX_LAYOUT_PASSES) {
+            static Timer reportTimer;
+            static bool reported = false;
+            if(!reported || reportTimer.ticksElapsed() > 5000) {
+                std::stringstream ss;
+                ss << "Layout cycle detected, " << m_dirtyLayouts.size() << " layouts are still dirty after " << passes << " passes:";
+                for(auto& layout : m_dirtyLayouts) {
+                    if(ss.str().size() > 512)
+                        break;
+                    UIWidgetPtr widget = layout->getParentWidget();
+                    ss << " " << (widget ? widget->getId() : "?");
+                }
+                g_logger.error(ss.str());
+                reportTimer.restart();
+                reported = true;
+            }
+            // leave the rest for the next frame
+            g_dispatcher.scheduleEvent([this] { updateLayouts(); }, 0);
+            g_stats.addLayoutPhase(passes, updates);
+            return;
+        }
+        passes++;
+
+        int currentDepth = -1;
+        do {
+            // fit-children resizes requested by the last updated layout
+            if(!m_layoutCallbacks.empty()) {
+                std::vector<std::function<void()>> callbacks;
+                callbacks.swap(m_layoutCallbacks);
+                for(auto& callback : callbacks)
+                    callback();
+            }
+
+            for(auto& layout : m_dirtyLayouts) {
+                int depth = getDepth(layout);
+                if(depth > currentDepth)
+                    queue.emplace(depth, layout);
+                else
+                    nextPass.push_back(layout);
+            }
+            m_dirtyLayouts.clear();
+            if(queue.empty())
+                break;
+
+            auto it = queue.begin();
+            currentDepth = it->first;
+            UILayoutPtr layout = it->second;
+            queue.erase(it);
+
+            layout->m_updateScheduled = false;
+            layout->update();
+            updates++;
+        } while(true);
+
+        m_dirtyLayouts.swap(nextPass);
+    }
+
+    m_layoutUpdateScheduled = false;
+
+    g_stats.addLayoutPhase(passes, updates);
+}
+
 void UIManager::onWidgetAppear(const UIWidgetPtr& widget)
 {
     if (widget->containsPoint(g_window.getMousePosition())) {
@@ -386,6 +522,7 @@ void UIManager::onWidgetDestroy(const UIWidgetPtr& widget)
 void UIManager::clearStyles()
 {
     m_styles.clear();
+    m_compiledStyles.clear();
 }
 
 bool UIManager::importStyle(std::string file)
@@ -466,6 +603,7 @@ void UIManager::importStyleFromOTML(const OTMLNodePtr& styleNode)
         style->merge(styleNode);
         style->setTag(name);
         m_styles[name] = style;
+        m_compiledStyles[name] = UICompiledStyle::compile(style);
     }
 }
 
@@ -486,6 +624,21 @@ OTMLNodePtr UIManager::getStyle(const std::string& styleName)
     return nullptr;
 }
 
+UICompiledStylePtr UIManager::getCompiledStyle(const std::string& styleName)
+{
+    auto it = m_compiledStyles.find(styleName);
+    if(it != m_compiledStyles.end())
+        return it->second;
+
+    // styles defined automatically by getStyle aren't imported
+    auto styleIt = m_styles.find(styleName);
+    if(styleIt == m_styles.end())
+        return nullptr;
+    UICompiledStylePtr compiled = UICompiledStyle::compile(styleIt->second);
+    m_compiledStyles[styleName] = compiled;
+    return compiled;
+}
+
 std::string UIManager::getStyleClass(const std::string& styleName)
 {
     OTMLNodePtr style = getStyle(styleName);
@@ -45,12 +45,17 @@ public:
     void updateHoveredWidget(bool now = false);
     void updateHoveredText(bool now = false);
 
+    void scheduleLayoutUpdate(const UILayoutPtr& layout);
+    void addLayoutCallback(const std::function<void()>& callback);
+    void updateLayouts();
+
     void clearStyles();
     bool importStyle(std::string file);
     bool importStyleFromString(std::string data);
     void importStyleFromOTML(const OTMLNodePtr& styleNode);
     void mergeStyle(std::string file, const UIWidgetPtr& widget);
     OTMLNodePtr getStyle(const std::string& styleName);
+    UICompiledStylePtr getCompiledStyle(const std::string& styleName);
     std::string getStyleClass(const std::string& styleName);
 
     UIWidgetPtr loadUIFromString(const std::string& data, const UIWidgetPtr& parent);
@@ -111,6 +116,21 @@ protected:
     friend class UIWidget;
 
 private:
+    enum InputHook {
+        InputHookKeyText = 0,
+        InputHookKeyDown,
+        InputHookKeyPress,
+        InputHookKeyUp,
+        InputHookMousePress,
+        InputHookMouseRelease,
+        InputHookMouseMove,
+        InputHookMouseWheel,
+        InputHookLast
+    };
+
+    template<typename... T>
+    void callInputHook(InputHook hook, const T&... args);
+
     UIWidgetPtr m_rootWidget;
     UIWidgetPtr m_mouseReceiver;
     UIWidgetPtr m_keyboardReceiver;
@@ -121,7 +141,11 @@ private:
     stdext::boolean<false> m_hoverUpdateScheduled;
     stdext::boolean<false> m_hoverTextUpdateScheduled;
     stdext::boolean<false> m_drawDebugBoxes;
+    stdext::boolean<false> m_layoutUpdateScheduled;
+    std::vector<UILayoutPtr> m_dirtyLayouts;
+    std::vector<std::function<void()>> m_layoutCallbacks;
     std::unordered_map<std::string, OTMLNodePtr> m_styles;
+    std::unordered_map<std::string, UICompiledStylePtr> m_compiledStyles; // state blocks of m_styles, compiled when imported
     OTUIVars m_vars;
     UIWidgetList m_destroyedWidgets;
     ScheduledEventPtr m_checkEvent;
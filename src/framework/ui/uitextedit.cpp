@@ -90,6 +90,9 @@ void UITextEdit::drawSelf(Fw::DrawPane drawPane)
     if(glyphsMustRecache)
         m_glyphsMustRecache = false;
 
+    // distance field glyphs only look like text through the sdf text program
+    bool sdf = m_font->isSdf();
+
     if(m_color != Color::alpha) {
         if(glyphsMustRecache) {
             m_glyphsTextCoordsBuffer.clear();
@@ -98,7 +101,12 @@ void UITextEdit::drawSelf(Fw::DrawPane drawPane)
                     m_glyphsTextCoordsBuffer.addRect(m_glyphsCoords[i], m_glyphsTexCoords[i]);
             }
         }
-        if (m_drawTextColors.empty()) {
+        if (sdf) {
+            std::vector<std::pair<int, Color>> colors = m_drawTextColors;
+            if (colors.empty())
+                colors.push_back(std::make_pair(m_glyphsTextCoordsBuffer.getVertexCount() / 6, m_color));
+            g_drawQueue->addSdfTextureCoords(m_glyphsTextCoordsBuffer, texture, colors);
+        } else if (m_drawTextColors.empty()) {
             g_drawQueue->addTextureCoords(m_glyphsTextCoordsBuffer, texture, m_color);
         } else {
             if (m_drawTextColors.size() == 1) { // optimization for 1 color
@@ -119,7 +127,10 @@ void UITextEdit::drawSelf(Fw::DrawPane drawPane)
                 m_glyphsSelectCoordsBuffer.addRect(m_glyphsCoords[i], m_glyphsTexCoords[i]);
         }
         g_drawQueue->addFillCoords(m_glyphsSelectCoordsBuffer, m_selectionBackgroundColor);
-        g_drawQueue->addTextureCoords(m_glyphsSelectCoordsBuffer, texture, m_selectionColor);
+        if (sdf)
+            g_drawQueue->addSdfTextureCoords(m_glyphsSelectCoordsBuffer, texture, {std::make_pair(m_glyphsSelectCoordsBuffer.getVertexCount() / 6, m_selectionColor)});
+        else
+            g_drawQueue->addTextureCoords(m_glyphsSelectCoordsBuffer, texture, m_selectionColor);
     }
 
     // render cursor
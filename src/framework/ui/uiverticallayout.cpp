@@ -22,7 +22,7 @@
 
 #include "uiverticallayout.h"
 #include "uiwidget.h"
-#include <framework/core/eventdispatcher.h>
+#include "uimanager.h"
 
 void UIVerticalLayout::applyStyle(const OTMLNodePtr& styleNode)
 {
@@ -96,8 +96,8 @@ bool UIVerticalLayout::internalUpdate()
     preferredHeight += parentWidget->getPaddingTop() + parentWidget->getPaddingBottom();
 
     if(m_fitChildren && preferredHeight != parentWidget->getHeight()) {
-        // must set the preferred width later
-        g_dispatcher.addEvent([=] {
+        // must set the preferred height later, once this layout finished updating
+        g_ui.addLayoutCallback([=] {
             parentWidget->setHeight(preferredHeight);
         });
     }
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2010-2017 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "uivirtuallist.h"
+#include "uimanager.h"
+
+#include <framework/otml/otmlnode.h>
+#include <framework/core/eventdispatcher.h>
+
+UIVirtualList::UIVirtualList()
+{
+    m_clipping = true;
+}
+
+void UIVirtualList::setItemCount(int count)
+{
+    count = std::max<int>(0, count);
+    if(count == m_itemCount)
+        return;
+
+    m_itemCount = count;
+    if(!m_itemHeights.empty()) {
+        m_itemHeights.resize(count, -1);
+        m_offsetsDirty = true;
+    }
+    refresh();
+}
+
+void UIVirtualList::setRowStyle(const std::string& rowStyle)
+{
+    if(rowStyle == m_rowStyle)
+        return;
+
+    m_rowStyle = rowStyle;
+    for(auto& it : m_rows)
+        it.second->destroy();
+    for(auto& row : m_pool)
+        row->destroy();
+    m_rows.clear();
+    m_pool.clear();
+    updateRows();
+}
+
+void UIVirtualList::setRowHeight(int height)
+{
+    m_rowHeight = std::max<int>(1, height);
+    m_offsetsDirty = true;
+    updateRows();
+}
+
+void UIVirtualList::setRowSpacing(int spacing)
+{
+    m_rowSpacing = std::max<int>(0, spacing);
+    m_offsetsDirty = true;
+    updateRows();
+}
+
+void UIVirtualList::setItemHeight(int index, int height)
+{
+    if(index < 1 || index > m_itemCount)
+        return;
+
+    if(m_itemHeights.empty())
+        m_itemHeights.resize(m_itemCount, -1);
+    if(m_itemHeights[index - 1] == height)
+        return;
+    m_itemHeights[index - 1] = height;
+    m_offsetsDirty = true;
+    updateRowsLater();
+}
+
+void UIVirtualList::clearItemHeights()
+{
+    m_itemHeights.clear();
+    m_itemOffsets.clear();
+    m_offsetsDirty = true;
+    updateRows();
+}
+
+void UIVirtualList::setScrollOffset(int offset)
+{
+    offset = std::max<int>(0, std::min<int>(offset, getMaxScrollOffset()));
+    // rows with pending height changes are placed right away when scrolling
+    if(offset == m_scrollOffset && !m_updateRowsScheduled)
+        return;
+
+    m_scrollOffset = offset;
+    updateRows();
+}
+
+void UIVirtualList::scrollToItem(int index)
+{
+    if(index < 1 || index > m_itemCount)
+        return;
+
+    int top = getItemOffset(index);
+    int bottom = top + getItemHeight(index) - getPaddingRect().height();
+    if(m_scrollOffset > top)
+        setScrollOffset(top);
+    else if(m_scrollOffset < bottom)
+        setScrollOffset(bottom);
+}
+
+void UIVirtualList::refresh()
+{
+    // rebind every row, the data source changed
+    for(auto& it : m_rows)
+        m_pool.push_back(it.second);
+    m_rows.clear();
+    m_scrollOffset = std::max<int>(0, std::min<int>(m_scrollOffset, getMaxScrollOffset()));
+    updateRows();
+}
+
+void UIVirtualList::refreshItem(int index)
+{
+    auto it = m_rows.find(index - 1);
+    if(it != m_rows.end())
+        bindRow(it->first, it->second);
+}
+
+int UIVirtualList::getItemHeight(int index)
+{
+    if(index < 1 || index > m_itemCount)
+        return 0;
+    if(m_itemHeights.empty() || m_itemHeights[index - 1] < 0)
+        return m_rowHeight;
+    return m_itemHeights[index - 1];
+}
+
+int UIVirtualList::getItemOffset(int index)
+{
+    index = std::max<int>(1, std::min<int>(index, m_itemCount + 1));
+    if(m_itemHeights.empty())
+        return (index - 1) * (m_rowHeight + m_rowSpacing);
+    updateOffsets();
+    return m_itemOffsets[index - 1];
+}
+
+int UIVirtualList::getItemAt(const Point& pos)
+{
+    Rect paddingRect = getPaddingRect();
+    if(!paddingRect.contains(pos))
+        return 0;
+
+    int offset = pos.y - paddingRect.top() + m_scrollOffset;
+    int index = findItem(offset);
+    if(index < 0 || offset >= getItemOffset(index + 1) + getItemHeight(index + 1))
+        return 0; // spacing between rows
+    return index + 1;
+}
+
+int UIVirtualList::getMaxScrollOffset()
+{
+    return std::max<int>(0, getContentHeight() - getPaddingRect().height());
+}
+
+int UIVirtualList::getContentHeight()
+{
+    if(m_itemCount == 0)
+        return 0;
+    return getItemOffset(m_itemCount + 1) - m_rowSpacing;
+}
+
+UIWidgetPtr UIVirtualList::getRowWidget(int index)
+{
+    auto it = m_rows.find(index - 1);
+    if(it == m_rows.end())
+        return nullptr;
+    return it->second;
+}
+
+int UIVirtualList::getRowIndex(const UIWidgetPtr& row)
+{
+    for(auto& it : m_rows) {
+        if(it.second == row)
+            return it.first + 1;
+    }
+    return 0;
+}
+
+void UIVirtualList::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
+{
+    UIWidget::onStyleApply(styleName, styleNode);
+
+    for(const OTMLNodePtr& node : styleNode->children()) {
+        if(node->tag() == "row-style")
+            setRowStyle(node->value());
+        else if(node->tag() == "row-height")
+            setRowHeight(node->value<int>());
+        else if(node->tag() == "row-spacing")
+            setRowSpacing(node->value<int>());
+        else if(node->tag() == "overscan")
+            setOverscan(node->value<int>());
+        else if(node->tag() == "scroll-step")
+            setScrollStep(node->value<int>());
+    }
+}
+
+void UIVirtualList::onGeometryChange(const Rect& oldRect, const Rect& newRect)
+{
+    UIWidget::onGeometryChange(oldRect, newRect);
+    m_scrollOffset = std::max<int>(0, std::min<int>(m_scrollOffset, getMaxScrollOffset()));
+    updateRows();
+}
+
+bool UIVirtualList::onMouseWheel(const Point& mousePos, Fw::MouseWheelDirection direction)
+{
+    if(UIWidget::onMouseWheel(mousePos, direction))
+        return true;
+
+    int step = m_scrollStep > 0 ? m_scrollStep : 3 * (m_rowHeight + m_rowSpacing);
+    int oldOffset = m_scrollOffset;
+    setScrollOffset(m_scrollOffset + (direction == Fw::MouseWheelUp ? -step : step));
+    return m_scrollOffset != oldOffset;
+}
+
+void UIVirtualList::updateOffsets()
+{
+    if(!m_offsetsDirty && m_itemOffsets.size() == (size_t)m_itemCount + 1)
+        return;
+
+    m_itemOffsets.resize(m_itemCount + 1);
+    int offset = 0;
+    for(int i = 0; i < m_itemCount; ++i) {
+        m_itemOffsets[i] = offset;
+        offset += (m_itemHeights[i] < 0 ? m_rowHeight : m_itemHeights[i]) + m_rowSpacing;
+    }
+    m_itemOffsets[m_itemCount] = offset;
+    m_offsetsDirty = false;
+}
+
+int UIVirtualList::findItem(int offset)
+{
+    // 0 based index of the item covering the offset, -1 when there is none
+    if(m_itemCount == 0 || offset < 0)
+        return -1;
+
+    if(m_itemHeights.empty())
+        return std::min<int>(offset / (m_rowHeight + m_rowSpacing), m_itemCount - 1);
+
+    updateOffsets();
+    auto it = std::upper_bound(m_itemOffsets.begin(), m_itemOffsets.begin() + m_itemCount, offset);
+    return std::distance(m_itemOffsets.begin(), it) - 1;
+}
+
+void UIVirtualList::bindRow(int index, const UIWidgetPtr& row)
+{
+    callLuaField("onBindRow", row, index + 1);
+}
+
+void UIVirtualList::updateRowsLater()
+{
+    // heights are usually set for many items in a row, the offsets are rebuilt once for all of them
+    if(m_updatingRows) {
+        m_rowsDirty = true;
+        return;
+    }
+    if(m_updateRowsScheduled)
+        return;
+
+    UIWidgetPtr self = static_self_cast<UIWidget>();
+    g_dispatcher.addEvent([self] {
+        auto list = self->static_self_cast<UIVirtualList>();
+        list->m_updateRowsScheduled = false;
+        list->updateRows();
+    });
+    m_updateRowsScheduled = true;
+}
+
+void UIVirtualList::updateRows()
+{
+    if(m_destroyed)
+        return;
+
+    // the data source may resize items or scroll while rows are being bound
+    if(m_updatingRows) {
+        m_rowsDirty = true;
+        return;
+    }
+    m_updatingRows = true;
+
+    int loops = 0;
+    do {
+        m_rowsDirty = false;
+
+        Rect paddingRect = getPaddingRect();
+        int first = 0;
+        int last = -1;
+        if(!m_rowStyle.empty() && m_itemCount > 0 && paddingRect.height() > 0) {
+            first = std::max<int>(0, findItem(m_scrollOffset) - m_overscan);
+            last = std::min<int>(m_itemCount - 1, findItem(m_scrollOffset + paddingRect.height() - 1) + m_overscan);
+        }
+
+        // recycle rows which scrolled out of the view
+        for(auto it = m_rows.begin(); it != m_rows.end();) {
+            const UIWidgetPtr& row = it->second;
+            if(row->isDestroyed() || row->getParent().get() != this) {
+                it = m_rows.erase(it);
+            } else if(it->first < first || it->first > last) {
+                m_pool.push_back(row);
+                it = m_rows.erase(it);
+            } else
+                ++it;
+        }
+
+        for(int index = first; index <= last && !m_rowsDirty; ++index) {
+            Rect rect(paddingRect.left(), paddingRect.top() + getItemOffset(index + 1) - m_scrollOffset,
+                      paddingRect.width(), getItemHeight(index + 1));
+
+            auto it = m_rows.find(index);
+            if(it != m_rows.end()) {
+                it->second->setRect(rect);
+                continue;
+            }
+
+            UIWidgetPtr row;
+            while(!row && !m_pool.empty()) {
+                row = m_pool.back();
+                m_pool.pop_back();
+                if(row->isDestroyed() || row->getParent().get() != this)
+                    row = nullptr;
+            }
+            if(!row) {
+                row = g_ui.createWidget(m_rowStyle, static_self_cast<UIWidget>());
+                if(!row)
+                    break;
+            }
+
+            m_rows[index] = row;
+            row->setRect(rect);
+            row->setVisible(true);
+            bindRow(index, row);
+        }
+    } while(m_rowsDirty && ++loops < 4);
+
+    // rows which weren't reused stay in the pool hidden
+    for(auto& row : m_pool) {
+        if(row->isExplicitlyVisible())
+            row->setVisible(false);
+    }
+
+    m_updatingRows = false;
+
+    int maxScrollOffset = getMaxScrollOffset();
+    if(m_scrollOffset != m_notifiedScrollOffset || maxScrollOffset != m_notifiedMaxScrollOffset) {
+        m_notifiedScrollOffset = m_scrollOffset;
+        m_notifiedMaxScrollOffset = maxScrollOffset;
+        callLuaField("onScrollOffsetChange", m_scrollOffset, maxScrollOffset);
+    }
+}
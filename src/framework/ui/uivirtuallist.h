@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2010-2017 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef UIVIRTUALLIST_H
+#define UIVIRTUALLIST_H
+
+#include "uiwidget.h"
+
+// Vertical list which only keeps widgets for the visible rows (plus some overscan rows).
+// Row widgets are created from the row style, recycled on scroll and bound to their
+// item through the lua field onBindRow(list, row, index). Indexes start at 1.
+// @bindclass
+class UIVirtualList : public UIWidget
+{
+public:
+    UIVirtualList();
+
+    void setItemCount(int count);
+    void setRowStyle(const std::string& rowStyle);
+    void setRowHeight(int height);
+    void setRowSpacing(int spacing);
+    void setItemHeight(int index, int height);
+    void clearItemHeights();
+    void setOverscan(int rows) { m_overscan = std::max<int>(0, rows); updateRows(); }
+    void setScrollStep(int step) { m_scrollStep = step; }
+    void setScrollOffset(int offset);
+    void scrollToItem(int index);
+    void refresh();
+    void refreshItem(int index);
+
+    int getItemCount() { return m_itemCount; }
+    std::string getRowStyle() { return m_rowStyle; }
+    int getRowHeight() { return m_rowHeight; }
+    int getRowSpacing() { return m_rowSpacing; }
+    int getItemHeight(int index);
+    int getItemOffset(int index);
+    int getItemAt(const Point& pos);
+    int getOverscan() { return m_overscan; }
+    int getScrollStep() { return m_scrollStep; }
+    int getScrollOffset() { return m_scrollOffset; }
+    int getMaxScrollOffset();
+    int getContentHeight();
+    UIWidgetPtr getRowWidget(int index);
+    int getRowIndex(const UIWidgetPtr& row);
+    int getPoolSize() { return m_rows.size() + m_pool.size(); }
+
+protected:
+    virtual void onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode);
+    virtual void onGeometryChange(const Rect& oldRect, const Rect& newRect);
+    virtual bool onMouseWheel(const Point& mousePos, Fw::MouseWheelDirection direction);
+    bool isDrawRetainable() { return true; }
+
+private:
+    void updateOffsets();
+    void updateRows();
+    void updateRowsLater();
+    void bindRow(int index, const UIWidgetPtr& row);
+    int findItem(int offset);
+
+    int m_itemCount = 0;
+    int m_rowHeight = 20;
+    int m_rowSpacing = 0;
+    int m_overscan = 2;
+    int m_scrollStep = 0;
+    int m_scrollOffset = 0;
+    std::string m_rowStyle;
+    std::vector<int> m_itemHeights; // empty while every item uses the row height
+    std::vector<int> m_itemOffsets;
+    std::map<int, UIWidgetPtr> m_rows;
+    std::vector<UIWidgetPtr> m_pool;
+    int m_notifiedScrollOffset = -1;
+    int m_notifiedMaxScrollOffset = -1;
+    stdext::boolean<false> m_offsetsDirty;
+    stdext::boolean<false> m_updatingRows;
+    stdext::boolean<false> m_rowsDirty;
+    stdext::boolean<false> m_updateRowsScheduled;
+};
+
+#endif
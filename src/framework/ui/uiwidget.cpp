@@ -24,10 +24,12 @@
 #include "uimanager.h"
 #include "uianchorlayout.h"
 #include "uitranslator.h"
+#include "uicompiledstyle.h"
 
 #include <framework/core/eventdispatcher.h>
 #include <framework/otml/otmlnode.h>
 #include <framework/graphics/graphics.h>
+#include <framework/graphics/drawqueue.h>
 #include <framework/platform/platformwindow.h>
 #include <framework/graphics/texturemanager.h>
 #include <framework/core/application.h>
@@ -36,6 +38,86 @@
 #include <framework/util/extras.h>
 #include <framework/input/mouse.h>
 
+// uniform grid of the children rects, built for widgets with many children
+struct UIChildrenGrid {
+    static constexpr int MIN_CHILDREN = 16;
+    static constexpr int MAX_CELLS = 16;
+
+    bool valid = false;
+    Rect area;
+    int columns = 0;
+    int rows = 0;
+    Size cellSize;
+    std::vector<std::vector<int>> cells; // children indexes, in children order
+    std::unordered_map<UIWidget*, int> indexes; // so a moved child finds its cells without searching the children
+
+    // area in which Rect::contains can return true, invalid if none
+    static Rect hitArea(const Rect& rect)
+    {
+        if(rect.right() == rect.left() - 1 || rect.bottom() == rect.top() - 1)
+            return Rect();
+        return Rect(Point(std::min(rect.left(), rect.right()), std::min(rect.top(), rect.bottom())),
+                    Point(std::max(rect.left(), rect.right()), std::max(rect.top(), rect.bottom())));
+    }
+
+    int cellIndex(const Point& pos) const
+    {
+        return ((pos.y - area.top()) / cellSize.height()) * columns + (pos.x - area.left()) / cellSize.width();
+    }
+
+    // returns false if the rect is outside of the grid area
+    bool update(int index, const Rect& rect, bool add)
+    {
+        Rect hit = hitArea(rect);
+        if(!hit.isValid())
+            return true;
+        if(!area.contains(hit.topLeft()) || !area.contains(hit.bottomRight()))
+            return false;
+
+        int left = (hit.left() - area.left()) / cellSize.width(), right = (hit.right() - area.left()) / cellSize.width();
+        int top = (hit.top() - area.top()) / cellSize.height(), bottom = (hit.bottom() - area.top()) / cellSize.height();
+        for(int y = top; y <= bottom; ++y) {
+            for(int x = left; x <= right; ++x) {
+                std::vector<int>& cell = cells[y * columns + x];
+                auto it = std::lower_bound(cell.begin(), cell.end(), index);
+                if(add && (it == cell.end() || *it != index))
+                    cell.insert(it, index);
+                else if(!add && it != cell.end() && *it == index)
+                    cell.erase(it);
+            }
+        }
+        return true;
+    }
+
+    void build(const UIWidgetList& children)
+    {
+        area = Rect();
+        for(const UIWidgetPtr& child : children) {
+            Rect hit = hitArea(child->getRect());
+            if(hit.isValid())
+                area = area.isValid() ? area.united(hit) : hit;
+        }
+
+        cells.clear();
+        indexes.clear();
+        valid = true;
+        if(!area.isValid()) {
+            columns = rows = 0;
+            return;
+        }
+
+        columns = rows = std::min<int>(MAX_CELLS, std::ceil(std::sqrt((float)children.size())));
+        cellSize = Size((area.width() + columns - 1) / columns, (area.height() + rows - 1) / rows);
+        cells.resize(columns * rows);
+        int index = 0;
+        indexes.reserve(children.size());
+        for(const UIWidgetPtr& child : children) {
+            indexes[child.get()] = index;
+            update(index++, child->getRect(), true);
+        }
+    }
+};
+
 UIWidget::UIWidget()
 {
     // source for stats
@@ -72,8 +154,19 @@ UIWidget::~UIWidget()
     g_stats.removeWidget(this);
 }
 
+int UIWidget::s_retainedWidgets = 0;
+uint32 UIWidget::s_unretainableDraws = 0;
+
 void UIWidget::draw(const Rect& visibleRect, Fw::DrawPane drawPane)
 {
+    if(m_retainedDraw && !g_ui.isDrawingDebugBoxes()) {
+        drawRetained(visibleRect, drawPane);
+        return;
+    }
+
+    if(s_retainedWidgets > 0 && !isDrawRetainable())
+        s_unretainableDraws += 1;
+
     size_t drawQueueStart = g_drawQueue->size();
 
     drawSelf(drawPane);
@@ -98,6 +191,69 @@ void UIWidget::draw(const Rect& visibleRect, Fw::DrawPane drawPane)
     }
 }
 
+void UIWidget::drawRetained(const Rect& visibleRect, Fw::DrawPane drawPane)
+{
+    size_t pane = (size_t)drawPane;
+    VALIDATE(pane < m_drawRecordings.size());
+
+    Rect relativeRect = visibleRect.translated(-m_rect.topLeft());
+    const auto& recording = m_drawRecordings[pane];
+    if(recording && m_drawRecordingRects[pane] == relativeRect) {
+        g_drawQueue->replay(*recording, m_rect.topLeft());
+        g_stats.addRetainedDraw(true);
+        return;
+    }
+
+    m_retainedDraw = false;
+    if(m_drawRecordingFailed & (1 << pane)) {
+        draw(visibleRect, drawPane);
+        m_retainedDraw = true;
+        return;
+    }
+
+    size_t drawQueueStart = g_drawQueue->size();
+    size_t conditionsStart = g_drawQueue->conditionsSize();
+    uint32 unretainableDraws = s_unretainableDraws;
+    g_drawQueue->beginRecording();
+    draw(visibleRect, drawPane);
+    m_drawRecordings[pane] = g_drawQueue->record(drawQueueStart, conditionsStart, m_rect.topLeft());
+    m_drawRecordingRects[pane] = relativeRect;
+    m_retainedDraw = true;
+
+    // subtree contains widgets drawing something else than their properties
+    if(!isDrawRetainable() || unretainableDraws != s_unretainableDraws)
+        m_drawRecordings[pane].reset();
+    if(!m_drawRecordings[pane])
+        m_drawRecordingFailed |= (1 << pane);
+    g_stats.addRetainedDraw(false);
+}
+
+void UIWidget::setRetainedDraw(bool retained)
+{
+    if(m_retainedDraw == retained)
+        return;
+    m_retainedDraw = retained;
+    s_retainedWidgets += retained ? 1 : -1;
+    resetDrawRecordings();
+}
+
+void UIWidget::invalidateDraw()
+{
+    if(s_retainedWidgets == 0)
+        return;
+    for(UIWidget* widget = this; widget; widget = widget->m_parent.get()) {
+        if(widget->m_retainedDraw)
+            widget->resetDrawRecordings();
+    }
+}
+
+void UIWidget::resetDrawRecordings()
+{
+    for(auto& recording : m_drawRecordings)
+        recording.reset();
+    m_drawRecordingFailed = 0;
+}
+
 void UIWidget::drawSelf(Fw::DrawPane drawPane)
 {
     if(drawPane != Fw::ForegroundPane)
@@ -164,6 +320,8 @@ void UIWidget::addChild(const UIWidgetPtr& child)
 
     m_children.push_back(child);
     child->setParent(static_self_cast<UIWidget>());
+    updateChildIdIndex(child.get(), true);
+    invalidateChildrenGrid();
 
     // otml extension
     std::string widgetId = child->getId();
@@ -239,6 +397,8 @@ void UIWidget::insertChild(int index, const UIWidgetPtr& child)
     auto it = m_children.begin() + index;
     m_children.insert(it, child);
     child->setParent(static_self_cast<UIWidget>());
+    updateChildIdIndex(child.get(), true);
+    invalidateChildrenGrid();
 
     // create default layout if needed
     if(!m_layout)
@@ -270,6 +430,8 @@ void UIWidget::removeChild(UIWidgetPtr child)
 
         auto it = std::find(m_children.begin(), m_children.end(), child);
         m_children.erase(it);
+        updateChildIdIndex(child.get(), false);
+        invalidateChildrenGrid();
 
         auto shortcut = m_childrenShortcuts.find(child);
         if (shortcut != m_childrenShortcuts.end()) {
@@ -434,6 +596,7 @@ void UIWidget::lowerChild(UIWidgetPtr child)
 
     m_children.erase(it);
     m_children.push_front(child);
+    invalidateChildrenGrid();
     updateChildrenIndexStates();
 }
 
@@ -453,6 +616,7 @@ void UIWidget::raiseChild(UIWidgetPtr child)
     }
     m_children.erase(it);
     m_children.push_back(child);
+    invalidateChildrenGrid();
     updateChildrenIndexStates();
 }
 
@@ -481,6 +645,7 @@ void UIWidget::moveChildToIndex(const UIWidgetPtr& child, int index)
     } else {
         m_children.insert(m_children.begin() + index - 1, child);
     }
+    invalidateChildrenGrid();
 
     updateChildrenIndexStates();
     updateLayout();
@@ -496,6 +661,7 @@ void UIWidget::reorderChildren(const std::vector<UIWidgetPtr>& childrens) {
     for (size_t i = 0; i < childrens.size(); ++i) {
         m_children.push_back(childrens[i]);
     }
+    invalidateChildrenGrid();
 
     updateChildrenIndexStates();
     updateLayout();
@@ -586,6 +752,7 @@ void UIWidget::mergeStyle(const OTMLNodePtr& styleNode)
     m_style->merge(styleNode);
     m_style->setTag(name);
     m_style->setSource(source);
+    m_compiledStyle = nullptr;
     updateStyle();
 }
 
@@ -833,6 +1000,9 @@ void UIWidget::internalDestroy()
     for(const UIWidgetPtr& child : m_children)
         child->internalDestroy();
     m_children.clear();
+    m_childrenById.clear();
+    m_childrenGrid.reset();
+    setRetainedDraw(false);
 
     callLuaField("onDestroy");
 
@@ -872,6 +1042,8 @@ void UIWidget::destroyChildren()
     while (!m_children.empty()) {
         UIWidgetPtr child = m_children.front();
         m_children.pop_front();
+        updateChildIdIndex(child.get(), false);
+        invalidateChildrenGrid();
         child->setParent(nullptr);
         m_layout->removeWidget(child);
         child->destroy();
@@ -884,6 +1056,19 @@ void UIWidget::destroyChildren()
 void UIWidget::setId(const std::string& id)
 {
     if(id != m_id) {
+        for(UIWidget* parent = m_parent.get(); parent; parent = parent->m_parent.get()) {
+            if(!m_id.empty()) {
+                auto range = parent->m_childrenById.equal_range(m_id);
+                for(auto it = range.first; it != range.second; ++it) {
+                    if(it->second == this) {
+                        parent->m_childrenById.erase(it);
+                        break;
+                    }
+                }
+            }
+            if(!id.empty())
+                parent->m_childrenById.emplace(id, this);
+        }
         m_id = id;
         callLuaField("onIdChange", id);
         if (m_parent) {
@@ -961,6 +1146,12 @@ bool UIWidget::setRect(const Rect& rect)
 
     m_rect = rect;
 
+    if(m_parent)
+        m_parent->updateChildrenGrid(this, oldRect);
+
+    // children rects are absolute, a moved widget doesn't move its children by itself
+    invalidateDraw();
+
     // updates own layout
     updateLayout();
 
@@ -992,6 +1183,7 @@ void UIWidget::setStyle(const std::string& styleName)
     styleNode = styleNode->clone();
     applyStyle(styleNode);
     m_style = styleNode;
+    m_compiledStyle = nullptr;
     updateStyle();
 }
 
@@ -999,6 +1191,7 @@ void UIWidget::setStyleFromNode(const OTMLNodePtr& styleNode)
 {
     applyStyle(styleNode);
     m_style = styleNode;
+    m_compiledStyle = nullptr;
     updateStyle();
 }
 
@@ -1016,6 +1209,7 @@ void UIWidget::setVisible(bool visible)
 {
     if (m_visible != visible) {
         m_visible = visible;
+        invalidateDraw();
 
         // hiding a widget make it lose focus
         if (!visible && isFocused()) {
@@ -1040,6 +1234,7 @@ void UIWidget::setVisible(bool visible)
 void UIWidget::setAutoDraw(bool value)
 {
     m_autoDraw = value;
+    invalidateDraw();
 }
 
 void UIWidget::setOn(bool on)
@@ -1098,6 +1293,7 @@ void UIWidget::setAutoFocusPolicy(Fw::AutoFocusPolicy policy)
 void UIWidget::setVirtualOffset(const Point& offset)
 {
     m_virtualOffset = offset;
+    invalidateDraw();
     if(m_layout)
         m_layout->update();
 }
@@ -1219,18 +1415,72 @@ UIWidgetPtr UIWidget::getChildById(const std::string& childId)
     return nullptr;
 }
 
+void UIWidget::invalidateChildrenGrid()
+{
+    if(m_childrenGrid)
+        m_childrenGrid->valid = false;
+    // children were added, removed or reordered
+    invalidateDraw();
+}
+
+void UIWidget::updateChildrenGrid(UIWidget* child, const Rect& oldRect)
+{
+    if(!m_childrenGrid || !m_childrenGrid->valid)
+        return;
+
+    auto it = m_childrenGrid->indexes.find(child);
+    if(it == m_childrenGrid->indexes.end()) {
+        m_childrenGrid->valid = false;
+        return;
+    }
+
+    int index = it->second;
+    m_childrenGrid->update(index, oldRect, false);
+    if(!m_childrenGrid->update(index, child->getRect(), true))
+        m_childrenGrid->valid = false;
+}
+
+template<typename Visitor>
+void UIWidget::visitChildrenAt(const Point& pos, const Visitor& visitor)
+{
+    // visits children which may contain pos from the top most, until visitor returns true
+    if(m_children.size() < UIChildrenGrid::MIN_CHILDREN) {
+        m_childrenGrid.reset();
+        for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
+            if(visitor(*it))
+                return;
+        }
+        return;
+    }
+
+    if(!m_childrenGrid)
+        m_childrenGrid = std::make_unique<UIChildrenGrid>();
+    if(!m_childrenGrid->valid)
+        m_childrenGrid->build(m_children);
+    if(!m_childrenGrid->area.contains(pos))
+        return;
+
+    const std::vector<int>& cell = m_childrenGrid->cells[m_childrenGrid->cellIndex(pos)];
+    for(auto it = cell.rbegin(); it != cell.rend(); ++it) {
+        if(visitor(m_children[*it]))
+            return;
+    }
+}
+
 UIWidgetPtr UIWidget::getChildByPos(const Point& childPos)
 {
     if(!containsPaddingPoint(childPos))
         return nullptr;
 
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        const UIWidgetPtr& child = (*it);
-        if(child->isExplicitlyVisible() && child->containsPoint(childPos))
-            return child;
-    }
-
-    return nullptr;
+    UIWidgetPtr ret;
+    visitChildrenAt(childPos, [&](const UIWidgetPtr& child) {
+        if(child->isExplicitlyVisible() && child->containsPoint(childPos)) {
+            ret = child;
+            return true;
+        }
+        return false;
+    });
+    return ret;
 }
 
 UIWidgetPtr UIWidget::getChildByIndex(int index)
@@ -1243,15 +1493,84 @@ UIWidgetPtr UIWidget::getChildByIndex(int index)
 
 UIWidgetPtr UIWidget::recursiveGetChildById(const std::string& id)
 {
-    UIWidgetPtr widget = getChildById(id);
-    if(!widget) {
-        for(const UIWidgetPtr& child : m_children) {
-            widget = child->recursiveGetChildById(id);
-            if(widget)
+    auto range = m_childrenById.equal_range(id);
+    if(range.first == range.second)
+        return nullptr;
+
+    UIWidget* widget = range.first->second;
+    if(std::next(range.first) != range.second) {
+        // several matches, return the one found first by searching the children
+        // of a widget before the subtrees of its children, in children order
+        auto path = [this](UIWidget* child) {
+            std::vector<UIWidget*> ret;
+            for(; child != this; child = child->m_parent.get())
+                ret.push_back(child);
+            std::reverse(ret.begin(), ret.end());
+            return ret;
+        };
+        std::vector<UIWidget*> bestPath = path(widget);
+        for(auto it = std::next(range.first); it != range.second; ++it) {
+            std::vector<UIWidget*> otherPath = path(it->second);
+            UIWidget* parent = this;
+            for(size_t i = 0; ; ++i) {
+                bool isBest = (i + 1 == bestPath.size());
+                bool isOther = (i + 1 == otherPath.size());
+                if(bestPath[i] == otherPath[i]) { // the shorter path is a parent of the longer one
+                    if(isBest)
+                        break;
+                    if(isOther) {
+                        widget = it->second;
+                        bestPath = std::move(otherPath);
+                        break;
+                    }
+                    parent = bestPath[i];
+                    continue;
+                }
+                bool otherFirst = isOther && !isBest;
+                if(isOther == isBest) {
+                    for(const UIWidgetPtr& child : parent->m_children) {
+                        if(child.get() == bestPath[i])
+                            break;
+                        if(child.get() == otherPath[i]) {
+                            otherFirst = true;
+                            break;
+                        }
+                    }
+                }
+                if(otherFirst) {
+                    widget = it->second;
+                    bestPath = std::move(otherPath);
+                }
                 break;
+            }
+        }
+    }
+    return widget->static_self_cast<UIWidget>();
+}
+
+void UIWidget::updateChildIdIndex(UIWidget* child, bool add)
+{
+    std::vector<std::pair<std::string, UIWidget*>> ids(child->m_childrenById.begin(), child->m_childrenById.end());
+    if(!child->m_id.empty())
+        ids.emplace_back(child->m_id, child);
+    if(ids.empty())
+        return;
+
+    for(UIWidget* parent = this; parent; parent = parent->m_parent.get()) {
+        for(const auto& id : ids) {
+            if(add) {
+                parent->m_childrenById.emplace(id.first, id.second);
+                continue;
+            }
+            auto range = parent->m_childrenById.equal_range(id.first);
+            for(auto it = range.first; it != range.second; ++it) {
+                if(it->second == id.second) {
+                    parent->m_childrenById.erase(it);
+                    break;
+                }
+            }
         }
     }
-    return widget;
 }
 
 UIWidgetPtr UIWidget::recursiveGetChildByPos(const Point& childPos, bool wantsPhantom)
@@ -1262,17 +1581,18 @@ UIWidgetPtr UIWidget::recursiveGetChildByPos(const Point& childPos, bool wantsPh
     if (isPixelTesting() && isPixelTransparent(childPos))
         return nullptr;
 
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        const UIWidgetPtr& child = (*it);
+    UIWidgetPtr ret;
+    visitChildrenAt(childPos, [&](const UIWidgetPtr& child) {
         if(child->isExplicitlyVisible() && child->containsPoint(childPos)) {
             UIWidgetPtr subChild = child->recursiveGetChildByPos(childPos, wantsPhantom);
             if(subChild)
-                return subChild;
+                ret = subChild;
             else if(wantsPhantom || !child->isPhantom() && (!child->isPixelTesting() || !child->isPixelTransparent(childPos)))
-                return child;
+                ret = child;
         }
-    }
-    return nullptr;
+        return !!ret;
+    });
+    return ret;
 }
 
 UIWidgetList UIWidget::recursiveGetChildren()
@@ -1293,15 +1613,15 @@ UIWidgetList UIWidget::recursiveGetChildrenByPos(const Point& childPos)
     if(!containsPaddingPoint(childPos))
         return children;
 
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        const UIWidgetPtr& child = (*it);
+    visitChildrenAt(childPos, [&](const UIWidgetPtr& child) {
         if(child->isExplicitlyVisible() && child->containsPoint(childPos)) {
             UIWidgetList subChildren = child->recursiveGetChildrenByPos(childPos);
             if(!subChildren.empty())
                 children.insert(children.end(), subChildren.begin(), subChildren.end());
             children.push_back(child);
         }
-    }
+        return false;
+    });
     return children;
 }
 
@@ -1490,6 +1810,32 @@ void UIWidget::updateChildrenIndexStates()
     }
 }
 
+static std::string styleAttributeTag(const OTMLNodePtr& node)
+{
+    std::string tag = node->tag();
+    if(!tag.empty() && tag[0] == '!')
+        return tag.substr(1);
+    return tag;
+}
+
+static OTMLNodePtr findStyleAttribute(const OTMLNodePtr& style, const std::string& tag)
+{
+    for(const OTMLNodePtr& node : style->children()) {
+        if(styleAttributeTag(node) == tag)
+            return node;
+    }
+    return nullptr;
+}
+
+static bool isSameStyleAttribute(const OTMLNodePtr& a, const OTMLNodePtr& b)
+{
+    if(a->rawValue() != b->rawValue() || a->isNull() != b->isNull())
+        return false;
+    if(!a->hasChildren() && !b->hasChildren())
+        return true;
+    return a->emit() == b->emit();
+}
+
 void UIWidget::updateStyle()
 {
     if(m_destroyed)
@@ -1508,49 +1854,48 @@ void UIWidget::updateStyle()
     if(!m_style)
         return;
 
-    OTMLNodePtr newStateStyle = OTMLNode::create();
+    // after a style change every state attribute has to be applied again
+    bool styleChanged = !m_compiledStyle;
+    if(styleChanged)
+        compileStyle();
+
+    OTMLNodePtr newStateStyle = m_compiledStyle->getStateStyle(m_states & m_compiledStyle->getStatesMask());
+    OTMLNodePtr changedStyle = OTMLNode::create(newStateStyle->tag());
+    changedStyle->setSource(newStateStyle->source());
 
     // copy only the changed styles from default style
     if(m_stateStyle) {
-        for(OTMLNodePtr node : m_stateStyle->children()) {
-            if(OTMLNodePtr otherNode = m_style->get(node->tag()))
-                newStateStyle->addChild(otherNode->clone());
+        for(const OTMLNodePtr& node : m_stateStyle->children()) {
+            std::string tag = styleAttributeTag(node);
+            if(findStyleAttribute(newStateStyle, tag))
+                continue;
+            if(OTMLNodePtr otherNode = m_style->get(tag))
+                changedStyle->addChild(otherNode->clone());
         }
     }
 
-    // checks for states combination
-    for(const OTMLNodePtr& style : m_style->children()) {
-        if(stdext::starts_with(style->tag(), "$")) {
-            std::string statesStr = style->tag().substr(1);
-            std::vector<std::string> statesSplit = stdext::split(statesStr, " ");
-
-            bool match = true;
-            for(std::string stateStr : statesSplit) {
-                if(stateStr.length() == 0)
-                    continue;
-
-                bool notstate = (stateStr[0] == '!');
-                if(notstate)
-                    stateStr = stateStr.substr(1);
-
-                bool stateOn = hasState(Fw::translateState(stateStr));
-                if((!notstate && !stateOn) || (notstate && stateOn))
-                    match = false;
-            }
-
-            // merge states styles
-            if(match) {
-                newStateStyle->merge(style);
-            }
+    // apply state attributes whose value changed, ! attributes are lua expressions so they're always evaluated
+    for(const OTMLNodePtr& node : newStateStyle->children()) {
+        if(!styleChanged && m_stateStyle && node->tag()[0] != '!') {
+            OTMLNodePtr oldNode = findStyleAttribute(m_stateStyle, node->tag());
+            if(oldNode && isSameStyleAttribute(oldNode, node))
+                continue;
         }
+        changedStyle->addChild(node->clone());
     }
 
-    //TODO: prevent setting already set proprieties
-
-    applyStyle(newStateStyle);
+    applyStyle(changedStyle);
     m_stateStyle = newStateStyle;
 }
 
+void UIWidget::compileStyle()
+{
+    // widgets share the compiled style they were created from, unless their own node changed its state blocks
+    m_compiledStyle = g_ui.getCompiledStyle(m_style->tag());
+    if(!m_compiledStyle || !m_compiledStyle->matches(m_style))
+        m_compiledStyle = UICompiledStyle::compile(m_style);
+}
+
 void UIWidget::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
 {
     if(m_destroyed)
@@ -59,6 +59,9 @@ struct EdgeGroup {
     T left;
 };
 
+struct UIChildrenGrid;
+struct DrawQueueRecording;
+
 // @bindclass
 class UIWidget : public LuaObject
 {
@@ -69,9 +72,15 @@ public:
 
     virtual void draw(const Rect& visibleRect, Fw::DrawPane drawPane);
 
+    void setRetainedDraw(bool retained);
+    bool isRetainedDraw() { return m_retainedDraw; }
+    void invalidateDraw();
+
 protected:
     virtual void drawSelf(Fw::DrawPane drawPane);
     virtual void drawChildren(const Rect& visibleRect, Fw::DrawPane drawPane);
+    // whether what's drawn depends only on the widget properties, widgets drawing game state must return false
+    virtual bool isDrawRetainable() { return typeid(*this) == typeid(UIWidget); }
 
     friend class UIManager;
 
@@ -97,6 +106,8 @@ protected:
     UIWidgetList m_children;
     UIWidgetList m_lockedChildren;
     std::map<UIWidgetPtr, std::string> m_childrenShortcuts;
+    std::unordered_multimap<std::string, UIWidget*> m_childrenById; // every widget with an id in the subtree
+    std::unique_ptr<UIChildrenGrid> m_childrenGrid; // children by area, for hit testing
     UIWidgetPtr m_focusedChild;
     OTMLNodePtr m_style;
     Timer m_clickTimer;
@@ -156,7 +167,7 @@ public:
     void setPhantom(bool phantom);
     void setDraggable(bool draggable);
     void setFixedSize(bool fixed);
-    void setClipping(bool clipping) { m_clipping = clipping; }
+    void setClipping(bool clipping) { m_clipping = clipping; invalidateDraw(); }
     void setLastFocusReason(Fw::FocusReason reason);
     void setAutoFocusPolicy(Fw::AutoFocusPolicy policy);
     void setAutoRepeatDelay(int delay) { m_autoRepeatDelay = delay; }
@@ -188,8 +199,18 @@ public:
     bool hasEventListener(WidgetEvents event) { return (m_events & event) != 0; }
 
 private:
+    void drawRetained(const Rect& visibleRect, Fw::DrawPane drawPane);
+    void resetDrawRecordings();
+
     stdext::boolean<false> m_updateEventScheduled;
     stdext::boolean<false> m_loadingStyle;
+    stdext::boolean<false> m_retainedDraw;
+    uint8 m_drawRecordingFailed = 0; // bit per draw pane, not retried until invalidated
+    std::array<std::unique_ptr<DrawQueueRecording>, 4> m_drawRecordings; // per draw pane
+    std::array<Rect, 4> m_drawRecordingRects; // recorded visible rect, relative to the widget position
+
+    static int s_retainedWidgets;
+    static uint32 s_unretainableDraws;
 
 
 // state managment
@@ -199,13 +220,20 @@ protected:
 
 private:
     void internalDestroy();
+    void updateChildIdIndex(UIWidget* child, bool add);
+    void invalidateChildrenGrid();
+    void updateChildrenGrid(UIWidget* child, const Rect& oldRect);
+    template<typename Visitor>
+    void visitChildrenAt(const Point& pos, const Visitor& visitor);
     void updateState(Fw::WidgetState state);
     void updateStates();
     void updateChildrenIndexStates();
     void updateStyle();
+    void compileStyle();
 
     stdext::boolean<false> m_updateStyleScheduled;
     stdext::boolean<true> m_firstOnStyle;
+    UICompiledStylePtr m_compiledStyle; // null until the current style is compiled
     OTMLNodePtr m_stateStyle;
     int m_states;
 
@@ -357,37 +385,37 @@ public:
     void setHeightOffset(int offset) { m_sizeOffset.setHeight(offset); updateLayout(); }
     void setSizeOffset(const Size& size) { m_sizeOffset = size; updateLayout(); }
     void setPosition(const Point& pos) { move(pos.x, pos.y); }
-    void setColor(const Color& color) { m_color = color; }
-    void setBackgroundColor(const Color& color) { m_backgroundColor = color; }
-    void setBackgroundOffsetX(int x) { m_backgroundRect.setX(x); }
-    void setBackgroundOffsetY(int y) { m_backgroundRect.setX(y); }
-    void setBackgroundOffset(const Point& pos) { m_backgroundRect.move(pos); }
-    void setBackgroundWidth(int width) { m_backgroundRect.setWidth(width); }
-    void setBackgroundHeight(int height) { m_backgroundRect.setHeight(height); }
-    void setBackgroundSize(const Size& size) { m_backgroundRect.resize(size); }
-    void setBackgroundRect(const Rect& rect) { m_backgroundRect = rect; }
+    void setColor(const Color& color) { m_color = color; invalidateDraw(); }
+    void setBackgroundColor(const Color& color) { m_backgroundColor = color; invalidateDraw(); }
+    void setBackgroundOffsetX(int x) { m_backgroundRect.setX(x); invalidateDraw(); }
+    void setBackgroundOffsetY(int y) { m_backgroundRect.setX(y); invalidateDraw(); }
+    void setBackgroundOffset(const Point& pos) { m_backgroundRect.move(pos); invalidateDraw(); }
+    void setBackgroundWidth(int width) { m_backgroundRect.setWidth(width); invalidateDraw(); }
+    void setBackgroundHeight(int height) { m_backgroundRect.setHeight(height); invalidateDraw(); }
+    void setBackgroundSize(const Size& size) { m_backgroundRect.resize(size); invalidateDraw(); }
+    void setBackgroundRect(const Rect& rect) { m_backgroundRect = rect; invalidateDraw(); }
     void setIcon(const std::string& iconFile);
-    void setIconColor(const Color& color) { m_iconColor = color; }
-    void setIconOffsetX(int x) { m_iconOffset.x = x; }
-    void setIconOffsetY(int y) { m_iconOffset.y = y; }
-    void setIconOffset(const Point& pos) { m_iconOffset = pos; }
-    void setIconWidth(int width) { m_iconRect.setWidth(width); }
-    void setIconHeight(int height) { m_iconRect.setHeight(height); }
-    void setIconSize(const Size& size) { m_iconRect.resize(size); }
-    void setIconRect(const Rect& rect) { m_iconRect = rect; }
-    void setIconClip(const Rect& rect) { m_iconClipRect = rect; }
-    void setIconAlign(Fw::AlignmentFlag align) { m_iconAlign = align; }
-    void setIconSmooth(bool smooth) { m_iconSmooth = smooth; }
-    void setBorderWidth(int width) { m_borderWidth.set(width); updateLayout(); }
-    void setBorderWidthTop(int width) { m_borderWidth.top = width; }
-    void setBorderWidthRight(int width) { m_borderWidth.right = width; }
-    void setBorderWidthBottom(int width) { m_borderWidth.bottom = width; }
-    void setBorderWidthLeft(int width) { m_borderWidth.left = width; }
-    void setBorderColor(const Color& color) { m_borderColor.set(color); updateLayout(); }
-    void setBorderColorTop(const Color& color) { m_borderColor.top = color; }
-    void setBorderColorRight(const Color& color) { m_borderColor.right = color; }
-    void setBorderColorBottom(const Color& color) { m_borderColor.bottom = color; }
-    void setBorderColorLeft(const Color& color) { m_borderColor.left = color; }
+    void setIconColor(const Color& color) { m_iconColor = color; invalidateDraw(); }
+    void setIconOffsetX(int x) { m_iconOffset.x = x; invalidateDraw(); }
+    void setIconOffsetY(int y) { m_iconOffset.y = y; invalidateDraw(); }
+    void setIconOffset(const Point& pos) { m_iconOffset = pos; invalidateDraw(); }
+    void setIconWidth(int width) { m_iconRect.setWidth(width); invalidateDraw(); }
+    void setIconHeight(int height) { m_iconRect.setHeight(height); invalidateDraw(); }
+    void setIconSize(const Size& size) { m_iconRect.resize(size); invalidateDraw(); }
+    void setIconRect(const Rect& rect) { m_iconRect = rect; invalidateDraw(); }
+    void setIconClip(const Rect& rect) { m_iconClipRect = rect; invalidateDraw(); }
+    void setIconAlign(Fw::AlignmentFlag align) { m_iconAlign = align; invalidateDraw(); }
+    void setIconSmooth(bool smooth) { m_iconSmooth = smooth; invalidateDraw(); }
+    void setBorderWidth(int width) { m_borderWidth.set(width); updateLayout(); invalidateDraw(); }
+    void setBorderWidthTop(int width) { m_borderWidth.top = width; invalidateDraw(); }
+    void setBorderWidthRight(int width) { m_borderWidth.right = width; invalidateDraw(); }
+    void setBorderWidthBottom(int width) { m_borderWidth.bottom = width; invalidateDraw(); }
+    void setBorderWidthLeft(int width) { m_borderWidth.left = width; invalidateDraw(); }
+    void setBorderColor(const Color& color) { m_borderColor.set(color); updateLayout(); invalidateDraw(); }
+    void setBorderColorTop(const Color& color) { m_borderColor.top = color; invalidateDraw(); }
+    void setBorderColorRight(const Color& color) { m_borderColor.right = color; invalidateDraw(); }
+    void setBorderColorBottom(const Color& color) { m_borderColor.bottom = color; invalidateDraw(); }
+    void setBorderColorLeft(const Color& color) { m_borderColor.left = color; invalidateDraw(); }
     void setMargin(int margin) { m_margin.set(margin); updateParentLayout(); }
     void setMarginHorizontal(int margin) { m_margin.right = m_margin.left = margin; updateParentLayout(); }
     void setMarginVertical(int margin) { m_margin.bottom = m_margin.top = margin; updateParentLayout(); }
@@ -402,8 +430,8 @@ public:
     void setPaddingRight(int padding) { m_padding.right = padding; updateLayout(); }
     void setPaddingBottom(int padding) { m_padding.bottom = padding; updateLayout(); }
     void setPaddingLeft(int padding) { m_padding.left = padding; updateLayout(); }
-    void setOpacity(float opacity) { m_opacity = stdext::clamp<float>(opacity, 0.0f, 1.0f); }
-    void setRotation(float degrees) { m_rotation = degrees; }
+    void setOpacity(float opacity) { m_opacity = stdext::clamp<float>(opacity, 0.0f, 1.0f); invalidateDraw(); }
+    void setRotation(float degrees) { m_rotation = degrees; invalidateDraw(); }
     void setChangeCursorImage(bool enable) { m_changeCursorImage = enable; }
     void setCursor(const std::string& cursor);
     void updatePercentSize(const Size& size);
@@ -465,7 +493,7 @@ private:
     void initImage();
     void parseImageStyle(const OTMLNodePtr& styleNode);
 
-    void updateImageCache() { m_imageMustRecache = true; }
+    void updateImageCache() { m_imageMustRecache = true; invalidateDraw(); }
     void configureBorderImage() { m_imageBordered = true; updateImageCache(); }
 
     CoordsBuffer m_imageCoordsBuffer;
@@ -490,7 +518,7 @@ protected:
     stdext::boolean<true> m_imageSmooth;
     stdext::boolean<false> m_imageAutoResize;
     EdgeGroup<int> m_imageBorder;
-    std::string m_shader;
+    int m_shader = 0;
 
 public:
     void setQRCode(const std::string& code, int border);
@@ -507,14 +535,14 @@ public:
     void setImageColor(const Color& color) { m_imageColor = color; updateImageCache(); }
     void setImageFixedRatio(bool fixedRatio) { m_imageFixedRatio = fixedRatio; updateImageCache(); }
     void setImageRepeated(bool repeated) { m_imageRepeated = repeated; updateImageCache(); }
-    void setImageSmooth(bool smooth) { m_imageSmooth = smooth; }
+    void setImageSmooth(bool smooth) { m_imageSmooth = smooth; invalidateDraw(); }
     void setImageAutoResize(bool autoResize) { m_imageAutoResize = autoResize; }
     void setImageBorderTop(int border) { m_imageBorder.top = border; configureBorderImage(); }
     void setImageBorderRight(int border) { m_imageBorder.right = border; configureBorderImage(); }
     void setImageBorderBottom(int border) { m_imageBorder.bottom = border; configureBorderImage(); }
     void setImageBorderLeft(int border) { m_imageBorder.left = border; configureBorderImage(); }
     void setImageBorder(int border) { m_imageBorder.set(border); configureBorderImage(); }
-    void setImageShader(const std::string& str) { m_shader = str; }
+    void setImageShader(const std::string& str);
 
     std::string getImageSource() { return m_imageSource; }
     Rect getImageClip() { return m_imageClipRect; }
@@ -535,7 +563,7 @@ public:
     int getImageBorderLeft() { return m_imageBorder.left; }
     int getImageTextureWidth() { return m_imageTexture ? m_imageTexture->getWidth() : 0; }
     int getImageTextureHeight() { return m_imageTexture ? m_imageTexture->getHeight() : 0; }
-    std::string getImageShader() { return m_shader; }
+    std::string getImageShader();
 
 // text related
 private:
@@ -589,7 +617,7 @@ public:
     void setTextVerticalAutoResize(bool textAutoResize) { m_textVerticalAutoResize = textAutoResize; updateText(); }
     void setTextOnlyUpperCase(bool textOnlyUpperCase) { m_textOnlyUpperCase = textOnlyUpperCase; setText(m_text); }
     void setFont(const std::string& fontName);
-    void setShadow(bool shadow) { m_shadow = shadow; }
+    void setShadow(bool shadow) { m_shadow = shadow; invalidateDraw(); }
     void setTextOverflowLength(uint16 length) { m_textOverflowLength = length; updateText(); }
     void setTextOverflowCharacter(std::string character) { m_textOverflowCharacter = character; updateText(); }
 
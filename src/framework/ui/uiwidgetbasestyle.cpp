@@ -177,6 +177,8 @@ void UIWidget::parseBaseStyle(const OTMLNodePtr& styleNode)
             setFixedSize(node->value<bool>());
         else if(node->tag() == "clipping")
             setClipping(node->value<bool>());
+        else if(node->tag() == "retained-draw")
+            setRetainedDraw(node->value<bool>());
         else if(node->tag() == "border") {
             auto split = stdext::split(node->value(true), " ");
             if(split.size() == 2) {
@@ -448,4 +450,5 @@ void UIWidget::setIcon(const std::string& iconFile)
     }
     if(m_icon && !m_iconClipRect.isValid())
         m_iconClipRect = Rect(0, 0, m_icon->getSize());
+    invalidateDraw();
 }
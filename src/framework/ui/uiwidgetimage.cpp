@@ -26,6 +26,7 @@
 #include <framework/graphics/texture.h>
 #include <framework/graphics/texturemanager.h>
 #include <framework/graphics/graphics.h>
+#include <framework/graphics/shadermanager.h>
 #include <framework/util/crypt.h>
 
 void UIWidget::initImage()
@@ -178,7 +179,7 @@ void UIWidget::drawImage(const Rect& screenCoords)
     }
 
     m_imageTexture->setSmooth(m_imageSmooth);
-    if (!m_shader.empty()) {
+    if (m_shader) {
         DrawQueueItemTextureCoords* thing = new DrawQueueItemImageWithShader(m_imageCoordsBuffer, m_imageTexture, m_imageColor, m_shader);
         g_drawQueue->add(thing);
     }
@@ -202,7 +203,18 @@ void UIWidget::setQRCode(const std::string& code, int border)
         setSize(size);
     }
 
-    m_imageMustRecache = true;
+    updateImageCache();
+}
+
+void UIWidget::setImageShader(const std::string& str)
+{
+    m_shader = g_shaders.getShaderId(str);
+    invalidateDraw();
+}
+
+std::string UIWidget::getImageShader()
+{
+    return g_shaders.getShaderName(m_shader);
 }
 
 void UIWidget::setImageSource(const std::string& source)
@@ -224,13 +236,13 @@ void UIWidget::setImageSource(const std::string& source)
 
     if (m_imageSource != source)
         m_imageSource = source;
-    m_imageMustRecache = true;
+    updateImageCache();
 }
 
 void UIWidget::setImageSourceBase64(const std::string& data) {
     if (data.size() % 4 != 0 || data.empty()) {
         m_imageTexture = nullptr;
-        m_imageMustRecache = true;
+        updateImageCache();
         return;
     }
 
@@ -248,5 +260,5 @@ void UIWidget::setImageSourceBase64(const std::string& data) {
         setSize(size);
     }
 
-    m_imageMustRecache = true;
+    updateImageCache();
 }
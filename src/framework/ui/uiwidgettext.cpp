@@ -69,6 +69,7 @@ void UIWidget::updateText()
     }
 
     m_textMustRecache = true;
+    invalidateDraw();
 }
 
 void UIWidget::parseTextStyle(const OTMLNodePtr& styleNode)
@@ -24,6 +24,13 @@ public:
         DEFINE_OPTION(debugWidgets, "Debug widgets");
 
         DEFINE_OPTION(disablePredictiveWalking, "Disable predictive walking");
+        DEFINE_OPTION(legacyDrawCache, "Legacy draw cache (no vertex buffer)");
+        DEFINE_OPTION(reorderDrawQueue, "Reorder draw queue to reduce draw cache flushes");
+        DEFINE_OPTION(legacyOtbmLoader, "Legacy OTBM loader (streamed, single-threaded)");
+        DEFINE_OPTION(legacyDatLoader, "Legacy dat loader (streamed, single-threaded)");
+        DEFINE_OPTION(legacyOutfitDraw, "Legacy outfit drawing (layers aren't composed in the atlas)");
+        DEFINE_OPTION(legacyTileDraw, "Legacy tile drawing (things classified every frame)");
+        DEFINE_OPTION(legacyLightDraw, "Legacy light drawing (every light evaluated for every tile)");
     }
 
     bool botDetection = default_value;
@@ -39,6 +46,13 @@ public:
     bool disablePredictiveWalking = false;
     bool showPredictions = false;
     bool debugWidgets = false;
+    bool legacyDrawCache = false;
+    bool reorderDrawQueue = false;
+    bool legacyOtbmLoader = false;
+    bool legacyDatLoader = false;
+    bool legacyOutfitDraw = false;
+    bool legacyTileDraw = false;
+    bool legacyLightDraw = false;
 
     int testMode = 0;
 
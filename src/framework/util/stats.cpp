@@ -4,6 +4,8 @@
 #include <iomanip>
 #include <map>
 #include <framework/stdext/time.h>
+#include <framework/stdext/pool.h>
+#include <framework/core/eventdispatcher.h>
 #include <framework/ui/uiwidget.h>
 #include <framework/ui/ui.h>
 
@@ -127,6 +129,160 @@ void Stats::clearSlow(int type) {
 }
 
 
+void Stats::addLayoutPhase(int passes, int layouts) {
+    layoutPhases += 1;
+    layoutPasses += passes;
+    laidOutWidgets += layouts;
+    lastLayoutPasses = passes;
+    lastLaidOutWidgets = layouts;
+    maxLayoutPasses = std::max(maxLayoutPasses, passes);
+    maxLaidOutWidgets = std::max(maxLaidOutWidgets, layouts);
+}
+
+std::string Stats::getLayoutInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Layout phases: " << layoutPhases << "\n";
+        ret << "Passes per frame: " << lastLayoutPasses << " (max " << maxLayoutPasses << ", total " << layoutPasses << ")\n";
+        ret << "Widgets laid out per frame: " << lastLaidOutWidgets << " (max " << maxLaidOutWidgets << ", total " << laidOutWidgets << ")\n";
+    } else {
+        ret << "Layout|" << layoutPhases << "|" << lastLayoutPasses << "|" << maxLayoutPasses << "|" << layoutPasses << "|"
+            << lastLaidOutWidgets << "|" << maxLaidOutWidgets << "|" << laidOutWidgets << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getPathResolveInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Resolved paths with " << pathProbes << " PhysFS calls, " << pathProbesAvoided << " avoided by the path cache";
+    } else {
+        ret << "Paths|" << pathProbes << "|" << pathProbesAvoided << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getTextureResidencyInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Thing textures: " << (residentTextureBytes / 1024) << " kB resident of " << (textureBudget / 1024) << " kB budget, "
+            << textureEvictions << " evictions, " << textureReloads << " reloads";
+    } else {
+        ret << "TextureResidency|" << residentTextureBytes << "|" << textureBudget << "|" << textureEvictions << "|" << textureReloads << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getScriptLoadInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Loaded " << (cachedScripts + compiledScripts) << " scripts in " << (scriptLoadTime / 1000) << " ms ("
+            << cachedScripts << " from bytecode cache, " << compiledScripts << " compiled)";
+    } else {
+        ret << "Scripts|" << cachedScripts << "|" << compiledScripts << "|" << scriptLoadTime << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getInputInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Input events: " << inputEvents << " (dispatched " << dispatchedInputEvents << ")\n";
+        ret << "Input handling time: " << (inputTime / 1000) << " ms\n";
+    } else {
+        ret << "Input|" << inputEvents << "|" << dispatchedInputEvents << "|" << inputTime << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getRetainedDrawInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Retained draw replays: " << retainedReplays << "\n";
+        ret << "Retained draw recordings: " << retainedRecordings << "\n";
+    } else {
+        ret << "RetainedDraw|" << retainedReplays << "|" << retainedRecordings << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getOutfitCompositionInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Outfits drawn: " << outfitDraws << "\n";
+        ret << "Outfit layers: " << outfitLayers << "\n";
+        ret << "Outfit draws: " << outfitQueueDraws << "\n";
+        ret << "Outfit compositions: " << outfitCompositions << "\n";
+    } else {
+        ret << "OutfitComposition|" << outfitDraws << "|" << outfitLayers << "|" << outfitQueueDraws << "|" << outfitCompositions << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getThingPoolInfo(bool pretty) {
+    stdext::pool_counters& counters = stdext::get_pool_counters();
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Pooled allocations: " << counters.allocations << "\n";
+        ret << "Pooled heap allocations: " << counters.heap_allocations << "\n";
+        ret << "Expiring things: " << expiringThings << "\n";
+        ret << "Scheduled events: " << g_dispatcher.scheduledEventsCount() << "\n";
+    } else {
+        ret << "ThingPool|" << counters.allocations << "|" << counters.heap_allocations << "|" << expiringThings << "|" << g_dispatcher.scheduledEventsCount() << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getTextLayoutInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Text layout hits: " << textLayoutHits << "\n";
+        ret << "Text layout misses: " << textLayoutMisses << "\n";
+        ret << "Text layouts: " << textLayouts << "\n";
+        ret << "Text layout time: " << textLayoutTime << " us\n";
+        ret << "Text layout evictions: " << textLayoutEvictions << "\n";
+    } else {
+        ret << "TextLayout|" << textLayoutHits << "|" << textLayoutMisses << "|" << textLayouts << "|" << textLayoutTime << "|" << textLayoutEvictions << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getShaderInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Shader draws: " << shaderDraws << "\n";
+        ret << "Shader binds: " << shaderBinds << "\n";
+        ret << "Shader name lookups: " << shaderLookups << "\n";
+    } else {
+        ret << "Shader|" << shaderDraws << "|" << shaderBinds << "|" << shaderLookups << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getMapDrawInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Map draws: " << mapDraws << "\n";
+        ret << "Map draw time: " << mapDrawTime << " us\n";
+        ret << "Tile draw list builds: " << tileDrawListBuilds << "\n";
+    } else {
+        ret << "MapDraw|" << mapDraws << "|" << mapDrawTime << "|" << tileDrawListBuilds << "\n";
+    }
+    return ret.str();
+}
+
+std::string Stats::getLightDrawInfo(bool pretty) {
+    std::stringstream ret;
+    if (pretty) {
+        ret << "Light draws: " << lightDraws << "\n";
+        ret << "Lights drawn: " << lightDrawLights << "\n";
+        ret << "Light buffer fill time: " << lightDrawTime << " us\n";
+    } else {
+        ret << "LightDraw|" << lightDraws << "|" << lightDrawLights << "|" << lightDrawTime << "\n";
+    }
+    return ret.str();
+}
+
 void Stats::addWidget(UIWidget* widget)
 {
     createdWidgets += 1;
@@ -82,6 +82,51 @@ public:
     inline void addCreature() { createdCreatures += 1; }
     inline void removeCreature() { destroyedCreatures += 1; }
 
+    void addLayoutPhase(int passes, int layouts);
+    std::string getLayoutInfo(bool pretty);
+
+    inline void addInputEvent() { inputEvents += 1; }
+    inline void addInputDispatch(uint64_t micros) { dispatchedInputEvents += 1; inputTime += micros; }
+    std::string getInputInfo(bool pretty);
+
+    inline void addPathResolve(int probes, int probesAvoided) { pathProbes += probes; pathProbesAvoided += probesAvoided; }
+    std::string getPathResolveInfo(bool pretty);
+
+    inline void addScriptLoad(bool cached, uint64_t micros) { (cached ? cachedScripts : compiledScripts) += 1; scriptLoadTime += micros; }
+    std::string getScriptLoadInfo(bool pretty);
+
+    inline void setTextureResidency(uint64_t bytes, uint64_t budget) { residentTextureBytes = bytes; textureBudget = budget; }
+    inline void addTextureEviction() { textureEvictions += 1; }
+    inline void addTextureReload() { textureReloads += 1; }
+    std::string getTextureResidencyInfo(bool pretty);
+
+    inline void addRetainedDraw(bool replayed) { if (replayed) retainedReplays += 1; else retainedRecordings += 1; }
+    std::string getRetainedDrawInfo(bool pretty);
+
+    inline void addOutfitDraw(int layers, int draws) { outfitDraws += 1; outfitLayers += layers; outfitQueueDraws += draws; }
+    inline void addOutfitComposition() { outfitCompositions += 1; }
+    std::string getOutfitCompositionInfo(bool pretty);
+
+    inline void setExpiringThings(size_t count) { expiringThings = count; }
+    std::string getThingPoolInfo(bool pretty);
+
+    inline void addTextLayoutLookup(bool hit) { if (hit) textLayoutHits += 1; else textLayoutMisses += 1; }
+    inline void addTextLayout(uint64_t time) { textLayouts += 1; textLayoutTime += time; }
+    inline void addTextLayoutEviction() { textLayoutEvictions += 1; }
+    std::string getTextLayoutInfo(bool pretty);
+
+    inline void addShaderDraw() { shaderDraws += 1; }
+    inline void addShaderBind() { shaderBinds += 1; }
+    inline void addShaderLookup() { shaderLookups += 1; }
+    std::string getShaderInfo(bool pretty);
+
+    inline void addMapDraw(uint64_t time) { mapDraws += 1; mapDrawTime += time; }
+    inline void addTileDrawListBuild() { tileDrawListBuilds += 1; }
+    std::string getMapDrawInfo(bool pretty);
+
+    inline void addLightDraw(size_t lights, uint64_t time) { lightDraws += 1; lightDrawLights += lights; lightDrawTime += time; }
+    std::string getLightDrawInfo(bool pretty);
+
 private:
     struct {
         StatsMap data;
@@ -94,10 +139,50 @@ private:
     int destroyedWidgets = 0;
     int createdTextures = 0;
     int destroyedTextures = 0;
-    int createdThings = 0;
-    int destroyedThings = 0;
+    std::atomic<int> createdThings{0};
+    std::atomic<int> destroyedThings{0};
     int createdCreatures = 0;
     int destroyedCreatures = 0;
+    int layoutPhases = 0;
+    int layoutPasses = 0;
+    int laidOutWidgets = 0;
+    int lastLayoutPasses = 0;
+    int lastLaidOutWidgets = 0;
+    int maxLayoutPasses = 0;
+    int maxLaidOutWidgets = 0;
+    int retainedReplays = 0;
+    int inputEvents = 0;
+    std::atomic<uint64_t> pathProbes{0};
+    std::atomic<uint64_t> pathProbesAvoided{0};
+    int cachedScripts = 0;
+    int compiledScripts = 0;
+    uint64_t scriptLoadTime = 0;
+    int dispatchedInputEvents = 0;
+    uint64_t inputTime = 0;
+    int retainedRecordings = 0;
+    uint64_t residentTextureBytes = 0;
+    uint64_t textureBudget = 0;
+    int textureEvictions = 0;
+    int textureReloads = 0;
+    std::atomic<int> outfitDraws{0};
+    std::atomic<int> outfitLayers{0};
+    std::atomic<int> outfitQueueDraws{0};
+    std::atomic<int> outfitCompositions{0};
+    size_t expiringThings = 0;
+    std::atomic<int> textLayoutHits{0};
+    std::atomic<int> textLayoutMisses{0};
+    std::atomic<int> textLayouts{0};
+    std::atomic<uint64_t> textLayoutTime{0};
+    std::atomic<int> textLayoutEvictions{0};
+    std::atomic<int> shaderDraws{0};
+    std::atomic<int> shaderBinds{0};
+    std::atomic<int> shaderLookups{0};
+    int mapDraws = 0;
+    uint64_t mapDrawTime = 0;
+    int tileDrawListBuilds = 0;
+    std::atomic<int> lightDraws{0};
+    std::atomic<uint64_t> lightDrawLights{0};
+    std::atomic<uint64_t> lightDrawTime{0};
     std::mutex m_mutex;
 };
 
@@ -1,3 +1,7 @@
+-- cold start compiles every script, warm start loads them from the bytecode cache
+g_logger.info("[TEST] " .. g_stats.getScriptLoadInfo(true))
+g_logger.info("[TEST] " .. g_stats.getPathResolveInfo(true))
+
 -- First test
 Test.Test("First test, maximize and hide entergame", function(test, wait, ss, fail)
     wait(1000)
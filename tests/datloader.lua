@@ -0,0 +1,72 @@
+Test.Test("Dat loader", function(test, wait, ss, fail)
+    local legacy = g_extras.get("legacyDatLoader")
+    local previousVersion = g_game.getClientVersion()
+    local categories = {ThingCategoryItem, ThingCategoryCreature, ThingCategoryEffect, ThingCategoryMissile}
+
+    local function snapshot()
+        local types = {}
+        for _, category in ipairs(categories) do
+            for id, thingType in ipairs(g_things.getThingTypes(category)) do
+                local size = thingType:getSize()
+                types[category .. ":" .. id] = table.concat({
+                    thingType:getId(), size.width, size.height, thingType:getExactSize(), thingType:getLayers(),
+                    thingType:getNumPatternX(), thingType:getNumPatternY(), thingType:getNumPatternZ(),
+                    thingType:getAnimationPhases(), thingType:getElevation(), thingType:getMinimapColor(),
+                    tostring(thingType:isGround()), tostring(thingType:isStackable()), tostring(thingType:isMarketable()),
+                    table.concat(thingType:getSprites(), ",")
+                }, "|")
+            end
+        end
+        return types
+    end
+
+    local function load(datPath, useLegacy)
+        g_extras.set("legacyDatLoader", useLegacy)
+        local start = g_clock.micros()
+        if not g_things.loadDat(datPath) then
+            fail("can't load " .. datPath)
+        end
+        return g_clock.micros() - start
+    end
+
+    for _, version in ipairs({860, 1098}) do
+        test(function()
+            local datPath = "/things/" .. version .. "/Tibia"
+            if not g_resources.fileExists(datPath .. ".dat") then
+                g_logger.info("[TEST] Dat loader: no " .. version .. " dat available, skipping")
+                return
+            end
+            g_game.setClientVersion(version)
+
+            local legacyTime = load(datPath, true)
+            local expected = snapshot()
+            local legacyCategories = g_things.getMarketCategories()
+            local parallelTime = load(datPath, false)
+            local result = snapshot()
+            g_extras.set("legacyDatLoader", legacy)
+
+            g_logger.info(string.format("[TEST] Dat loader %i: legacy %.2f ms, parallel %.2f ms",
+                          version, legacyTime / 1000, parallelTime / 1000))
+            for key, value in pairs(expected) do
+                if result[key] ~= value then
+                    fail("thing type " .. key .. " differs: " .. tostring(result[key]) .. ", expected " .. value)
+                    break
+                end
+            end
+            for key, value in pairs(result) do
+                if not expected[key] then
+                    fail("unexpected thing type " .. key)
+                    break
+                end
+            end
+            if #legacyCategories ~= #g_things.getMarketCategories() then
+                fail("market categories differ")
+            end
+        end)
+    end
+
+    test(function()
+        -- game_features reloads the things of the restored version through game_things
+        g_game.setClientVersion(previousVersion)
+    end)
+end)
@@ -0,0 +1,112 @@
+Test.Test("Pooled effects", function(test, wait, ss, fail)
+    local BURST = 10000
+    local tiles = {}
+    local before = {}
+    local bursts = {}
+
+    local function counters()
+        local allocations, heapAllocations, expiring, events = g_stats.getThingPoolInfo(false):match("^ThingPool|(%d+)|(%d+)|(%d+)|(%d+)")
+        return {allocations = tonumber(allocations), heapAllocations = tonumber(heapAllocations),
+                expiring = tonumber(expiring), events = tonumber(events)}
+    end
+
+    local function effectsOnTiles()
+        local count = 0
+        for _, tile in ipairs(tiles) do
+            count = count + #tile:getEffects()
+        end
+        return count
+    end
+
+    local function burst()
+        before = counters()
+        local start = g_clock.micros()
+        for i=1,BURST do
+            local effect = Effect.create()
+            effect:setId(1 + i % 20)
+            g_map.addThing(effect, tiles[i % #tiles + 1]:getPosition(), -1)
+        end
+        local time = g_clock.micros() - start
+        local after = counters()
+        table.insert(bursts, {time = time, allocations = after.allocations - before.allocations,
+                              heapAllocations = after.heapAllocations - before.heapAllocations,
+                              events = after.events - before.events})
+    end
+
+    test(function()
+        EnterGame.hide()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+        g_game.playRecord("860.record")
+    end)
+
+    wait(5000)
+
+    test(function()
+        local player = g_game.getLocalPlayer()
+        if not player then
+            fail("record didn't log in")
+            return
+        end
+        local center = player:getPosition()
+        for dy=-5,5 do
+            for dx=-7,7 do
+                local tile = g_map.getTile({x = center.x + dx, y = center.y + dy, z = center.z})
+                if tile then
+                    table.insert(tiles, tile)
+                end
+            end
+        end
+        if #tiles == 0 then
+            fail("no tiles around the player")
+            return
+        end
+        burst()
+    end)
+
+    wait(50)
+    ss()
+
+    test(function()
+        local now = counters()
+        if now.expiring < BURST / 2 then
+            fail("effects weren't added to the expiry ring, " .. now.expiring .. " expiring")
+        end
+    end)
+
+    -- longest 860 effects last about 2 s
+    wait(4000)
+
+    test(function()
+        local now = counters()
+        if now.expiring > 100 or effectsOnTiles() > 100 then
+            fail("effects weren't expired, " .. now.expiring .. " still expiring")
+        end
+        -- the blocks freed by the first burst are reused
+        burst()
+    end)
+
+    wait(4000)
+
+    test(function()
+        for i, result in ipairs(bursts) do
+            g_logger.info(string.format("[TEST] Pooled effects burst %i: %i effects in %.2f ms, %i pooled allocations, %i heap allocations, dispatcher queue grew by %i",
+                          i, BURST, result.time / 1000, result.allocations, result.heapAllocations, result.events))
+            if result.events > 50 then
+                fail("effects scheduled their own events")
+            end
+        end
+        if bursts[2] and bursts[2].heapAllocations > BURST / 10 then
+            fail("pooled effects weren't reused, " .. bursts[2].heapAllocations .. " heap allocations")
+        end
+        tiles = {}
+        g_game.forceLogout()
+    end)
+
+    wait(3000)
+
+    test(function()
+        EnterGame.show()
+    end)
+end)
@@ -0,0 +1,78 @@
+Test.Test("Item type search", function(test, wait, ss, fail)
+    local queries = {"sword", "rune", "potion", "of the", "Golden", "ring", "backpack", "dragon", "xx", "zzzzz"}
+    local rounds = 200
+
+    local function allItemTypes()
+        local types = {}
+        for category=0,14 do
+            for _, itemType in ipairs(g_things.findItemTypeByCategory(category)) do
+                table.insert(types, itemType)
+            end
+        end
+        return types
+    end
+
+    test(function()
+        if not g_things.isOtbLoaded() then
+            local path = "/things/1098/items"
+            if not g_resources.fileExists(path .. ".otb") or not g_resources.fileExists(path .. ".xml") then
+                g_logger.info("[TEST] Item type search: no 1098 items.otb and items.xml available, skipping")
+                return
+            end
+            g_things.loadOtb(path .. ".otb")
+            g_things.loadXml(path .. ".xml")
+        end
+
+        local types = allItemTypes()
+        for _, query in ipairs(queries) do
+            local expected = {}
+            for _, itemType in ipairs(types) do
+                if itemType:getName():find(query, 1, true) then
+                    expected[itemType:getServerId()] = true
+                end
+            end
+            local count = 0
+            for _, itemType in ipairs(g_things.findItemTypesByString(query)) do
+                if not expected[itemType:getServerId()] then
+                    fail("'" .. query .. "' matched " .. itemType:getName())
+                end
+                count = count + 1
+            end
+            for _ in pairs(expected) do
+                count = count - 1
+            end
+            if count ~= 0 then
+                fail("'" .. query .. "' returned a wrong number of item types")
+            end
+        end
+
+        local start = g_clock.micros()
+        for i=1,rounds do
+            for _, query in ipairs(queries) do
+                g_things.findItemTypesByString(query)
+            end
+        end
+        local elapsed = g_clock.micros() - start
+        g_logger.info(string.format("[TEST] Item type search: %i item types, %.2f us per substring query",
+                      #types, elapsed / (rounds * #queries)))
+
+        local named = nil
+        for _, itemType in ipairs(types) do
+            if itemType:getName():len() > 0 then
+                named = itemType
+                break
+            end
+        end
+        if named then
+            start = g_clock.micros()
+            for i=1,rounds do
+                if g_things.findItemTypeByName(named:getName()):getName() ~= named:getName() then
+                    fail("findItemTypeByName didn't find " .. named:getName())
+                    break
+                end
+            end
+            elapsed = g_clock.micros() - start
+            g_logger.info(string.format("[TEST] Item type search: %.2f us per name lookup", elapsed / rounds))
+        end
+    end)
+end)
@@ -0,0 +1,63 @@
+Test.Test("Light buffer fill benchmark", function(test, wait, ss, fail)
+    local legacy = g_extras.get("legacyLightDraw")
+    local drawLights = nil
+    local results = {}
+
+    local function counters()
+        local draws, lights, time = g_stats.getLightDrawInfo(false):match("^LightDraw|(%d+)|(%d+)|(%d+)")
+        return {draws = tonumber(draws), lights = tonumber(lights), time = tonumber(time)}
+    end
+
+    test(function()
+        EnterGame.hide()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+        g_game.playRecord("860.record")
+    end)
+
+    wait(5000)
+
+    test(function()
+        if not g_game.getLocalPlayer() then
+            fail("record didn't log in")
+        end
+        local mapPanel = modules.game_interface.getMapPanel()
+        drawLights = mapPanel:isDrawingLights()
+        mapPanel:setDrawLights(true)
+    end)
+
+    for _, useLegacy in ipairs({true, false}) do
+        test(function()
+            g_extras.set("legacyLightDraw", useLegacy)
+            results[useLegacy] = counters()
+        end)
+        wait(1000)
+        test(function()
+            local now = counters()
+            local start = results[useLegacy]
+            local draws = math.max(1, now.draws - start.draws)
+            results[useLegacy] = {draws = now.draws - start.draws, lights = (now.lights - start.lights) / draws,
+                                  time = (now.time - start.time) / draws}
+        end)
+    end
+
+    test(function()
+        g_extras.set("legacyLightDraw", legacy)
+        modules.game_interface.getMapPanel():setDrawLights(drawLights)
+
+        local all, binned = results[true], results[false]
+        g_logger.info(string.format("[TEST] Light buffer fill: %.1f lights per frame, legacy %.1f us, binned %.1f us per frame",
+                      binned.lights, all.time, binned.time))
+        if all.draws == 0 or binned.draws == 0 then
+            fail("lights weren't drawn")
+        end
+        g_game.forceLogout()
+    end)
+
+    wait(3000)
+
+    test(function()
+        EnterGame.show()
+    end)
+end)
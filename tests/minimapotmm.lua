@@ -0,0 +1,42 @@
+Test.Test("Minimap OTMM save and load", function(test, wait, ss, fail)
+    local file = "/minimap_test.otmm"
+
+    test(function()
+        EnterGame.hide()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+        g_game.playRecord("860.record")
+    end)
+
+    wait(5000)
+
+    test(function()
+        if not g_game.getLocalPlayer() then
+            fail("record didn't log in")
+        end
+        g_resources.deleteFile(file)
+        g_minimap.saveOtmm(file)
+    end)
+
+    -- the file is compressed and written by a background task
+    wait(1000)
+
+    test(function()
+        if not g_resources.fileExists(file) then
+            fail("minimap wasn't saved")
+        end
+        g_minimap.clean()
+        if not g_minimap.loadOtmm(file) then
+            fail("saved OTMM file was rejected when loaded back")
+        end
+        g_resources.deleteFile(file)
+        g_game.forceLogout()
+    end)
+
+    wait(3000)
+
+    test(function()
+        EnterGame.show()
+    end)
+end)
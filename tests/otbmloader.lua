@@ -0,0 +1,83 @@
+Test.Test("OTBM loader", function(test, wait, ss, fail)
+    local fileName = "/otbmloadertest.otbm"
+    local legacy = g_extras.get("legacyOtbmLoader")
+
+    local function snapshot()
+        local tiles = {}
+        local count = 0
+        for _, tile in ipairs(g_map.getTiles(-1)) do
+            local pos = tile:getPosition()
+            local items = {}
+            for _, thing in ipairs(tile:getThings()) do
+                if thing:isItem() then
+                    table.insert(items, thing:getServerId() .. ":" .. thing:getCountOrSubType())
+                end
+            end
+            tiles[pos.x .. "," .. pos.y .. "," .. pos.z] = tile:getFlags() .. "|" .. table.concat(items, ",")
+            count = count + 1
+        end
+        return tiles, count
+    end
+
+    local function load(useLegacy)
+        g_map.clean()
+        g_extras.set("legacyOtbmLoader", useLegacy)
+        local start = g_clock.micros()
+        g_map.loadOtbm(fileName)
+        return g_clock.micros() - start
+    end
+
+    test(function()
+        if not g_things.isOtbLoaded() then
+            local otb = "/things/" .. g_game.getClientVersion() .. "/items.otb"
+            if not g_resources.fileExists(otb) or not pcall(function() g_things.loadOtb(otb) end) or not g_things.isOtbLoaded() then
+                g_logger.info("[TEST] OTBM loader: no items.otb available, skipping")
+                return
+            end
+        end
+
+        -- 8 floors of 4x4 tile areas, so the areas are decoded by more than one thread
+        math.randomseed(5)
+        g_map.clean()
+        for z=0,7 do
+            for area=0,15 do
+                local baseX = 1000 + (area % 4) * 256
+                local baseY = 1000 + math.floor(area / 4) * 256
+                for i=0,255 do
+                    local pos = {x = baseX + i % 16, y = baseY + math.floor(i / 16), z = z}
+                    for j=1,math.random(1, 3) do
+                        g_map.addThing(Item.createOtb(math.random(100, 3000)), pos)
+                    end
+                    local tile = g_map.getTile(pos)
+                    if tile and math.random(1, 8) == 1 then
+                        tile:setFlags(1) -- protection zone
+                    end
+                end
+            end
+        end
+        g_map.saveOtbm(fileName)
+
+        local legacyTime = load(true)
+        local expected, expectedCount = snapshot()
+        local indexedTime = load(false)
+        local result, resultCount = snapshot()
+        g_extras.set("legacyOtbmLoader", legacy)
+        g_map.clean()
+        g_resources.deleteFile(fileName)
+
+        g_logger.info(string.format("[TEST] OTBM loader: %i tiles, legacy %.2f ms, indexed %.2f ms",
+                      expectedCount, legacyTime / 1000, indexedTime / 1000))
+        if expectedCount == 0 then
+            fail("generated map wasn't loaded")
+        end
+        if resultCount ~= expectedCount then
+            fail("indexed loader loaded " .. resultCount .. " tiles, legacy loader " .. expectedCount)
+        end
+        for pos, tile in pairs(expected) do
+            if result[pos] ~= tile then
+                fail("tile " .. pos .. " differs: " .. tostring(result[pos]) .. ", expected " .. tile)
+                break
+            end
+        end
+    end)
+end)
@@ -0,0 +1,102 @@
+Test.Test("Outfit composition", function(test, wait, ss, fail)
+    local legacy = g_extras.get("legacyOutfitDraw")
+    local creatures = {}
+    local results = {}
+    local placed = 0
+    local OUTFITS = 200
+
+    local function counters()
+        local outfits, layers, draws, compositions = g_stats.getOutfitCompositionInfo(false):match("^OutfitComposition|(%d+)|(%d+)|(%d+)|(%d+)")
+        return {outfits = tonumber(outfits), layers = tonumber(layers), draws = tonumber(draws), compositions = tonumber(compositions)}
+    end
+
+    test(function()
+        EnterGame.hide()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+        g_game.playRecord("860.record")
+    end)
+
+    wait(5000)
+
+    test(function()
+        local player = g_game.getLocalPlayer()
+        if not player then
+            fail("record didn't log in")
+            return
+        end
+        -- 200 distinct outfits around the player, two on a tile where needed
+        local looktypes = {128, 129, 130, 131, 132, 133, 134, 136, 137, 138, 139, 140, 141, 142}
+        local center = player:getPosition()
+        local i = 0
+        for layer=1,2 do
+            for dy=-5,5 do
+                for dx=-7,7 do
+                    local pos = {x = center.x + dx, y = center.y + dy, z = center.z}
+                    if i < OUTFITS and (dx ~= 0 or dy ~= 0) and g_map.getTile(pos) then
+                        i = i + 1
+                        local creature = Creature.create()
+                        creature:setName("outfit " .. i)
+                        creature:setOutfit({type = looktypes[i % #looktypes + 1], addons = i % 4,
+                                            head = i % 133, body = (i * 7) % 133, legs = (i * 13) % 133, feet = (i * 31) % 133})
+                        creature:setDirection(i % 4)
+                        g_map.addThing(creature, pos, -1)
+                        table.insert(creatures, creature)
+                    end
+                end
+            end
+        end
+        placed = #creatures
+        if placed < OUTFITS then
+            g_logger.info("[TEST] Outfit composition: only " .. placed .. " tiles around the player, using fewer outfits")
+        end
+    end)
+
+    for _, useLegacy in ipairs({true, false}) do
+        local switched = nil
+        test(function()
+            g_extras.set("legacyOutfitDraw", useLegacy)
+            switched = counters()
+        end)
+        -- first frames compose the outfits, measure after them
+        wait(500)
+        test(function()
+            results[useLegacy] = counters()
+        end)
+        wait(1000)
+        test(function()
+            local now = counters()
+            local start = results[useLegacy]
+            local outfits = math.max(1, now.outfits - start.outfits)
+            results[useLegacy] = {layers = (now.layers - start.layers) / outfits, draws = (now.draws - start.draws) / outfits,
+                                  compositions = now.compositions - switched.compositions}
+        end)
+    end
+    ss()
+
+    test(function()
+        g_extras.set("legacyOutfitDraw", legacy)
+        for _, creature in ipairs(creatures) do
+            g_map.removeThing(creature)
+        end
+        creatures = {}
+
+        local layered, composed = results[true], results[false]
+        g_logger.info(string.format("[TEST] Outfit composition: %i outfits, %.2f layers per outfit, draws per frame: legacy %i, composed %i (%i compositions)",
+                      placed, composed.layers, layered.draws * placed, composed.draws * placed, composed.compositions))
+        if composed.draws >= layered.draws then
+            fail("outfit layers weren't composed")
+        end
+        if composed.compositions == 0 then
+            fail("no outfit was composed in the atlas")
+        end
+        g_game.forceLogout()
+    end)
+
+    wait(3000)
+
+    test(function()
+        EnterGame.show()
+    end)
+end)
@@ -0,0 +1,79 @@
+Test.Test("Outfit composition pixels", function(test, wait, ss, fail)
+    local legacy = g_extras.get("legacyOutfitDraw")
+    local files = {[true] = "/outfitcomposition_legacy.png", [false] = "/outfitcomposition_composed.png"}
+    local panel = nil
+    local compositions = 0
+
+    local function counters()
+        return tonumber(g_stats.getOutfitCompositionInfo(false):match("^OutfitComposition|%d+|%d+|%d+|(%d+)"))
+    end
+
+    test(function()
+        EnterGame.hide()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+    end)
+
+    wait(1000)
+
+    test(function()
+        -- an opaque panel over the whole screen, so nothing but the outfits differs between the screenshots
+        local root = g_ui.getRootWidget()
+        panel = g_ui.createWidget("UIWidget", root)
+        panel:setRect({x = 0, y = 0, width = root:getWidth(), height = root:getHeight()})
+        panel:setBackgroundColor("#202020")
+        panel:raise()
+
+        -- 64x64 widgets draw the outfits unscaled, so they're composed like on the map
+        local looktypes = {128, 129, 130, 131, 132, 133, 134, 136, 137, 138, 139, 140, 141, 142}
+        for i, looktype in ipairs(looktypes) do
+            for direction=0,3 do
+                local creature = UICreature.create()
+                panel:addChild(creature)
+                creature:setSize({width = 64, height = 64})
+                creature:setPosition({x = 10 + (i - 1) * 70, y = 10 + direction * 70})
+                creature:setOutfit({type = looktype, addons = 3, head = i * 7 % 133, body = i * 13 % 133,
+                                    legs = i * 31 % 133, feet = i * 17 % 133})
+                creature:setDirection(direction)
+                creature:setAnimate(false)
+            end
+        end
+    end)
+
+    for _, useLegacy in ipairs({true, false}) do
+        local start = nil
+        test(function()
+            g_extras.set("legacyOutfitDraw", useLegacy)
+            start = counters()
+        end)
+        wait(500)
+        test(function()
+            compositions = compositions + (useLegacy and 0 or counters() - start)
+            g_resources.deleteFile(files[useLegacy])
+            g_app.doScreenshot(files[useLegacy])
+        end)
+        -- screenshots are read on the graphics thread and saved asynchronously
+        wait(1000)
+    end
+
+    test(function()
+        g_extras.set("legacyOutfitDraw", legacy)
+        panel:destroy()
+        panel = nil
+
+        local layered = g_resources.readFileContents(files[true])
+        local composed = g_resources.readFileContents(files[false])
+        g_logger.info(string.format("[TEST] Outfit composition pixels: %i compositions, screenshots %i and %i bytes",
+                      compositions, layered:len(), composed:len()))
+        if compositions == 0 then
+            fail("no outfit was composed in the atlas")
+        end
+        if layered:len() == 0 or layered ~= composed then
+            fail("composed outfits don't match the layered ones pixel for pixel")
+        end
+        for _, file in pairs(files) do
+            g_resources.deleteFile(file)
+        end
+    end)
+end)
@@ -0,0 +1,93 @@
+Test.Test("Shader handles", function(test, wait, ss, fail)
+    local SHADER = "outfit_rainbow"
+    local ITEMS = 300
+    local items = {}
+    local start = {}
+
+    local function counters()
+        local draws, binds, lookups = g_stats.getShaderInfo(false):match("^Shader|(%d+)|(%d+)|(%d+)")
+        return {draws = tonumber(draws), binds = tonumber(binds), lookups = tonumber(lookups)}
+    end
+
+    test(function()
+        EnterGame.hide()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+        g_game.playRecord("860.record")
+    end)
+
+    wait(5000)
+
+    test(function()
+        local player = g_game.getLocalPlayer()
+        if not player then
+            fail("record didn't log in")
+            return
+        end
+        -- normally created by game_shaders, the same program again is harmless
+        g_shaders.createOutfitShader(SHADER, "/shaders/outfit_rainbow_vertex", "/shaders/outfit_rainbow_fragment")
+        g_shaders.addTexture(SHADER, "/images/shaders/rainbow.png")
+
+        local center = player:getPosition()
+        for layer=1,2 do
+            for dy=-5,5 do
+                for dx=-7,7 do
+                    local pos = {x = center.x + dx, y = center.y + dy, z = center.z}
+                    if #items < ITEMS and g_map.getTile(pos) then
+                        local item = Item.create(3031 + #items % 5) -- coins and gems
+                        item:setShader(SHADER)
+                        g_map.addThing(item, pos, -1)
+                        table.insert(items, item)
+                    end
+                end
+            end
+        end
+        if #items == 0 then
+            fail("no tiles around the player")
+            return
+        end
+        if items[1]:getShader() ~= SHADER then
+            fail("item shader name wasn't kept, got " .. items[1]:getShader())
+        end
+    end)
+
+    -- shader is created on the graphics thread
+    wait(500)
+
+    test(function()
+        start = counters()
+        start.micros = g_clock.micros()
+    end)
+
+    wait(1000)
+    ss()
+
+    test(function()
+        local now = counters()
+        local frames = math.max(1, math.floor(g_app.getFps() * (g_clock.micros() - start.micros) / 1000000))
+        local draws, binds, lookups = now.draws - start.draws, now.binds - start.binds, now.lookups - start.lookups
+        g_logger.info(string.format("[TEST] Shader handles: %i shader-tagged items, per frame %.1f shader draws, %.1f binds, %.1f name lookups",
+                      #items, draws / frames, binds / frames, lookups / frames))
+        if draws == 0 then
+            fail("shader-tagged items weren't drawn with their shader")
+        end
+        if lookups > frames then
+            fail("shaders were looked up by name while drawing, " .. lookups .. " lookups")
+        end
+        if binds >= draws then
+            fail("consecutive items with the same shader bound it again")
+        end
+        for _, item in ipairs(items) do
+            g_map.removeThing(item)
+        end
+        items = {}
+        g_game.forceLogout()
+    end)
+
+    wait(3000)
+
+    test(function()
+        EnterGame.show()
+    end)
+end)
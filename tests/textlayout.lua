@@ -0,0 +1,58 @@
+Test.Test("Text layout cache", function(test, wait, ss, fail)
+    local panel = nil
+    local start = {}
+
+    local function counters()
+        local hits, misses, layouts, time, evictions = g_stats.getTextLayoutInfo(false):match("^TextLayout|(%d+)|(%d+)|(%d+)|(%d+)|(%d+)")
+        return {hits = tonumber(hits), misses = tonumber(misses), layouts = tonumber(layouts),
+                time = tonumber(time), evictions = tonumber(evictions), frames = g_app.getFps()}
+    end
+
+    test(function()
+        panel = g_ui.createWidget("Panel", g_ui.getRootWidget())
+        panel:setRect({x = 0, y = 0, width = 600, height = 600})
+        panel:setBackgroundColor("#202020")
+        -- a full console
+        for i=1,500 do
+            local label = g_ui.createWidget("Label", panel)
+            label:setRect({x = 5, y = (i % 100) * 6, width = 290, height = 6})
+            label:setText(string.format("%02i:%02i Player %i: message number %i", i % 24, i % 60, i % 17, i))
+        end
+        -- creature names over the map
+        for i=1,100 do
+            local label = g_ui.createWidget("Label", panel)
+            label:setFont("verdana-11px-rounded")
+            label:setRect({x = 300 + (i % 5) * 60, y = math.floor(i / 5) * 14, width = 60, height = 14})
+            label:setText("Creature " .. (i % 30))
+        end
+    end)
+
+    -- first frames lay out the texts
+    wait(500)
+
+    test(function()
+        start = counters()
+        start.micros = g_clock.micros()
+    end)
+
+    wait(1000)
+    ss()
+
+    test(function()
+        local now = counters()
+        local elapsed = (g_clock.micros() - start.micros) / 1000000
+        local frames = math.max(1, math.floor(now.frames * elapsed))
+        local hits = now.hits - start.hits
+        local layouts = now.layouts - start.layouts
+        g_logger.info(string.format("[TEST] Text layout cache: %.1f hits and %.1f layouts per frame, %.2f ms laying out text, %i evictions",
+                      hits / frames, layouts / frames, (now.time - start.time) / 1000, now.evictions - start.evictions))
+        if hits == 0 then
+            fail("drawn texts weren't found in the layout cache")
+        end
+        if layouts > 10 then
+            fail("unchanged texts were laid out again, " .. layouts .. " layouts")
+        end
+        panel:destroy()
+        panel = nil
+    end)
+end)
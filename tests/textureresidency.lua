@@ -0,0 +1,45 @@
+Test.Test("Thing texture residency", function(test, wait, ss, fail)
+    local budget = nil
+    local start = {}
+
+    local function counters()
+        local bytes, limit, evictions, reloads = g_stats.getTextureResidencyInfo(false):match("^TextureResidency|(%d+)|(%d+)|(%d+)|(%d+)")
+        return {bytes = tonumber(bytes), budget = tonumber(limit), evictions = tonumber(evictions), reloads = tonumber(reloads)}
+    end
+
+    test(function()
+        EnterGame.hide()
+        budget = g_things.getTextureBudget()
+        -- small enough for the recorded session to go over it
+        g_things.setTextureBudget(1024 * 1024)
+        start = counters()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+        g_game.playRecord("860.record")
+    end)
+
+    wait(10000)
+    ss()
+
+    test(function()
+        local now = counters()
+        g_logger.info(string.format("[TEST] Thing texture residency: %.2f MB resident, %i evictions, %i reloads",
+                      now.bytes / 1024 / 1024, now.evictions - start.evictions, now.reloads - start.reloads))
+        if now.evictions == start.evictions then
+            fail("no textures were evicted with a 1 MB budget")
+        end
+        -- textures drawn in the last frames are never evicted, leave room for what's on the screen
+        if now.bytes > now.budget + 16 * 1024 * 1024 then
+            fail("resident textures weren't evicted down to the budget")
+        end
+        g_things.setTextureBudget(budget)
+        g_game.forceLogout()
+    end)
+
+    wait(3000)
+
+    test(function()
+        EnterGame.show()
+    end)
+end)
@@ -0,0 +1,67 @@
+Test.Test("Tile draw lists", function(test, wait, ss, fail)
+    local legacy = g_extras.get("legacyTileDraw")
+    local results = {}
+
+    local function counters()
+        local frames, time, builds = g_stats.getMapDrawInfo(false):match("^MapDraw|(%d+)|(%d+)|(%d+)")
+        return {frames = tonumber(frames), time = tonumber(time), builds = tonumber(builds)}
+    end
+
+    test(function()
+        EnterGame.hide()
+        g_settings.setNode("things", {})
+        g_game.setClientVersion(860)
+        g_game.setProtocolVersion(g_game.getClientProtocolVersion(860))
+        g_game.playRecord("860.record")
+    end)
+
+    wait(5000)
+
+    test(function()
+        if not g_game.getLocalPlayer() then
+            fail("record didn't log in")
+        end
+    end)
+
+    for _, useLegacy in ipairs({true, false}) do
+        test(function()
+            g_extras.set("legacyTileDraw", useLegacy)
+        end)
+        -- first frames build the draw lists of the visible tiles, measure after them
+        wait(500)
+        test(function()
+            results[useLegacy] = counters()
+        end)
+        wait(1000)
+        test(function()
+            local now = counters()
+            local start = results[useLegacy]
+            local frames = math.max(1, now.frames - start.frames)
+            results[useLegacy] = {frames = frames, time = (now.time - start.time) / frames,
+                                  builds = (now.builds - start.builds) / frames}
+        end)
+    end
+    ss()
+
+    test(function()
+        g_extras.set("legacyTileDraw", legacy)
+
+        local classified, listed = results[true], results[false]
+        g_logger.info(string.format("[TEST] Tile draw lists: map draw per frame: legacy %.3f ms, draw lists %.3f ms, %.2f draw list builds per frame",
+                      classified.time / 1000, listed.time / 1000, listed.builds))
+        if classified.builds > 0 then
+            fail("draw lists were built with legacy tile drawing")
+        end
+        -- only tiles touched by the replay are rebuilt, not every visible tile
+        if listed.builds > 50 then
+            fail("draw lists are rebuilt every frame, " .. listed.builds .. " builds per frame")
+        end
+        g_game.forceLogout()
+    end)
+
+    wait(3000)
+
+    test(function()
+        EnterGame.show()
+    end)
+end)
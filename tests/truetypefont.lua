@@ -0,0 +1,84 @@
+Test.Test("TrueType font atlases", function(test, wait, ss, fail)
+    local ttf = "Pokemon Solid.ttf"
+    local PIXEL_HEIGHT = 18
+    local SDF_SPREAD = 4
+    local SDF_SPACE_WIDTH = 5
+    local fonts = {plain = "ttftest-plain", sdf = "ttftest-sdf"}
+
+    -- same fields the GDI+ rasterizer writes to the generated otfont
+    local function metrics(name)
+        local contents = g_resources.readFileContents("/generated/fonts/" .. name .. ".otfont")
+        if not contents or contents:len() == 0 then
+            return nil
+        end
+        local width, height = contents:match("glyph%-size: (%d+) (%d+)")
+        return {height = tonumber(contents:match("height: (%d+)")), tileWidth = tonumber(width), tileHeight = tonumber(height),
+                firstGlyph = tonumber(contents:match("first%-glyph: (%d+)")), spaceWidth = tonumber(contents:match("space%-width: (%d+)")),
+                sdf = contents:match("sdf: true") ~= nil}
+    end
+
+    test(function()
+        if not g_resources.fileExists(ttf) then
+            fail("bundled ttf " .. ttf .. " is missing")
+            return
+        end
+        g_fonts.importTTFFont(ttf, fonts.plain, PIXEL_HEIGHT, 0)
+        g_fonts.importTTFFont(ttf, fonts.sdf, PIXEL_HEIGHT, 0, {width = 1, height = 0}, SDF_SPACE_WIDTH, 32, 255, false, true)
+    end)
+
+    -- fonts are rasterized on the graphics thread
+    wait(1000)
+
+    test(function()
+        -- stb_truetype is a build dependency, both atlases must be rasterized on every platform
+        if not g_fonts.fontExists(fonts.plain) or not g_fonts.fontExists(fonts.sdf) then
+            fail("ttf wasn't rasterized (plain " .. tostring(g_fonts.fontExists(fonts.plain)) ..
+                 ", sdf " .. tostring(g_fonts.fontExists(fonts.sdf)) .. ")")
+            return
+        end
+        local plain, sdf = metrics(fonts.plain), metrics(fonts.sdf)
+        if not plain or not sdf then
+            fail("generated otfont files are missing")
+            return
+        end
+        g_logger.info(string.format("[TEST] TrueType font atlases: height %i, glyph size %ix%i (sdf %ix%i), space width %i",
+                      plain.height, plain.tileWidth, plain.tileHeight, sdf.tileWidth, sdf.tileHeight, plain.spaceWidth))
+        if plain.firstGlyph ~= 32 or plain.sdf or not sdf.sdf then
+            fail("unexpected otfont fields")
+        end
+        -- em sized like GDI+: line height close to the pixel height, tiles at least an em wide plus padding
+        if plain.height < PIXEL_HEIGHT * 0.8 or plain.height > PIXEL_HEIGHT * 1.6 then
+            fail("glyph height " .. plain.height .. " doesn't match a " .. PIXEL_HEIGHT .. " px em")
+        end
+        if plain.tileWidth < PIXEL_HEIGHT + 2 or plain.tileHeight < plain.height then
+            fail("glyph tiles are smaller than the glyphs")
+        end
+        -- the requested space width is kept, like the GDI+ rasterizer does, 3 when none is given
+        if plain.spaceWidth ~= 3 or sdf.spaceWidth ~= SDF_SPACE_WIDTH then
+            fail("space widths " .. plain.spaceWidth .. " and " .. sdf.spaceWidth .. " don't match the requested 3 and " .. SDF_SPACE_WIDTH)
+        end
+        -- the distance field only adds padding, metrics stay the same (within a pixel when GDI+ made the plain atlas)
+        if math.abs(sdf.height - plain.height) > 1 then
+            fail("sdf glyph height " .. sdf.height .. " differs from " .. plain.height)
+        end
+        if sdf.tileWidth < PIXEL_HEIGHT + SDF_SPREAD * 2 or sdf.tileHeight < sdf.height + SDF_SPREAD * 2 then
+            fail("sdf glyph tiles have no room for the distance field")
+        end
+
+        local label = g_ui.createWidget("Label", g_ui.getRootWidget())
+        for _, name in pairs(fonts) do
+            label:setFont(name)
+            label:setText("The quick brown fox")
+            local size = label:getTextSize()
+            if size.width <= 0 or math.abs(size.height - plain.height) > 1 then
+                fail("text drawn with " .. name .. " has size " .. size.width .. "x" .. size.height)
+            end
+        end
+        label:destroy()
+
+        for _, name in pairs(fonts) do
+            g_resources.deleteFile("/generated/fonts/" .. name .. ".otfont")
+            g_resources.deleteFile("/generated/fonts/" .. name .. "_cp1252.png")
+        end
+    end)
+end)
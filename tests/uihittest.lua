@@ -0,0 +1,121 @@
+Test.Test("Widget hit testing", function(test, wait, ss, fail)
+    local function linearGetChildByPos(widget, pos, wantsPhantom)
+        if not widget:containsPaddingPoint(pos) then
+            return nil
+        end
+        local children = widget:getChildren()
+        for i=#children,1,-1 do
+            local child = children[i]
+            if child:isExplicitlyVisible() and child:containsPoint(pos) then
+                local subChild = linearGetChildByPos(child, pos, wantsPhantom)
+                if subChild then
+                    return subChild
+                elseif wantsPhantom or not child:isPhantom() then
+                    return child
+                end
+            end
+        end
+        return nil
+    end
+
+    local function linearGetChildrenByPos(widget, pos, ret)
+        if not widget:containsPaddingPoint(pos) then
+            return ret
+        end
+        local children = widget:getChildren()
+        for i=#children,1,-1 do
+            local child = children[i]
+            if child:isExplicitlyVisible() and child:containsPoint(pos) then
+                linearGetChildrenByPos(child, pos, ret)
+                table.insert(ret, child)
+            end
+        end
+        return ret
+    end
+
+    local function randomRect(parent)
+        local rect = parent:getRect()
+        local x = rect.x + math.random(-20, math.max(0, rect.width))
+        local y = rect.y + math.random(-20, math.max(0, rect.height))
+        return {x = x, y = y, width = math.random(0, 200), height = math.random(0, 200)}
+    end
+
+    local root = nil
+    local widgets = {}
+
+    local function compare(count)
+        for i=1,count do
+            local pos = {x = math.random(-50, 1100), y = math.random(-50, 1100)}
+            local wantsPhantom = math.random(1, 2) == 1
+            if root:recursiveGetChildByPos(pos, wantsPhantom) ~= linearGetChildByPos(root, pos, wantsPhantom) then
+                fail("recursiveGetChildByPos returned a different widget than the linear search")
+            end
+            local result = root:recursiveGetChildrenByPos(pos)
+            local expected = linearGetChildrenByPos(root, pos, {})
+            if #result ~= #expected then
+                fail("recursiveGetChildrenByPos returned a different number of widgets than the linear search")
+            end
+            for j=1,#expected do
+                if result[j] ~= expected[j] then
+                    fail("recursiveGetChildrenByPos returned different widgets than the linear search")
+                end
+            end
+        end
+    end
+
+    test(function()
+        math.randomseed(2)
+        root = g_ui.createWidget("UIWidget", g_ui.getRootWidget())
+        root:setPhantom(true)
+        root:setVisible(false)
+        root:setRect({x = 0, y = 0, width = 1024, height = 1024})
+        widgets = {root}
+        for i=1,3000 do
+            -- wide parents, like item grids and battle lists
+            local parent = widgets[math.random(1, math.min(#widgets, 40))]
+            local widget = g_ui.createWidget("UIWidget", parent)
+            widget:setRect(randomRect(parent))
+            widget:setPhantom(math.random(1, 4) == 1)
+            table.insert(widgets, widget)
+        end
+        compare(500)
+    end)
+
+    test(function()
+        for round=1,20 do
+            for i=1,100 do
+                local action = math.random(1, 5)
+                local widget = widgets[math.random(2, #widgets)]
+                local parent = widget:getParent()
+                if action == 1 then
+                    widget:setRect(randomRect(parent))
+                elseif action == 2 then
+                    widget:setVisible(not widget:isExplicitlyVisible())
+                elseif action == 3 then
+                    parent:moveChildToIndex(widget, math.random(1, parent:getChildCount()))
+                elseif action == 4 then
+                    local child = g_ui.createWidget("UIWidget")
+                    child:setRect(randomRect(parent))
+                    parent:insertChild(math.random(1, parent:getChildCount() + 1), child)
+                    table.insert(widgets, child)
+                elseif action == 5 and #widgets > 1000 then
+                    widget:destroy()
+                    local alive = {}
+                    for _, w in ipairs(widgets) do
+                        if not w:isDestroyed() then
+                            table.insert(alive, w)
+                        end
+                    end
+                    widgets = alive
+                end
+            end
+            compare(100)
+        end
+    end)
+
+    test(function()
+        root:destroy()
+        root = nil
+        widgets = {}
+    end)
+end)
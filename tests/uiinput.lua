@@ -0,0 +1,84 @@
+Test.Test("Coalesced mouse input benchmark", function(test, wait, ss, fail)
+    local panel = nil
+    local moves = 0
+    local wheels = 0
+    local lastPos = nil
+    local hookCalls = {0, 0}
+    local hooks = {
+        onMouseMove = function() hookCalls[1] = hookCalls[1] + 1 end,
+        onMouseWheel = function() hookCalls[2] = hookCalls[2] + 1 end
+    }
+    local extraHook = function() end
+    local received, dispatched, time = 0, 0, 0
+
+    local function counters()
+        local r, d, t = g_stats.getInputInfo(false):match("^Input|(%d+)|(%d+)|(%d+)")
+        return tonumber(r), tonumber(d), tonumber(t)
+    end
+
+    test(function()
+        panel = g_ui.createWidget("UIWidget", g_ui.getRootWidget())
+        panel:setRect({x = 0, y = 0, width = 400, height = 400})
+        panel.onMouseMove = function(widget, pos, moved)
+            moves = moves + 1
+            lastPos = pos
+        end
+        panel.onMouseWheel = function(widget, pos, direction)
+            wheels = wheels + (direction == MouseWheelUp and 1 or -1)
+            return true
+        end
+        received, dispatched, time = counters()
+        -- connected after the modules were loaded, with a second slot so the hook becomes a table
+        connect(g_ui, hooks)
+        connect(g_ui, {onMouseMove = extraHook})
+    end)
+
+    -- 1 kHz mouse, 16 events between every frame for a second
+    for frame=1,60 do
+        test(function()
+            for i=1,16 do
+                local step = (frame - 1) * 16 + i
+                g_app.injectMouseMove({x = 10 + step % 300, y = 10 + math.floor(step / 300)})
+            end
+        end)
+        wait(16)
+    end
+
+    test(function()
+        local r, d, t = counters()
+        g_logger.info(string.format("[TEST] Mouse input: %i events received, %i dispatched, %.2f ms spent in input handling (%.2f us per event)",
+                      r - received, d - dispatched, (t - time) / 1000, (t - time) / math.max(1, r - received)))
+        if r - received < 960 then
+            fail("synthetic mouse events weren't received")
+        end
+        if d - dispatched >= r - received then
+            fail("mouse moves weren't coalesced")
+        end
+        if hookCalls[1] == 0 then
+            fail("g_ui.onMouseMove connected at runtime wasn't called")
+        end
+        if moves == 0 or not lastPos or lastPos.x ~= 10 + 960 % 300 or lastPos.y ~= 10 + math.floor(960 / 300) then
+            fail("last mouse position wasn't delivered")
+        end
+
+        for i=1,5 do
+            g_app.injectMouseWheel({x = 50, y = 50}, MouseWheelUp)
+        end
+        g_app.injectMouseWheel({x = 50, y = 50}, MouseWheelDown)
+    end)
+
+    wait(50)
+
+    test(function()
+        if wheels ~= 4 then
+            fail("wheel steps were summed to " .. wheels .. ", expected 4")
+        end
+        disconnect(g_ui, hooks)
+        disconnect(g_ui, {onMouseMove = extraHook})
+        if hookCalls[2] == 0 then
+            fail("g_ui.onMouseWheel connected at runtime wasn't called")
+        end
+        panel:destroy()
+        panel = nil
+    end)
+end)
@@ -0,0 +1,136 @@
+Test.Test("Layout phase geometry", function(test, wait, ss, fail)
+    local otui = [[
+UIWidget
+  id: layoutTest
+  pos: 10 20
+  width: 300
+  padding: 4
+  layout:
+    type: verticalBox
+    spacing: 2
+    fit-children: true
+
+  UIWidget
+    id: header
+    height: 20
+    margin-left: 5
+
+  UIWidget
+    id: grid
+    padding: 1
+    layout:
+      type: grid
+      cell-size: 30 30
+      cell-spacing: 2
+      num-columns: 3
+      fit-children: true
+    UIWidget
+    UIWidget
+    UIWidget
+    UIWidget
+    UIWidget
+
+  UIWidget
+    id: row
+    height: 40
+    layout:
+      type: horizontalBox
+      spacing: 3
+    UIWidget
+      id: left
+      width: 50
+    UIWidget
+      id: right
+      width: 60
+
+  UIWidget
+    id: anchored
+    height: 30
+    UIWidget
+      id: inner
+      anchors.fill: parent
+      margin: 5
+]]
+
+    local root = nil
+
+    local function check(widget, x, y, width, height)
+        local rect = widget:getRect()
+        if rect.x ~= x or rect.y ~= y or rect.width ~= width or rect.height ~= height then
+            fail(string.format("%s has rect %i %i %i %i, expected %i %i %i %i", widget:getId(),
+                 rect.x, rect.y, rect.width, rect.height, x, y, width, height))
+        end
+    end
+
+    local function checkGrid(grid, count)
+        local children = grid:getChildren()
+        if #children ~= count then
+            fail("grid has " .. #children .. " children, expected " .. count)
+        end
+        for i, child in ipairs(children) do
+            local column = (i - 1) % 3
+            local line = math.floor((i - 1) / 3)
+            check(child, 15 + column * 32, 47 + line * 32, 30, 30)
+        end
+    end
+
+    local function checkStats()
+        local info = g_stats.getLayoutInfo(false)
+        local phases, lastPasses, maxPasses = info:match("^Layout|(%d+)|(%d+)|(%d+)|")
+        if not phases or tonumber(phases) == 0 then
+            fail("layout phases aren't reported: " .. info)
+        end
+        if tonumber(maxPasses) >= 16 then
+            fail("layout phase hit the passes limit: " .. info)
+        end
+    end
+
+    test(function()
+        root = g_ui.loadUIFromString(otui, g_ui.getRootWidget())
+        if not root then
+            fail("can't load test layout")
+        end
+    end)
+
+    wait(200)
+
+    test(function()
+        check(root, 10, 20, 300, 168)
+        check(root:getChildById("header"), 16, 24, 287, 20)
+        check(root:getChildById("grid"), 14, 46, 292, 64)
+        checkGrid(root:getChildById("grid"), 5)
+        check(root:getChildById("row"), 14, 112, 292, 40)
+        check(root:recursiveGetChildById("left"), 14, 112, 50, 40)
+        check(root:recursiveGetChildById("right"), 67, 112, 60, 40)
+        check(root:getChildById("anchored"), 14, 154, 292, 30)
+        check(root:recursiveGetChildById("inner"), 19, 159, 282, 20)
+        checkStats()
+    end)
+
+    test(function()
+        -- growing the grid must cascade up to the outer box and back down to its siblings
+        local grid = root:getChildById("grid")
+        for i=1,4 do
+            g_ui.createWidget("UIWidget", grid)
+        end
+    end)
+
+    wait(200)
+
+    test(function()
+        check(root, 10, 20, 300, 200)
+        check(root:getChildById("grid"), 14, 46, 292, 96)
+        checkGrid(root:getChildById("grid"), 9)
+        check(root:getChildById("row"), 14, 144, 292, 40)
+        check(root:recursiveGetChildById("left"), 14, 144, 50, 40)
+        check(root:recursiveGetChildById("right"), 67, 144, 60, 40)
+        check(root:getChildById("anchored"), 14, 186, 292, 30)
+        check(root:recursiveGetChildById("inner"), 19, 191, 282, 20)
+        checkStats()
+    end)
+
+    test(function()
+        root:destroy()
+        root = nil
+    end)
+end)
@@ -0,0 +1,144 @@
+Test.Test("Retained draw lists", function(test, wait, ss, fail)
+    local panel = nil
+    local labels = {}
+
+    local function counters()
+        local replays, recordings = g_stats.getRetainedDrawInfo(false):match("^RetainedDraw|(%d+)|(%d+)")
+        return tonumber(replays), tonumber(recordings)
+    end
+
+    local replays, recordings = 0, 0
+
+    test(function()
+        panel = g_ui.createWidget("Panel", g_ui.getRootWidget())
+        panel:setRect({x = 0, y = 0, width = 300, height = 600})
+        panel:setBackgroundColor("#202020")
+        for i=1,200 do
+            local label = g_ui.createWidget("Label", panel)
+            label:setRect({x = 5 + (i % 2) * 150, y = math.floor(i / 2) * 6, width = 140, height = 6})
+            label:setText("label " .. i)
+            table.insert(labels, label)
+        end
+        panel:setRetainedDraw(true)
+        if not panel:isRetainedDraw() then
+            fail("retained draw wasn't enabled")
+        end
+    end)
+
+    wait(200)
+
+    test(function()
+        replays, recordings = counters()
+        if replays == 0 then
+            fail("unchanged panel wasn't replayed")
+        end
+    end)
+
+    wait(200)
+
+    test(function()
+        local newReplays, newRecordings = counters()
+        if newRecordings ~= recordings then
+            fail("unchanged panel was recorded again")
+        end
+        replays, recordings = newReplays, newRecordings
+        labels[50]:setText("changed")
+    end)
+
+    wait(100)
+
+    test(function()
+        local _, newRecordings = counters()
+        if newRecordings == recordings then
+            fail("panel wasn't recorded again after a child changed")
+        end
+        recordings = newRecordings
+        labels[80]:setVisible(false)
+    end)
+
+    wait(100)
+
+    test(function()
+        local _, newRecordings = counters()
+        if newRecordings == recordings then
+            fail("panel wasn't recorded again after a child was hidden")
+        end
+        panel:setRetainedDraw(false)
+    end)
+
+    test(function()
+        panel:destroy()
+        panel = nil
+        labels = {}
+    end)
+end)
+
+Test.Test("Retained draw pixels", function(test, wait, ss, fail)
+    local files = {[false] = "/retaineddraw_immediate.png", [true] = "/retaineddraw_retained.png"}
+    local panel = nil
+    local replays = 0
+
+    local function counters()
+        return tonumber(g_stats.getRetainedDrawInfo(false):match("^RetainedDraw|(%d+)|"))
+    end
+
+    test(function()
+        -- an opaque panel over the whole screen, so nothing but its subtree differs between the screenshots
+        local root = g_ui.getRootWidget()
+        panel = g_ui.createWidget("UIWidget", root)
+        panel:setRect({x = 0, y = 0, width = root:getWidth(), height = root:getHeight()})
+        panel:setBackgroundColor("#202020")
+        panel:raise()
+        for i=1,60 do
+            local widget = g_ui.createWidget(i % 3 == 0 and "Button" or (i % 3 == 1 and "Label" or "CheckBox"), panel)
+            widget:setRect({x = 10 + (i % 6) * 110, y = 10 + math.floor(i / 6) * 24, width = 100, height = 20})
+            widget:setText("widget " .. i)
+            if i % 4 == 0 then
+                widget:setOpacity(0.5)
+            end
+            if i % 5 == 0 then
+                widget:setBorderWidth(1)
+                widget:setBorderColor("#ff8000")
+            end
+        end
+    end)
+
+    for _, retained in ipairs({false, true}) do
+        local start = 0
+        test(function()
+            panel:setRetainedDraw(retained)
+            start = counters()
+        end)
+        -- first frame records the subtree, the screenshot is taken from a replayed frame
+        wait(500)
+        test(function()
+            if retained then
+                replays = counters() - start
+            end
+            g_resources.deleteFile(files[retained])
+            g_app.doScreenshot(files[retained])
+        end)
+        -- screenshots are read on the graphics thread and saved asynchronously
+        wait(1000)
+    end
+
+    test(function()
+        panel:setRetainedDraw(false)
+        panel:destroy()
+        panel = nil
+
+        local immediate = g_resources.readFileContents(files[false])
+        local retained = g_resources.readFileContents(files[true])
+        g_logger.info(string.format("[TEST] Retained draw pixels: %i replays, screenshots %i and %i bytes",
+                      replays, immediate:len(), retained:len()))
+        if replays == 0 then
+            fail("panel wasn't replayed")
+        end
+        if immediate:len() == 0 or immediate ~= retained then
+            fail("replayed panel doesn't match the immediate drawing pixel for pixel")
+        end
+        for _, file in pairs(files) do
+            g_resources.deleteFile(file)
+        end
+    end)
+end)
@@ -0,0 +1,106 @@
+Test.Test("UI style states benchmark", function(test, wait, ss, fail)
+    local panel = nil
+    local widgets = {}
+    local styles = {"Button", "CheckBox", "MoveableTabBarButton", "Creature", "ComboBox"}
+
+    test(function()
+        panel = g_ui.createWidget("Panel", g_ui.getRootWidget())
+        panel:setSize({width = 1, height = 1})
+        for i=1,500 do
+            local widget = g_ui.createWidget(styles[(i % #styles) + 1], panel)
+            if not widget then
+                fail("can't create widget with style " .. styles[(i % #styles) + 1])
+            end
+            table.insert(widgets, widget)
+        end
+    end)
+
+    wait(500)
+
+    test(function()
+        local rounds = 20
+        local start = g_clock.micros()
+        for round=1,rounds do
+            local on = (round % 2) == 1
+            for _, widget in ipairs(widgets) do
+                widget:setOn(on)
+                widget:setChecked(on)
+            end
+        end
+        local elapsed = g_clock.micros() - start
+        g_logger.info(string.format("[TEST] Style states: %i widgets x %i rounds, %.2f ms (%.2f us per state change)",
+                      #widgets, rounds, elapsed / 1000, elapsed / (#widgets * rounds * 2)))
+        for _, widget in ipairs(widgets) do
+            if widget:isOn() or widget:isChecked() then
+                fail("widget states weren't restored")
+            end
+        end
+    end)
+
+    test(function()
+        -- attributes applied as a diff between state sets must match the whole style applied in the final states
+        local function serialize(value)
+            if type(value) ~= "table" then
+                return tostring(value)
+            end
+            local keys = {}
+            for key in pairs(value) do
+                table.insert(keys, key)
+            end
+            table.sort(keys)
+            local parts = {}
+            for _, key in ipairs(keys) do
+                table.insert(parts, key .. "=" .. serialize(value[key]))
+            end
+            return "{" .. table.concat(parts, ",") .. "}"
+        end
+        local getters = {"getColor", "getBackgroundColor", "getImageSource", "getImageClip", "getImageColor", "getIconPath",
+                         "getMarginTop", "getMarginLeft", "getPaddingTop", "getOpacity", "getTextOffset"}
+        local function snapshot(widget)
+            local values = {}
+            for _, getter in ipairs(getters) do
+                values[getter] = serialize(widget[getter](widget))
+            end
+            return values
+        end
+        local function setStates(widget, states)
+            widget:setOn(states[1])
+            widget:setChecked(states[2])
+            widget:setEnabled(states[3])
+        end
+
+        local sequences = {
+            {{true, false, true}, {true, true, true}, {false, true, true}},
+            {{true, true, true}, {false, false, false}, {true, false, true}},
+            {{false, true, false}, {true, true, true}, {false, false, true}},
+            {{true, true, false}, {false, true, true}, {true, true, true}}
+        }
+        for _, style in ipairs(styles) do
+            for _, sequence in ipairs(sequences) do
+                local widget = g_ui.createWidget(style, panel)
+                for _, states in ipairs(sequence) do
+                    setStates(widget, states)
+                end
+                local reference = g_ui.createWidget(style, panel)
+                setStates(reference, sequence[#sequence])
+                reference:setStyle(style)
+
+                local applied, expected = snapshot(widget), snapshot(reference)
+                for _, getter in ipairs(getters) do
+                    if applied[getter] ~= expected[getter] then
+                        fail(string.format("%s %s is %s after state changes, %s when the style is applied in those states",
+                                           style, getter, applied[getter], expected[getter]))
+                    end
+                end
+                widget:destroy()
+                reference:destroy()
+            end
+        end
+    end)
+
+    test(function()
+        panel:destroy()
+        panel = nil
+        widgets = {}
+    end)
+end)
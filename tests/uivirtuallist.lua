@@ -0,0 +1,122 @@
+Test.Test("Virtual list benchmark", function(test, wait, ss, fail)
+    local rows = 50000
+    local baselineRows = 5000
+    local list = nil
+    local baseline = nil
+    local binds = 0
+
+    local function memory()
+        return g_platform.getMemoryUsage() / 1024 / 1024
+    end
+
+    local function bind(row, index)
+        binds = binds + 1
+        row:setText("row " .. index)
+    end
+
+    local function checkRows()
+        local first = list:getItemAt({x = list:getX() + 5, y = list:getY() + 2})
+        if first == 0 then
+            fail("no item at the top of the list")
+        end
+        local row = list:getRowWidget(first)
+        if not row or row:getText() ~= "row " .. first then
+            fail("row " .. first .. " isn't bound to the right item")
+        end
+        if row:getY() ~= list:getPaddingRect().y + list:getItemOffset(first) - list:getScrollOffset() then
+            fail("row " .. first .. " has a wrong position")
+        end
+        if list:getPoolSize() > 100 then
+            fail("virtual list keeps " .. list:getPoolSize() .. " row widgets")
+        end
+    end
+
+    test(function()
+        local start = g_clock.micros()
+        local mem = memory()
+        baseline = g_ui.createWidget("TextList", g_ui.getRootWidget())
+        baseline:setSize({width = 200, height = 400})
+        baseline:setVisible(false)
+        for i=1,baselineRows do
+            local row = g_ui.createWidget("Label", baseline)
+            row:setText("row " .. i)
+        end
+        local elapsed = g_clock.micros() - start
+        g_logger.info(string.format("[TEST] Widget per row: %i rows created in %.2f ms (%.2f us per row), resident memory +%.2f MB",
+                      baselineRows, elapsed / 1000, elapsed / baselineRows, memory() - mem))
+    end)
+
+    wait(200)
+
+    test(function()
+        baseline:destroy()
+        baseline = nil
+
+        local start = g_clock.micros()
+        local mem = memory()
+        list = g_ui.createWidget("VirtualList", g_ui.getRootWidget())
+        list:setRect({x = 0, y = 0, width = 200, height = 400})
+        list:setRowStyle("Label")
+        list:setDataSource(rows, bind)
+        local elapsed = g_clock.micros() - start
+        g_logger.info(string.format("[TEST] Virtual list: %i rows created in %.2f ms, %i row widgets, resident memory +%.2f MB",
+                      rows, elapsed / 1000, list:getPoolSize(), memory() - mem))
+        if list:getContentHeight() ~= rows * list:getRowHeight() then
+            fail("wrong content height " .. list:getContentHeight())
+        end
+        checkRows()
+    end)
+
+    wait(200)
+
+    test(function()
+        local steps = 2000
+        local maxOffset = list:getMaxScrollOffset()
+        binds = 0
+        local start = g_clock.micros()
+        for i=1,steps do
+            list:setScrollOffset(math.floor(maxOffset * i / steps))
+        end
+        local elapsed = g_clock.micros() - start
+        g_logger.info(string.format("[TEST] Virtual list: %i scrolls in %.2f ms (%.2f us per scroll, %i rows bound)",
+                      steps, elapsed / 1000, elapsed / steps, binds))
+        if list:getScrollOffset() ~= maxOffset then
+            fail("list isn't scrolled to the end")
+        end
+        checkRows()
+        if list:getRowWidget(rows) == nil then
+            fail("last row isn't visible at the end of the list")
+        end
+    end)
+
+    test(function()
+        -- variable row heights
+        for i=1,rows,7 do
+            list:setItemHeight(i, 30)
+        end
+        local expected = 0
+        for i=1,rows do
+            if list:getItemOffset(i) ~= expected then
+                fail("item " .. i .. " has offset " .. list:getItemOffset(i) .. ", expected " .. expected)
+                break
+            end
+            expected = expected + list:getItemHeight(i) + list:getRowSpacing()
+        end
+        for i=1,200 do
+            local index = math.random(1, rows)
+            list:scrollToItem(index)
+            checkRows()
+            local row = list:getRowWidget(index)
+            if not row or row:getHeight() ~= list:getItemHeight(index) then
+                fail("item " .. index .. " isn't visible after scrolling to it")
+            end
+        end
+    end)
+
+    wait(200)
+
+    test(function()
+        list:destroy()
+        list = nil
+    end)
+end)
@@ -0,0 +1,102 @@
+Test.Test("Widget id index", function(test, wait, ss, fail)
+    local function linearGetChildById(widget, id)
+        for _, child in ipairs(widget:getChildren()) do
+            if child:getId() == id then
+                return child
+            end
+        end
+        for _, child in ipairs(widget:getChildren()) do
+            local found = linearGetChildById(child, id)
+            if found then
+                return found
+            end
+        end
+        return nil
+    end
+
+    local function isInside(widget, parent)
+        while widget do
+            if widget == parent then
+                return true
+            end
+            widget = widget:getParent()
+        end
+        return false
+    end
+
+    local function randomId()
+        if math.random(1, 5) == 1 then
+            return ""
+        end
+        return "w" .. math.random(1, 50)
+    end
+
+    local root = nil
+    local widgets = {}
+
+    local function compare(count)
+        for i=1,count do
+            local widget = widgets[math.random(1, #widgets)]
+            local id = "w" .. math.random(1, 50)
+            local expected = linearGetChildById(widget, id)
+            local result = widget:recursiveGetChildById(id)
+            if expected ~= result then
+                fail("recursiveGetChildById('" .. id .. "') returned a different widget than the linear search")
+            end
+        end
+    end
+
+    test(function()
+        math.randomseed(1)
+        root = g_ui.createWidget("UIWidget", g_ui.getRootWidget())
+        root:setSize({width = 1, height = 1})
+        widgets = {root}
+        for i=1,10000 do
+            local widget = g_ui.createWidget("UIWidget", widgets[math.random(1, #widgets)])
+            widget:setId(randomId())
+            table.insert(widgets, widget)
+        end
+        compare(500)
+    end)
+
+    test(function()
+        for round=1,20 do
+            for i=1,100 do
+                local action = math.random(1, 5)
+                local widget = widgets[math.random(2, #widgets)]
+                if action == 1 then
+                    widget:setId(randomId())
+                elseif action == 2 then
+                    local parent = widgets[math.random(1, #widgets)]
+                    if not isInside(parent, widget) then
+                        widget:setParent(parent)
+                    end
+                elseif action == 3 then
+                    local parent = widget:getParent()
+                    parent:moveChildToIndex(widget, math.random(1, parent:getChildCount()))
+                elseif action == 4 then
+                    local child = g_ui.createWidget("UIWidget")
+                    child:setId(randomId())
+                    widget:insertChild(math.random(1, widget:getChildCount() + 1), child)
+                    table.insert(widgets, child)
+                elseif action == 5 and #widgets > 1000 then
+                    widget:destroy()
+                    local alive = {}
+                    for _, w in ipairs(widgets) do
+                        if not w:isDestroyed() then
+                            table.insert(alive, w)
+                        end
+                    end
+                    widgets = alive
+                end
+            end
+            compare(100)
+        end
+    end)
+
+    test(function()
+        root:destroy()
+        root = nil
+        widgets = {}
+    end)
+end)